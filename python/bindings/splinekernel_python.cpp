@@ -2,20 +2,351 @@
 #include "pybind11/stl.h"
 
 #include "basisfunctions.hpp"
+#include "knotvector.hpp"
 #include "curve.hpp"
 #include "surface.hpp"
 #include "finiteelements.hpp"
+#include "refinement.hpp"
+#include "bezierextraction.hpp"
+#include "tessellation.hpp"
+#include "projection.hpp"
+#include "quadrature.hpp"
+#include "arclength.hpp"
+#include "curvefleet.hpp"
+#include "spanhierarchy.hpp"
+#include "fitting.hpp"
 
 #include "denseMatrixConversion.hpp"
 #include "sparseMatrixConversion.hpp"
 
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+template<typename ScalarType>
+std::pair<std::vector<size_t>, pybind11::array_t<ScalarType>> evaluateActiveBSplineBasisBatch( const std::vector<ScalarType>& tCoordinates,
+                                                                                                 const cie::splinekernel::KnotVector& knotVector )
+{
+    size_t numberOfPoints = tCoordinates.size( );
+    size_t p = knotVector.degree( );
+
+    std::vector<size_t> spanIndices( numberOfPoints );
+    pybind11::array_t<ScalarType> basisValues( { numberOfPoints, p + 1 } );
+
+    cie::splinekernel::evaluateActiveBSplineBasisBatch( tCoordinates.data( ), numberOfPoints, knotVector, 
+                                                        spanIndices.data( ), basisValues.mutable_data( ) );
+
+    return std::make_pair( spanIndices, basisValues );
+}
+
+// Evaluates the surface directly on numpy arrays of the given scalar type, one for each field
+template<typename ScalarType>
+std::vector<pybind11::array_t<ScalarType>> evaluateSurfaceFields( const std::array<std::vector<double>, 2>& knotVectors,
+                                                                  const std::vector<pybind11::array_t<ScalarType, pybind11::array::c_style | 
+                                                                                                      pybind11::array::forcecast>>& controlPoints,
+                                                                  std::array<size_t, 2> numberOfSamplePoints,
+                                                                  size_t numberOfThreads )
+{
+    cie::splinekernel::runtime_check( !controlPoints.empty( ), "No control points given." );
+
+    std::vector<pybind11::array_t<ScalarType>> results;
+
+    std::vector<const ScalarType*> controlPointData;
+    std::vector<ScalarType*> resultData;
+
+    for( const auto& field : controlPoints )
+    {
+        cie::splinekernel::runtime_check( field.ndim( ) == 2 && field.shape( 0 ) == controlPoints[0].shape( 0 ) && 
+                                          field.shape( 1 ) == controlPoints[0].shape( 1 ), "Inconsistent control point arrays." );
+
+        results.emplace_back( std::vector<size_t>{ numberOfSamplePoints[0], numberOfSamplePoints[1] } );
+
+        controlPointData.push_back( field.data( ) );
+        resultData.push_back( results.back( ).mutable_data( ) );
+    }
+
+    std::array<size_t, 2> numberOfControlPoints = { static_cast<size_t>( controlPoints[0].shape( 0 ) ), 
+                                                    static_cast<size_t>( controlPoints[0].shape( 1 ) ) };
+
+    {
+        pybind11::gil_scoped_release release;
+
+        cie::splinekernel::evaluateSurfaceFields( knotVectors, controlPointData, numberOfControlPoints, 
+                                                  numberOfSamplePoints, resultData, numberOfThreads );
+    }
+
+    return results;
+}
+
+// Evaluates a curve fleet on packed numpy arrays without converting them, returns one row per sample
+pybind11::array_t<double> evaluateCurveFleet( const cie::splinekernel::CurveFleet& fleet,
+                                              const pybind11::array_t<double, pybind11::array::c_style | pybind11::array::forcecast>& tCoordinates,
+                                              const pybind11::array_t<size_t, pybind11::array::c_style | pybind11::array::forcecast>& sampleOffsets,
+                                              size_t numberOfThreads )
+{
+    cie::splinekernel::runtime_check( tCoordinates.ndim( ) == 1 && sampleOffsets.ndim( ) == 1, "Expected one-dimensional arrays." );
+    cie::splinekernel::runtime_check( static_cast<size_t>( sampleOffsets.shape( 0 ) ) == fleet.numberOfCurves( ) + 1, 
+                                      "Invalid number of sample offsets." );
+    cie::splinekernel::runtime_check( sampleOffsets.at( fleet.numberOfCurves( ) ) == static_cast<size_t>( tCoordinates.shape( 0 ) ),
+                                      "Inconsistent number of samples." );
+
+    pybind11::array_t<double> result( { static_cast<size_t>( tCoordinates.shape( 0 ) ), fleet.numberOfDimensions( ) } );
+
+    const double* tData = tCoordinates.data( );
+    const size_t* offsetData = sampleOffsets.data( );
+    double* resultData = result.mutable_data( );
+
+    {
+        pybind11::gil_scoped_release release;
+
+        fleet.evaluate( tData, offsetData, resultData, numberOfThreads );
+    }
+
+    return result;
+}
+
+// Collects the triangles of tessellateSurface in a list instead of calling back into python
+std::vector<std::array<std::array<double, 3>, 3>> tessellateSurface( const std::array<std::vector<double>, 2>& knotVectors,
+                                                                     const cie::splinekernel::VectorOfMatrices& controlPoints,
+                                                                     double chordTolerance,
+                                                                     size_t maximumDepth )
+{
+    std::vector<std::array<std::array<double, 3>, 3>> triangles;
+
+    cie::splinekernel::tessellateSurface( knotVectors, controlPoints, chordTolerance, [&]( const std::array<std::array<double, 3>, 3>& triangle )
+    {
+        triangles.push_back( triangle );
+    }, maximumDepth );
+
+    return triangles;
+}
+
+// Opens the file in binary mode and streams the triangles of the surface into it with the given writer
+template<decltype( &cie::splinekernel::writeSurfaceStl ) Writer>
+size_t writeSurfaceFile( const std::array<std::vector<double>, 2>& knotVectors,
+                         const cie::splinekernel::VectorOfMatrices& controlPoints,
+                         double chordTolerance,
+                         const std::string& filename,
+                         size_t maximumDepth )
+{
+    std::ofstream output( filename, std::ios::binary );
+
+    cie::splinekernel::runtime_check( output.is_open( ), "Could not open output file." );
+
+    return Writer( knotVectors, controlPoints, chordTolerance, output, maximumDepth );
+}
+
+} // namespace
+
 PYBIND11_MODULE( pysplinekernel, m ) 
 {
     m.doc( ) = "spline computation kernel"; // optional module doc string
 
     m.def( "evaluateBSplineBasis", &cie::splinekernel::evaluateBSplineBasis, "Evaluates single b-spline basis function." );
-    m.def( "evaluate2DCurve", &cie::splinekernel::evaluate2DCurve, "Evaluate B-Spline curve by summing up basis functions times control points." );
-    m.def( "evaluateSurface", &cie::splinekernel::evaluateSurface, "Evaluate B-Spline surface." );
+    m.def( "findKnotSpanIndex", &cie::splinekernel::findKnotSpanIndex, "Finds the knot span containing a parametric coordinate." );
+    m.def( "evaluateActiveBSplineBasis", []( double t, size_t knotSpanIndex, size_t p, const std::vector<double>& knotVector )
+    {
+        std::vector<double> basis( p + 1 );
+
+        cie::splinekernel::evaluateActiveBSplineBasis( t, knotSpanIndex, p, knotVector, basis.data( ) );
+
+        return basis;
+    }, "Evaluates the p + 1 b-spline basis functions that are non-zero on the given knot span." );
+    m.def( "evaluateActiveBSplineDerivatives", []( double t, size_t knotSpanIndex, size_t p, 
+                                                   const std::vector<double>& knotVector, size_t maxDiffOrder )
+    {
+        std::vector<double> derivatives( ( maxDiffOrder + 1 ) * ( p + 1 ) );
+
+        cie::splinekernel::evaluateActiveBSplineDerivatives( t, knotSpanIndex, p, knotVector, maxDiffOrder, derivatives.data( ) );
+
+        return derivatives;
+    }, "Evaluates the active b-spline basis functions and their derivatives up to the given order." );
+    m.def( "evaluateActiveBSplineBasisBatch", &evaluateActiveBSplineBasisBatch<double>, "Evaluates the active b-spline basis functions for an array of parametric coordinates." );
+    m.def( "evaluateActiveBSplineBasisBatchFloat", &evaluateActiveBSplineBasisBatch<float>, "Single precision version of evaluateActiveBSplineBasisBatch." );
+    m.def( "bezierExtractionOperators", &cie::splinekernel::bezierExtractionOperators, "Computes Bezier extraction operators of all elements." );
+    m.def( "evaluate2DCurve", &cie::splinekernel::evaluate2DCurve<double>, "Evaluate B-Spline curve by summing up basis functions times control points." );
+    m.def( "evaluate2DCurveFloat", &cie::splinekernel::evaluate2DCurve<float>, "Single precision version of evaluate2DCurve." );
+    m.def( "evaluateSurface", &cie::splinekernel::evaluateSurface, "Evaluate B-Spline surface.",
+           pybind11::arg( "knotVectors" ), pybind11::arg( "controlPoints" ), pybind11::arg( "numberOfSamplePoints" ),
+           pybind11::arg( "numberOfThreads" ) = 0, pybind11::call_guard<pybind11::gil_scoped_release>( ) );
+    m.def( "evaluateSurfaceFloat", &evaluateSurfaceFields<float>, "Single precision version of evaluateSurface.",
+           pybind11::arg( "knotVectors" ), pybind11::arg( "controlPoints" ), pybind11::arg( "numberOfSamplePoints" ),
+           pybind11::arg( "numberOfThreads" ) = 0 );
+    m.def( "evaluateSurfaceGeometry", &cie::splinekernel::evaluateSurfaceGeometry, "Evaluate derivatives, normals and curvatures of B-Spline surface." );
+    m.def( "evaluateSurfaceAt", &cie::splinekernel::evaluateSurfaceAt, "Evaluate B-Spline surface at scattered points.",
+           pybind11::arg( "knotVectors" ), pybind11::arg( "controlPoints" ), pybind11::arg( "rCoordinates" ), pybind11::arg( "sCoordinates" ),
+           pybind11::arg( "numberOfThreads" ) = 0, pybind11::call_guard<pybind11::gil_scoped_release>( ) );
+    m.def( "fitSurface", &cie::splinekernel::fitSurface, "Least squares fit of B-Spline surface to scattered data.",
+           pybind11::arg( "knotVectors" ), pybind11::arg( "polynomialDegrees" ), pybind11::arg( "points" ), pybind11::arg( "rCoordinates" ),
+           pybind11::arg( "sCoordinates" ), pybind11::arg( "smoothingWeight" ) = 0.0, pybind11::arg( "numberOfThreads" ) = 0,
+           pybind11::call_guard<pybind11::gil_scoped_release>( ) );
+    m.def( "evaluate2DRationalCurve", &cie::splinekernel::evaluate2DRationalCurve<double>, "Evaluate NURBS curve." );
+    m.def( "evaluate2DRationalCurveFloat", &cie::splinekernel::evaluate2DRationalCurve<float>, "Single precision version of evaluate2DRationalCurve." );
+    m.def( "evaluate2DRationalCurveDerivative", &cie::splinekernel::evaluate2DRationalCurveDerivative<double>, "Evaluate first derivative of NURBS curve." );
+    m.def( "evaluate2DRationalCurveDerivativeFloat", &cie::splinekernel::evaluate2DRationalCurveDerivative<float>, "Single precision version of evaluate2DRationalCurveDerivative." );
+    m.def( "evaluateRationalSurface", &cie::splinekernel::evaluateRationalSurface, "Evaluate NURBS surface." );
+    m.def( "evaluateRationalSurfaceDerivatives", &cie::splinekernel::evaluateRationalSurfaceDerivatives, "Evaluate first partial derivatives of NURBS surface." );
+
+	pybind11::class_<cie::splinekernel::KnotVector> knotVector( m, "KnotVector" );
+
+	knotVector.def( pybind11::init<std::vector<double>, size_t>( ) );
+
+	knotVector.def( "degree", &cie::splinekernel::KnotVector::degree );
+	knotVector.def( "knots", &cie::splinekernel::KnotVector::knots );
+	knotVector.def( "uniqueKnots", &cie::splinekernel::KnotVector::uniqueKnots );
+	knotVector.def( "multiplicities", &cie::splinekernel::KnotVector::multiplicities );
+	knotVector.def( "numberOfBasisFunctions", &cie::splinekernel::KnotVector::numberOfBasisFunctions );
+	knotVector.def( "numberOfElements", &cie::splinekernel::KnotVector::numberOfElements );
+	knotVector.def( "findElement", pybind11::overload_cast<double>( &cie::splinekernel::KnotVector::findElement, pybind11::const_ ) );
+	knotVector.def( "findElement", pybind11::overload_cast<double, size_t>( &cie::splinekernel::KnotVector::findElement, pybind11::const_ ) );
+	knotVector.def( "findSpan", &cie::splinekernel::KnotVector::findSpan );
+	knotVector.def( "spanIndex", &cie::splinekernel::KnotVector::spanIndex );
+
+	pybind11::class_<cie::splinekernel::CurveEvaluator> curveEvaluator( m, "CurveEvaluator" );
+
+	curveEvaluator.def( pybind11::init<std::vector<double>, std::vector<std::vector<double>>>( ) );
+
+	curveEvaluator.def( "degree", &cie::splinekernel::CurveEvaluator::degree );
+	curveEvaluator.def( "numberOfDimensions", &cie::splinekernel::CurveEvaluator::numberOfDimensions );
+	curveEvaluator.def( "numberOfControlPoints", &cie::splinekernel::CurveEvaluator::numberOfControlPoints );
+	curveEvaluator.def( "evaluate", pybind11::overload_cast<const std::vector<double>&>( &cie::splinekernel::CurveEvaluator::evaluate, pybind11::const_ ) );
+	curveEvaluator.def( "evaluateDerivatives", pybind11::overload_cast<double, size_t>( &cie::splinekernel::CurveEvaluator::evaluateDerivatives, pybind11::const_ ) );
+
+	pybind11::class_<cie::splinekernel::CurveSweep> curveSweep( m, "CurveSweep" );
+
+	curveSweep.def( pybind11::init<const cie::splinekernel::CurveEvaluator&>( ), pybind11::keep_alive<1, 2>( ) );
+
+	curveSweep.def( "evaluate", []( cie::splinekernel::CurveSweep& sweep, 
+	                                pybind11::array_t<double, pybind11::array::c_style | pybind11::array::forcecast> tCoordinates )
+	{
+		size_t numberOfSamples = static_cast<size_t>( tCoordinates.size( ) );
+		size_t numberOfDimensions = sweep.curve( ).numberOfDimensions( );
+
+		pybind11::array_t<double> result( { numberOfSamples, numberOfDimensions } );
+
+		sweep.evaluate( tCoordinates.data( ), numberOfSamples, result.mutable_data( ) );
+
+		return result;
+	} );
+	curveSweep.def( "reset", &cie::splinekernel::CurveSweep::reset );
+	curveSweep.def( "span", &cie::splinekernel::CurveSweep::span );
+
+	pybind11::class_<cie::splinekernel::SurfaceGridEvaluator> surfaceGridEvaluator( m, "SurfaceGridEvaluator" );
+
+	surfaceGridEvaluator.def( pybind11::init<const std::array<std::vector<double>, 2>&, const cie::splinekernel::VectorOfMatrices&, 
+											 std::array<size_t, 2>, size_t>( ), pybind11::arg( "knotVectors" ), pybind11::arg( "controlPoints" ), 
+							  pybind11::arg( "numberOfSamplePoints" ), pybind11::arg( "numberOfThreads" ) = 0 );
+	surfaceGridEvaluator.def( "moveControlPoint", &cie::splinekernel::SurfaceGridEvaluator::moveControlPoint );
+	surfaceGridEvaluator.def( "setControlPoint", &cie::splinekernel::SurfaceGridEvaluator::setControlPoint );
+	surfaceGridEvaluator.def( "affectedSamples", &cie::splinekernel::SurfaceGridEvaluator::affectedSamples );
+	surfaceGridEvaluator.def( "numberOfSamplePoints", &cie::splinekernel::SurfaceGridEvaluator::numberOfSamplePoints );
+	surfaceGridEvaluator.def( "controlPoints", &cie::splinekernel::SurfaceGridEvaluator::controlPoints );
+	surfaceGridEvaluator.def( "samples", &cie::splinekernel::SurfaceGridEvaluator::samples );
+
+	pybind11::class_<cie::splinekernel::SurfaceGeometry> surfaceGeometry( m, "SurfaceGeometry" );
+
+	surfaceGeometry.def_readonly( "position", &cie::splinekernel::SurfaceGeometry::position );
+	surfaceGeometry.def_readonly( "derivativeR", &cie::splinekernel::SurfaceGeometry::derivativeR );
+	surfaceGeometry.def_readonly( "derivativeS", &cie::splinekernel::SurfaceGeometry::derivativeS );
+	surfaceGeometry.def_readonly( "derivativeRR", &cie::splinekernel::SurfaceGeometry::derivativeRR );
+	surfaceGeometry.def_readonly( "derivativeRS", &cie::splinekernel::SurfaceGeometry::derivativeRS );
+	surfaceGeometry.def_readonly( "derivativeSS", &cie::splinekernel::SurfaceGeometry::derivativeSS );
+	surfaceGeometry.def_readonly( "normal", &cie::splinekernel::SurfaceGeometry::normal );
+	surfaceGeometry.def_readonly( "gaussianCurvature", &cie::splinekernel::SurfaceGeometry::gaussianCurvature );
+	surfaceGeometry.def_readonly( "meanCurvature", &cie::splinekernel::SurfaceGeometry::meanCurvature );
+
+	pybind11::class_<cie::splinekernel::Polyline> polyline( m, "Polyline" );
+
+	polyline.def_readonly( "parameters", &cie::splinekernel::Polyline::parameters );
+	polyline.def_readonly( "points", &cie::splinekernel::Polyline::points );
+
+	m.def( "tessellateCurve", &cie::splinekernel::tessellateCurve, "Adaptive tessellation of a curve to chord height and angle tolerances.",
+		   pybind11::arg( "curve" ), pybind11::arg( "chordTolerance" ), pybind11::arg( "angleTolerance" ) = 0.0, pybind11::arg( "maximumDepth" ) = 24 );
+
+	m.def( "tessellateSurface", &tessellateSurface, "Adaptive watertight triangulation of a B-Spline surface to a chord height tolerance.",
+		   pybind11::arg( "knotVectors" ), pybind11::arg( "controlPoints" ), pybind11::arg( "chordTolerance" ), pybind11::arg( "maximumDepth" ) = 8,
+		   pybind11::call_guard<pybind11::gil_scoped_release>( ) );
+
+	m.def( "writeSurfaceStl", &writeSurfaceFile<&cie::splinekernel::writeSurfaceStl>, "Write the tessellation of a B-Spline surface to a binary STL file.",
+		   pybind11::arg( "knotVectors" ), pybind11::arg( "controlPoints" ), pybind11::arg( "chordTolerance" ), pybind11::arg( "filename" ),
+		   pybind11::arg( "maximumDepth" ) = 8, pybind11::call_guard<pybind11::gil_scoped_release>( ) );
+
+	m.def( "writeSurfacePly", &writeSurfaceFile<&cie::splinekernel::writeSurfacePly>, "Write the tessellation of a B-Spline surface to a binary PLY file.",
+		   pybind11::arg( "knotVectors" ), pybind11::arg( "controlPoints" ), pybind11::arg( "chordTolerance" ), pybind11::arg( "filename" ),
+		   pybind11::arg( "maximumDepth" ) = 8, pybind11::call_guard<pybind11::gil_scoped_release>( ) );
+
+	pybind11::class_<cie::splinekernel::CurveProjection> curveProjection( m, "CurveProjection" );
+
+	curveProjection.def_readonly( "parameters", &cie::splinekernel::CurveProjection::parameters );
+	curveProjection.def_readonly( "distances", &cie::splinekernel::CurveProjection::distances );
+	curveProjection.def_readonly( "points", &cie::splinekernel::CurveProjection::points );
+
+	// The queries run on worker threads without touching python objects, so the GIL is released
+	m.def( "projectOntoCurve", &cie::splinekernel::projectOntoCurve, "Closest points on a curve for a batch of query points.",
+		   pybind11::arg( "curve" ), pybind11::arg( "queryPoints" ), pybind11::arg( "numberOfThreads" ) = 0,
+		   pybind11::arg( "samplesPerSpan" ) = 8, pybind11::arg( "maximumNumberOfIterations" ) = 20,
+		   pybind11::call_guard<pybind11::gil_scoped_release>( ) );
+
+	m.def( "gaussLegendrePoints", &cie::splinekernel::gaussLegendrePoints, "Gauss-Legendre points and weights on [-1, 1]." );
+
+	pybind11::class_<cie::splinekernel::ArcLengthTable> arcLengthTable( m, "ArcLengthTable" );
+
+	arcLengthTable.def( pybind11::init<const cie::splinekernel::CurveEvaluator&, size_t, size_t>( ),
+						pybind11::arg( "curve" ), pybind11::arg( "numberOfSubdivisions" ) = 4, pybind11::arg( "numberOfGaussPoints" ) = 8,
+						pybind11::keep_alive<1, 2>( ) );
+	arcLengthTable.def( "length", &cie::splinekernel::ArcLengthTable::length );
+	arcLengthTable.def( "arcLength", &cie::splinekernel::ArcLengthTable::arcLength );
+	arcLengthTable.def( "parameter", &cie::splinekernel::ArcLengthTable::parameter, pybind11::arg( "s" ), pybind11::arg( "tolerance" ) = 1e-12 );
+	arcLengthTable.def( "parameters", &cie::splinekernel::ArcLengthTable::parameters, pybind11::arg( "arcLengths" ), pybind11::arg( "tolerance" ) = 1e-12 );
+	arcLengthTable.def( "uniformParameters", &cie::splinekernel::ArcLengthTable::uniformParameters, pybind11::arg( "numberOfPoints" ), pybind11::arg( "tolerance" ) = 1e-12 );
+	arcLengthTable.def( "breakpoints", &cie::splinekernel::ArcLengthTable::breakpoints );
+	arcLengthTable.def( "arcLengths", &cie::splinekernel::ArcLengthTable::arcLengths );
+
+	pybind11::class_<cie::splinekernel::CurveFleet> curveFleet( m, "CurveFleet" );
+
+	curveFleet.def( pybind11::init<size_t>( ) );
+	curveFleet.def( pybind11::init<size_t, std::vector<double>, std::vector<size_t>, std::vector<double>, std::vector<size_t>>( ) );
+	curveFleet.def( "addCurve", &cie::splinekernel::CurveFleet::addCurve );
+	curveFleet.def( "setControlPoints", &cie::splinekernel::CurveFleet::setControlPoints );
+	curveFleet.def( "numberOfCurves", &cie::splinekernel::CurveFleet::numberOfCurves );
+	curveFleet.def( "numberOfDimensions", &cie::splinekernel::CurveFleet::numberOfDimensions );
+	curveFleet.def( "degree", &cie::splinekernel::CurveFleet::degree );
+	curveFleet.def( "lowerBound", &cie::splinekernel::CurveFleet::lowerBound );
+	curveFleet.def( "upperBound", &cie::splinekernel::CurveFleet::upperBound );
+	curveFleet.def( "knots", &cie::splinekernel::CurveFleet::knots );
+	curveFleet.def( "knotOffsets", &cie::splinekernel::CurveFleet::knotOffsets );
+	curveFleet.def( "controlPoints", &cie::splinekernel::CurveFleet::controlPoints );
+	curveFleet.def( "controlPointOffsets", &cie::splinekernel::CurveFleet::controlPointOffsets );
+	curveFleet.def( "evaluate", &evaluateCurveFleet, pybind11::arg( "tCoordinates" ), pybind11::arg( "sampleOffsets" ), pybind11::arg( "numberOfThreads" ) = 0 );
+	curveFleet.def( "evaluateUniform", &cie::splinekernel::CurveFleet::evaluateUniform, pybind11::arg( "numberOfSamples" ), pybind11::arg( "numberOfThreads" ) = 0,
+					pybind11::call_guard<pybind11::gil_scoped_release>( ) );
+
+	pybind11::class_<cie::splinekernel::CurveSpan> curveSpan( m, "CurveSpan" );
+
+	curveSpan.def_readonly( "curveIndex", &cie::splinekernel::CurveSpan::curveIndex );
+	curveSpan.def_readonly( "elementIndex", &cie::splinekernel::CurveSpan::elementIndex );
+	curveSpan.def_readonly( "lowerParameter", &cie::splinekernel::CurveSpan::lowerParameter );
+	curveSpan.def_readonly( "upperParameter", &cie::splinekernel::CurveSpan::upperParameter );
+
+	pybind11::class_<cie::splinekernel::SpanHierarchy> spanHierarchy( m, "SpanHierarchy" );
+
+	spanHierarchy.def( pybind11::init<const cie::splinekernel::CurveFleet&, size_t>( ), pybind11::arg( "fleet" ),
+					   pybind11::arg( "maximumLeafSize" ) = 2, pybind11::keep_alive<1, 2>( ) );
+	spanHierarchy.def( "update", pybind11::overload_cast<>( &cie::splinekernel::SpanHierarchy::update ) );
+	spanHierarchy.def( "update", pybind11::overload_cast<size_t>( &cie::splinekernel::SpanHierarchy::update ) );
+	spanHierarchy.def( "numberOfSpans", &cie::splinekernel::SpanHierarchy::numberOfSpans );
+	spanHierarchy.def( "numberOfNodes", &cie::splinekernel::SpanHierarchy::numberOfNodes );
+	spanHierarchy.def( "span", &cie::splinekernel::SpanHierarchy::span );
+	spanHierarchy.def( "lowerBounds", pybind11::overload_cast<size_t>( &cie::splinekernel::SpanHierarchy::lowerBounds, pybind11::const_ ) );
+	spanHierarchy.def( "lowerBounds", pybind11::overload_cast<>( &cie::splinekernel::SpanHierarchy::lowerBounds, pybind11::const_ ) );
+	spanHierarchy.def( "upperBounds", pybind11::overload_cast<size_t>( &cie::splinekernel::SpanHierarchy::upperBounds, pybind11::const_ ) );
+	spanHierarchy.def( "upperBounds", pybind11::overload_cast<>( &cie::splinekernel::SpanHierarchy::upperBounds, pybind11::const_ ) );
+	spanHierarchy.def( "intersectBox", &cie::splinekernel::SpanHierarchy::intersectBox );
+	spanHierarchy.def( "intersectRay", &cie::splinekernel::SpanHierarchy::intersectRay, pybind11::arg( "origin" ), pybind11::arg( "direction" ),
+					   pybind11::arg( "maximumDistance" ) = std::numeric_limits<double>::infinity( ) );
+	spanHierarchy.def( "nearestSpans", &cie::splinekernel::SpanHierarchy::nearestSpans );
 
 	// Export the class BSplineFiniteElementPatch and corresponding public member functions in pybind11 using the class_ class template.
 	pybind11::class_<cie::splinekernel::BSplineFiniteElementPatch> patch( m, "BSplineFiniteElementPatch" );
@@ -29,8 +360,48 @@ PYBIND11_MODULE( pysplinekernel, m )
 
 	// member functions
 	patch.def( "evaluateActiveBasisAt", &cie::splinekernel::BSplineFiniteElementPatch::evaluateActiveBasisAt ); 
-	patch.def( "integrateElementSystem", &cie::splinekernel::BSplineFiniteElementPatch::integrateElementSystem );
+	patch.def( "evaluateActiveBasisDerivativesAt", &cie::splinekernel::BSplineFiniteElementPatch::evaluateActiveBasisDerivativesAt );
+	patch.def( "integrateElementSystem", pybind11::overload_cast<std::array<size_t, 2>, const cie::splinekernel::SpatialFunction&>( 
+		&cie::splinekernel::BSplineFiniteElementPatch::integrateElementSystem, pybind11::const_ ) );
 	patch.def( "assembleGlobalSystem", &cie::splinekernel::BSplineFiniteElementPatch::assembleGlobalSystem );
 	patch.def( "boundaryDofIds", &cie::splinekernel::BSplineFiniteElementPatch::boundaryDofIds );
 	patch.def( "solutionEvaluator", &cie::splinekernel::BSplineFiniteElementPatch::solutionEvaluator );
+	patch.def( "elementClasses", &cie::splinekernel::BSplineFiniteElementPatch::elementClasses );
+	patch.def( "knotVector", &cie::splinekernel::BSplineFiniteElementPatch::knotVector, pybind11::return_value_policy::reference_internal );
+	patch.def( "extractionOperators", &cie::splinekernel::BSplineFiniteElementPatch::extractionOperators );
+
+	pybind11::class_<cie::splinekernel::ProlongationOperator> prolongation( m, "ProlongationOperator" );
+
+	prolongation.def( "size1", &cie::splinekernel::ProlongationOperator::size1 );
+	prolongation.def( "size2", &cie::splinekernel::ProlongationOperator::size2 );
+	prolongation.def( "nnz", &cie::splinekernel::ProlongationOperator::nnz );
+	prolongation.def( "__call__", &cie::splinekernel::ProlongationOperator::operator() );
+	prolongation.def( "__mul__", &cie::splinekernel::ProlongationOperator::operator* );
+	prolongation.def( "indptr", &cie::splinekernel::ProlongationOperator::indptr );
+	prolongation.def( "indices", &cie::splinekernel::ProlongationOperator::indices );
+	prolongation.def( "data", &cie::splinekernel::ProlongationOperator::data );
+
+	pybind11::class_<cie::splinekernel::KnotRefinement> knotRefinement( m, "KnotRefinement" );
+
+	knotRefinement.def_readonly( "knotVector", &cie::splinekernel::KnotRefinement::knotVector );
+	knotRefinement.def_readonly( "prolongation", &cie::splinekernel::KnotRefinement::prolongation );
+
+	m.def( "insertKnot", &cie::splinekernel::insertKnot, "Insert single knot using Boehm's algorithm." );
+	m.def( "refineKnotVector", &cie::splinekernel::refineKnotVector, "Insert multiple knots using the Oslo algorithm." );
+	m.def( "tensorProduct", &cie::splinekernel::tensorProduct, "Prolongation of tensor product basis." );
+	m.def( "refineControlGrid", &cie::splinekernel::refineControlGrid, "Refine grid of surface control points." );
+	m.def( "patchProlongation", &cie::splinekernel::patchProlongation, "Prolongation from coarse to refined patch." );
+
+	pybind11::class_<cie::splinekernel::CurveReduction> curveReduction( m, "CurveReduction" );
+
+	curveReduction.def_readonly( "knotVector", &cie::splinekernel::CurveReduction::knotVector );
+	curveReduction.def_readonly( "degree", &cie::splinekernel::CurveReduction::degree );
+	curveReduction.def_readonly( "controlPoints", &cie::splinekernel::CurveReduction::controlPoints );
+	curveReduction.def_readonly( "errorBound", &cie::splinekernel::CurveReduction::errorBound );
+
+	m.def( "removeKnots", &cie::splinekernel::removeKnots, "Remove knots of a curve within a tolerance." );
+	m.def( "reduceDegree", &cie::splinekernel::reduceDegree, "Reduce polynomial degree of a curve by one." );
+	m.def( "compressCurve", &cie::splinekernel::compressCurve, "Reduce degree and remove knots of a curve within a tolerance.",
+		   pybind11::arg( "knotVector" ), pybind11::arg( "p" ), pybind11::arg( "controlPoints" ), pybind11::arg( "tolerance" ),
+		   pybind11::arg( "reduceDegrees" ) = false );
 }
@@ -26,14 +26,16 @@ controlPointGrid = numpy.transpose( numpy.array( controlPointGrid ), ( 2, 0, 1 )
 numberOfSamples = ( numberOfSamplesInR, numberOfSamplesInS )
 knotVectors = ( knotVectorR, knotVectorS )
 
-xyz = pysplinekernel.evaluateSurface( knotVectors, controlPointGrid, numberOfSamples )
+geometry = pysplinekernel.evaluateSurfaceGeometry( knotVectors, controlPointGrid, numberOfSamples )
+
+xyz = numpy.array( geometry.position )
 
 # Plot surface (https://matplotlib.org/mpl_toolkits/mplot3d/tutorial.html)
 fig = plt.figure( )
 ax = fig.gca( projection='3d' )
 
-# Compute gradient of z coordinate to add some nice colors to the plot
-gradientX, gradientY = numpy.gradient( xyz[2] )
+# Use the exact gradient of the z coordinate to add some nice colors to the plot
+gradientX, gradientY = numpy.array( geometry.derivativeR[2] ), numpy.array( geometry.derivativeS[2] )
 gradientMagnitude = numpy.sqrt( gradientX**2 + gradientY**2 ) 
 colorMap = colormap.jet( gradientMagnitude / numpy.max( gradientMagnitude ) )
 
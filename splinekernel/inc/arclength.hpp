@@ -0,0 +1,60 @@
+#pragma once
+
+#include "alias.hpp"
+#include "curve.hpp"
+
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+/*! Arc length table of a curve for reparametrization by arc length. Every knot span is split     *
+ *  into numberOfSubdivisions intervals, whose lengths are integrated once with a Gauss-Legendre *
+ *  rule and accumulated. The length up to t is the table entry of the interval containing t      *
+ *  plus a Gauss integral over the rest of the interval. The inverse finds the interval by binary *
+ *  search in the table (O(log n)) and polishes the parameter with Newton iterations using        *
+ *  ds/dt = |C'(t)|, falling back to bisection within the interval. The table keeps a reference  *
+ *  to the curve, which must outlive it.                                                          */
+class ArcLengthTable
+{
+public:
+    explicit ArcLengthTable( const CurveEvaluator& curve,
+                             size_t numberOfSubdivisions = 4,
+                             size_t numberOfGaussPoints = 8 );
+
+    //! Total length of the curve
+    double length( ) const;
+
+    //! Length of the curve from the first parameter up to t
+    double arcLength( double t ) const;
+
+    //! Parameter t at which the arc length equals s, for 0 <= s <= length( )
+    double parameter( double s, double tolerance = 1e-12 ) const;
+
+    //! Parameters for many arc lengths (no particular order needed)
+    std::vector<double> parameters( const std::vector<double>& arcLengths, double tolerance = 1e-12 ) const;
+
+    //! Parameters of numberOfPoints points that are evenly spaced by arc length, including both ends
+    std::vector<double> uniformParameters( size_t numberOfPoints, double tolerance = 1e-12 ) const;
+
+    //! Interval boundaries and the arc length at each of them
+    const std::vector<double>& breakpoints( ) const;
+    const std::vector<double>& arcLengths( ) const;
+
+    const CurveEvaluator& curve( ) const;
+
+private:
+    double speed( double t, std::vector<double>& derivatives ) const;
+    double integrate( double t0, double t1, std::vector<double>& derivatives ) const;
+
+    const CurveEvaluator& curve_;
+
+    IntegrationPoints gaussPoints_;
+
+    std::vector<double> breakpoints_, arcLengths_;
+};
+
+} // namespace splinekernel
+} // namespace cie
@@ -3,6 +3,8 @@
 #include <vector>
 #include "stddef.h"
 
+#include "knotvector.hpp"
+
 namespace cie
 {
 namespace splinekernel
@@ -13,12 +15,69 @@ double evaluateBSplineBasis( double t,
                              size_t p,
                              const std::vector<double>& knotVector );
 
-// evaluates the one-dimensional B-Spline basis functions or their first derivative.
+// evaluates the one-dimensional B-Spline basis functions or their derivative of arbitrary order.
 double evaluateBSplineDerivative( double t,
                                   size_t functionIndex,
                                   size_t degree,
                                   const std::vector<double>& knotVector,
                                   size_t diffOrder );
 
+//! Find the index i of the non-empty knot span [t_i, t_{i+1}) that contains t. Parameters
+//! outside of [t_p, t_n] are mapped to the first or last span, respectively.
+size_t findKnotSpanIndex( double t,
+                          size_t p,
+                          const std::vector<double>& knotVector );
+
+/*! Evaluates the p + 1 basis functions N_{i-p}, ..., N_i that are non-zero on the knot span i  *
+ *  in one triangular sweep instead of calling the recursive evaluateBSplineBasis p + 1 times. *
+ *  The results are written to target, which must provide space for p + 1 values.             *
+ *  The evaluation kernels below are instantiated for ScalarType float and double. The knots   *
+ *  are always given in double precision and are converted to ScalarType for the arithmetic.   */
+template<typename ScalarType>
+void evaluateActiveBSplineBasis( ScalarType t,
+                                 size_t knotSpanIndex,
+                                 size_t p,
+                                 const std::vector<double>& knotVector,
+                                 ScalarType* target );
+
+//! Same as above for knots stored in a larger array, e.g. packed knot vectors of several curves
+template<typename ScalarType>
+void evaluateActiveBSplineBasis( ScalarType t,
+                                 size_t knotSpanIndex,
+                                 size_t p,
+                                 const double* knotVector,
+                                 ScalarType* target );
+
+/*! Evaluates the p + 1 basis functions that are non-zero on the knot span i together with all  *
+ *  their derivatives up to maxDiffOrder, sharing one triangular table for all orders. The k-th *
+ *  derivative of N_{i-p+a} is written to target[k * (p + 1) + a], so target must provide space *
+ *  for (maxDiffOrder + 1) * (p + 1) values. Derivatives of order larger than p are zero.       */
+template<typename ScalarType>
+void evaluateActiveBSplineDerivatives( ScalarType t,
+                                       size_t knotSpanIndex,
+                                       size_t p,
+                                       const std::vector<double>& knotVector,
+                                       size_t maxDiffOrder,
+                                       ScalarType* target );
+
+/*! Evaluates the active basis functions for a contiguous array of parametric coordinates. The   *
+ *  points are grouped by knot span, such that all points of a group share the same knots and     *
+ *  the triangular recurrence can be done for batchLaneWidth points at once in loops that the     *
+ *  compiler vectorizes (see SPLINEKERNEL_NATIVE_ARCH). For point k the span index is written to  *
+ *  spanIndices[k] and the p + 1 basis function values to basisValues[k * (p + 1) + a], so the    *
+ *  output buffers must provide space for numberOfPoints and numberOfPoints * (p + 1) entries.   *
+ *  Points outside of [t_p, t_n] get the span of the nearest element, but the basis functions are *
+ *  evaluated in the knot interval containing the point (zero outside of the knot vector).        */
+template<typename ScalarType>
+void evaluateActiveBSplineBasisBatch( const ScalarType* tCoordinates,
+                                      size_t numberOfPoints,
+                                      const KnotVector& knotVector,
+                                      size_t* spanIndices,
+                                      ScalarType* basisValues );
+
+//! Number of points processed simultaneously by evaluateActiveBSplineBasisBatch in double
+//! precision. In single precision twice as many points fit into the same vector registers.
+constexpr size_t batchLaneWidth = 8;
+
 } // splinekernel
 } // cie
\ No newline at end of file
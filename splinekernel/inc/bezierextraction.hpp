@@ -0,0 +1,32 @@
+#pragma once
+
+#include "linalg.hpp"
+#include "knotvector.hpp"
+
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+/*! Bezier extraction operators of all elements of an open knot vector. On element e the active *
+ *  B-Spline basis functions are N = C_e * B, where B are the Bernstein polynomials of degree p  *
+ *  on the local element coordinate [-1, 1]. C_e(a, b) is the coefficient of B_b in N_a. The     *
+ *  operators are the entries of the prolongation to the knot vector in which all interior knots *
+ *  are repeated p times, since the refined basis restricted to one element is the Bernstein one. */
+std::vector<linalg::Matrix> bezierExtractionOperators( const KnotVector& knotVector );
+
+/*! Bernstein polynomials of degree p and their derivatives on [-1, 1] at local coordinate xi. *
+ *  The layout of target is the same as for evaluateActiveBSplineDerivatives.                  */
+void evaluateBernsteinBasis( double xi, size_t p, size_t maxDiffOrder, double* target );
+
+/*! Map numberOfRows rows of Bernstein values (each of length p + 1) to the active B-Spline *
+ *  basis by computing target row = C * bernstein row.                                       */
+void applyExtractionOperator( const linalg::Matrix& extractionOperator,
+                              const double* bernstein,
+                              size_t numberOfRows,
+                              double* target );
+
+} // namespace splinekernel
+} // namespace cie
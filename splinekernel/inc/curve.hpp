@@ -3,6 +3,8 @@
 #include <vector>
 #include <array>
 
+#include "knotvector.hpp"
+
 namespace cie
 {
 namespace splinekernel
@@ -17,12 +19,130 @@ namespace splinekernel
  *  @param xCoordinates The x coordinates of the control points
  *  @param yCoordinates The y coordinates of the control points
  *  @return a vector of x and a vector of y coordinates with one value for each parametric
- *          coordinate tCoordinates
+ *          coordinate tCoordinates. Coordinates outside of the knot vector give (0, 0), since
+ *          all basis functions vanish there.
+ *  The curve functions are instantiated for ScalarType float and double, the knot vector is
+ *  always given in double precision.
+ */
+template<typename ScalarType>
+std::array<std::vector<ScalarType>, 2> evaluate2DCurve( const std::vector<ScalarType>& tCoordinates,
+                                                        const std::vector<ScalarType>& xCoordinates,
+                                                        const std::vector<ScalarType>& yCoordinates,
+                                                        const std::vector<double>& knotVector );
+
+/*! Evaluate NURBS curve. The weighted basis functions and their sum are accumulated in the same
+ *  pass over the active basis functions, which is shared by the x and y coordinates.
+ *  @param weights The weights of the control points
+ *  @return a vector of x and a vector of y coordinates with one value for each parametric
+ *          coordinate tCoordinates. As for evaluate2DCurve, coordinates where all basis
+ *          functions vanish (outside of the knot vector) give (0, 0).
+ */
+template<typename ScalarType>
+std::array<std::vector<ScalarType>, 2> evaluate2DRationalCurve( const std::vector<ScalarType>& tCoordinates,
+                                                                const std::vector<ScalarType>& xCoordinates,
+                                                                const std::vector<ScalarType>& yCoordinates,
+                                                                const std::vector<ScalarType>& weights,
+                                                                const std::vector<double>& knotVector );
+
+/*! Evaluate the first derivative dC/dt of a NURBS curve using the quotient rule
+ *  C' = ( A' - W' C ) / W, where A and W are the weighted sums of control points and weights.
+ *  @return a vector of dx/dt and a vector of dy/dt values for each tCoordinate, (0, 0) where
+ *          all basis functions vanish
+ */
+template<typename ScalarType>
+std::array<std::vector<ScalarType>, 2> evaluate2DRationalCurveDerivative( const std::vector<ScalarType>& tCoordinates,
+                                                                          const std::vector<ScalarType>& xCoordinates,
+                                                                          const std::vector<ScalarType>& yCoordinates,
+                                                                          const std::vector<ScalarType>& weights,
+                                                                          const std::vector<double>& knotVector );
+
+/*! B-Spline curve with an arbitrary number of coordinates per control point. The knot vector is
+ *  validated and preprocessed once on construction and the control points are stored in one
+ *  contiguous array, such that the p + 1 control points active on a knot span are adjacent in
+ *  memory. Evaluations only touch the active span: O(p^2) operations per sample instead of
+ *  evaluating all n basis functions.
+ */
+class CurveEvaluator
+{
+public:
+    /*! @param knotVector The knot vector, from which the degree is derived once
+     *  @param controlPoints One vector per coordinate (e.g. { x, y, z }), each with one value per
+     *                       control point
+     */
+    CurveEvaluator( const std::vector<double>& knotVector,
+                    const std::vector<std::vector<double>>& controlPoints );
+
+    size_t degree( ) const;
+    size_t numberOfDimensions( ) const;
+    size_t numberOfControlPoints( ) const;
+
+    const KnotVector& knotVector( ) const;
+
+    //! Coordinate d of control point i is stored at index i * numberOfDimensions( ) + d
+    const std::vector<double>& controlPoints( ) const;
+
+    //! Write the numberOfDimensions( ) coordinates of the curve point at t to target
+    void evaluate( double t, double* target ) const;
+
+    //! Write the derivative of order k of coordinate d at t to target[k * numberOfDimensions( ) + d]
+    void evaluateDerivatives( double t, size_t maxDiffOrder, double* target ) const;
+
+    //! Same as above with caller-owned space for ( maxDiffOrder + 1 ) * ( degree( ) + 1 ) basis values,
+    //! which is reused across calls (e.g. once per thread), so the evaluation does not allocate
+    void evaluateDerivatives( double t, size_t maxDiffOrder, double* target, double* basisWorkspace ) const;
+
+    //! Curve points at all tCoordinates with one vector per coordinate, as in evaluate2DCurve
+    std::vector<std::vector<double>> evaluate( const std::vector<double>& tCoordinates ) const;
+
+    //! Derivatives at t with one vector of coordinates per derivative order
+    std::vector<std::vector<double>> evaluateDerivatives( double t, size_t maxDiffOrder ) const;
+
+private:
+    KnotVector knotVector_;
+
+    size_t numberOfDimensions_;
+
+    std::vector<double> controlPoints_;
+};
+
+/*! Streaming evaluation of a CurveEvaluator for non-decreasing parameters, e.g. linspace grids
+ *  that are processed in chunks. The knot span is advanced incrementally instead of searched,
+ *  and the knots and inverse knot differences of the triangular recurrence are stored when a
+ *  new span is entered, so consecutive samples in the same span only do multiplications. All
+ *  storage is allocated on construction, evaluate itself does not allocate. The sweep keeps a
+ *  reference to the curve, which must outlive it.
  */
-std::array<std::vector<double>, 2> evaluate2DCurve( const std::vector<double>& tCoordinates,
-                                                    const std::vector<double>& xCoordinates,
-                                                    const std::vector<double>& yCoordinates,
-                                                    const std::vector<double>& knotVector );
+class CurveSweep
+{
+public:
+    explicit CurveSweep( const CurveEvaluator& curve );
+
+    /*! Evaluate the curve at the next numberOfSamples parameters, which must not be smaller than
+     *  the previous ones. Coordinate d of sample i is written to target[i * numberOfDimensions + d].
+     */
+    void evaluate( const double* tCoordinates, size_t numberOfSamples, double* target );
+
+    //! Start a new sweep from the beginning of the curve
+    void reset( );
+
+    //! Index of the current knot span
+    size_t span( ) const;
+
+    const CurveEvaluator& curve( ) const;
+
+private:
+    void enterSpan( size_t span );
+
+    const CurveEvaluator& curve_;
+
+    size_t span_;
+    double previous_;
+
+    // Knots and inverse differences of the triangular recurrence on the current span
+    std::vector<double> leftKnots_, rightKnots_, inverses_;
+
+    std::vector<double> N_;
+};
 
 } // namespace splinekernel
 } // namespace cie
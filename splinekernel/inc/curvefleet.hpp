@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+
+#include "stddef.h"
+
+namespace cie
+{
+namespace splinekernel
+{
+
+/*! Many independent B-Spline curves in packed storage: the knot vectors of all curves are stored *
+ *  in one array, as well as their control points (with the coordinates of each point adjacent,  *
+ *  as in CurveEvaluator). Curve i owns knots[knotOffsets[i]] to knots[knotOffsets[i + 1] - 1]    *
+ *  and control points controlPointOffsets[i] to controlPointOffsets[i + 1] - 1. The degree of    *
+ *  each curve follows from the number of its knots and control points. All curves must have    *
+ *  the same number of coordinates.                                                              */
+class CurveFleet
+{
+public:
+    explicit CurveFleet( size_t numberOfDimensions );
+
+    //! From packed arrays, where the offsets have one entry more than the number of curves
+    CurveFleet( size_t numberOfDimensions,
+                std::vector<double> knots,
+                std::vector<size_t> knotOffsets,
+                std::vector<double> controlPoints,
+                std::vector<size_t> controlPointOffsets );
+
+    //! Append a curve with one vector per coordinate, returns the index of the new curve
+    size_t addCurve( const std::vector<double>& knotVector,
+                     const std::vector<std::vector<double>>& controlPoints );
+
+    //! Move the control points of a curve, their number must not change
+    void setControlPoints( size_t curveIndex,
+                           const std::vector<std::vector<double>>& controlPoints );
+
+    size_t numberOfCurves( ) const;
+    size_t numberOfDimensions( ) const;
+
+    size_t degree( size_t curveIndex ) const;
+
+    //! Parameter range [t_p, t_n] of a curve
+    double lowerBound( size_t curveIndex ) const;
+    double upperBound( size_t curveIndex ) const;
+
+    const std::vector<double>& knots( ) const;
+    const std::vector<size_t>& knotOffsets( ) const;
+    const std::vector<double>& controlPoints( ) const;
+    const std::vector<size_t>& controlPointOffsets( ) const;
+
+    /*! Evaluate all curves at once. Curve i is evaluated at the parameters tCoordinates[k] with  *
+     *  sampleOffsets[i] <= k < sampleOffsets[i + 1] and coordinate d of sample k is written to    *
+     *  target[k * numberOfDimensions( ) + d]. The curves are distributed to numberOfThreads        *
+     *  threads (0: all hardware threads), the results do not depend on the number of threads.     */
+    void evaluate( const double* tCoordinates,
+                   const size_t* sampleOffsets,
+                   double* target,
+                   size_t numberOfThreads = 0 ) const;
+
+    //! Same as above with the packed samples returned in a new array
+    std::vector<double> evaluate( const std::vector<double>& tCoordinates,
+                                  const std::vector<size_t>& sampleOffsets,
+                                  size_t numberOfThreads = 0 ) const;
+
+    //! Evaluate each curve at numberOfSamples parameters evenly spaced over its parameter range
+    std::vector<double> evaluateUniform( size_t numberOfSamples,
+                                         size_t numberOfThreads = 0 ) const;
+
+private:
+    void checkCurve( size_t curveIndex ) const;
+
+    size_t numberOfDimensions_;
+
+    std::vector<double> knots_;
+    std::vector<size_t> knotOffsets_;
+    std::vector<double> controlPoints_;
+    std::vector<size_t> controlPointOffsets_;
+
+    size_t maximumDegree_;
+};
+
+} // namespace splinekernel
+} // namespace cie
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <vector>
+#include <array>
+
+#include "linalg.hpp"
+#include "knotvector.hpp"
+
+namespace cie
+{
+namespace splinekernel
+{
+
+//! Largest polynomial degree for which compile-time specialized kernels are instantiated
+constexpr size_t maximumFixedDegree = 6;
+
+/*! Values and first derivatives of the p + 1 basis functions that are active on one element, *
+ *  evaluated at the integration points in one direction. Function a at point i is stored at   *
+ *  index i * (p + 1) + a of values and derivatives.                                           */
+struct BasisFunctionTable
+{
+    size_t degree = 0;
+    size_t numberOfPoints = 0;
+
+    std::vector<double> values, derivatives;
+};
+
+//! Fills a BasisFunctionTable for the given coordinates, all lying in the given knot span
+using BasisTableKernel = void( * )( const std::vector<double>& coordinates,
+                                    size_t knotSpanIndex,
+                                    const KnotVector& knotVector,
+                                    BasisFunctionTable& table );
+
+/*! Adds the element stiffness matrix and load vector of the Laplace problem, integrated from *
+ *  two basis tables, to Ke and Fe. weights and sourceValues hold one entry per tensor product *
+ *  integration point (index i * ny + j), where the weights include the Jacobian determinant.  */
+using ElementKernel = void( * )( const BasisFunctionTable& tableX,
+                                 const BasisFunctionTable& tableY,
+                                 const std::vector<double>& weights,
+                                 const std::vector<double>& sourceValues,
+                                 linalg::Matrix& Ke,
+                                 std::vector<double>& Fe );
+
+//! Returns the kernel specialized for degree p, or the generic one if p > maximumFixedDegree
+BasisTableKernel selectBasisTableKernel( size_t p );
+
+//! Returns the kernel specialized for the degrees px and py, or the generic one otherwise
+ElementKernel selectElementKernel( std::array<size_t, 2> polynomialDegrees );
+
+//! Runtime degree versions used when no specialization is available
+void evaluateGenericBasisTable( const std::vector<double>& coordinates,
+                                size_t knotSpanIndex,
+                                const KnotVector& knotVector,
+                                BasisFunctionTable& table );
+
+void integrateGenericElement( const BasisFunctionTable& tableX,
+                              const BasisFunctionTable& tableY,
+                              const std::vector<double>& weights,
+                              const std::vector<double>& sourceValues,
+                              linalg::Matrix& Ke,
+                              std::vector<double>& Fe );
+
+/*! Compile-time degree version of evaluateGenericBasisTable. With the trip counts known and *
+ *  the temporaries in std::arrays the compiler can fully unroll the triangular recurrence. *
+ *  The derivatives are formed from the degree P - 1 values during the last sweep.          */
+template<size_t P>
+void evaluateFixedDegreeBasisTable( const std::vector<double>& coordinates,
+                                    size_t knotSpanIndex,
+                                    const KnotVector& knotVector,
+                                    BasisFunctionTable& table )
+{
+    const std::vector<double>& knots = knotVector.knots( );
+
+    table.degree = P;
+    table.numberOfPoints = coordinates.size( );
+    table.values.resize( coordinates.size( ) * ( P + 1 ) );
+    table.derivatives.resize( coordinates.size( ) * ( P + 1 ) );
+
+    for( size_t iPoint = 0; iPoint < coordinates.size( ); ++iPoint )
+    {
+        double t = coordinates[iPoint];
+
+        std::array<double, P + 1> N { }, dN { };
+
+        N[0] = 1.0;
+
+        for( size_t j = 1; j <= P; ++j )
+        {
+            double saved = 0.0;
+
+            for( size_t r = 0; r < j; ++r )
+            {
+                double leftKnot = knots[knotSpanIndex + 1 + r - j];
+                double rightKnot = knots[knotSpanIndex + 1 + r];
+
+                double temp = N[r] / ( rightKnot - leftKnot );
+
+                // dN_a = P * ( N_{a-1,P-1} / ( t_{a+P} - t_a ) - N_{a,P-1} / ( t_{a+P+1} - t_{a+1} ) )
+                if( j == P )
+                {
+                    dN[r] -= P * temp;
+                    dN[r + 1] += P * temp;
+                }
+
+                N[r] = saved + ( rightKnot - t ) * temp;
+                saved = ( t - leftKnot ) * temp;
+            }
+
+            N[j] = saved;
+        }
+
+        for( size_t a = 0; a <= P; ++a )
+        {
+            table.values[iPoint * ( P + 1 ) + a] = N[a];
+            table.derivatives[iPoint * ( P + 1 ) + a] = dN[a];
+        }
+    }
+}
+
+//! Compile-time degree version of integrateGenericElement with fixed size storage
+template<size_t PX, size_t PY>
+void integrateFixedDegreeElement( const BasisFunctionTable& tableX,
+                                  const BasisFunctionTable& tableY,
+                                  const std::vector<double>& weights,
+                                  const std::vector<double>& sourceValues,
+                                  linalg::Matrix& Ke,
+                                  std::vector<double>& Fe )
+{
+    constexpr size_t numberOfElementDofs = ( PX + 1 ) * ( PY + 1 );
+
+    std::array<double, numberOfElementDofs * numberOfElementDofs> K { };
+    std::array<double, numberOfElementDofs> F { };
+    std::array<double, numberOfElementDofs> N, dNdx, dNdy;
+
+    size_t ny = tableY.numberOfPoints;
+
+    for( size_t iPoint = 0; iPoint < tableX.numberOfPoints; ++iPoint )
+    {
+        const double* Bx = tableX.values.data( ) + iPoint * ( PX + 1 );
+        const double* dBx = tableX.derivatives.data( ) + iPoint * ( PX + 1 );
+
+        for( size_t jPoint = 0; jPoint < ny; ++jPoint )
+        {
+            const double* By = tableY.values.data( ) + jPoint * ( PY + 1 );
+            const double* dBy = tableY.derivatives.data( ) + jPoint * ( PY + 1 );
+
+            for( size_t i = 0; i <= PX; ++i )
+            {
+                for( size_t j = 0; j <= PY; ++j )
+                {
+                    N[i * ( PY + 1 ) + j] = Bx[i] * By[j];
+                    dNdx[i * ( PY + 1 ) + j] = dBx[i] * By[j];
+                    dNdy[i * ( PY + 1 ) + j] = Bx[i] * dBy[j];
+                }
+            }
+
+            double weight = weights[iPoint * ny + jPoint];
+            double f = sourceValues[iPoint * ny + jPoint] * weight;
+
+            for( size_t i = 0; i < numberOfElementDofs; ++i )
+            {
+                double wx = dNdx[i] * weight;
+                double wy = dNdy[i] * weight;
+
+                for( size_t j = 0; j < numberOfElementDofs; ++j )
+                {
+                    K[i * numberOfElementDofs + j] += wx * dNdx[j] + wy * dNdy[j];
+                }
+
+                F[i] += N[i] * f;
+            }
+        }
+    }
+
+    for( size_t i = 0; i < numberOfElementDofs; ++i )
+    {
+        for( size_t j = 0; j < numberOfElementDofs; ++j )
+        {
+            Ke( i, j ) += K[i * numberOfElementDofs + j];
+        }
+
+        Fe[i] += F[i];
+    }
+}
+
+} // namespace splinekernel
+} // namespace cie
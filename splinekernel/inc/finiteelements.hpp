@@ -4,10 +4,14 @@
 #include <tuple>
 #include <array>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 #include "linalg.hpp"
 #include "alias.hpp"
 #include "utilities.hpp"
+#include "knotvector.hpp"
+#include "elementkernels.hpp"
 
 namespace cie
 {
@@ -31,6 +35,12 @@ public:
     std::vector<double> evaluateActiveBasisAt( std::array<double, 2> globalCoordinates,
                                                std::array<size_t, 2> diffOrders ) const;
 
+    /*! Evaluate the active tensor product basis and all its partial derivatives up to maxDiffOrder  *
+     *  in each direction using one sweep per direction. The derivative d^(kx + ky) / dx^kx dy^ky is *
+     *  stored at index kx * (maxDiffOrder + 1) + ky of the returned vector.                         */
+    std::vector<std::vector<double>> evaluateActiveBasisDerivativesAt( std::array<double, 2> globalCoordinates,
+                                                                       size_t maxDiffOrder ) const;
+
     ElementLinearSystem integrateElementSystem( std::array<size_t, 2> elementIndices,
                                                 const SpatialFunction& sourceFunction ) const;
     
@@ -39,15 +49,58 @@ public:
     std::vector<size_t> boundaryDofIds( const std::string& side ) const;
 
     SpatialFunction solutionEvaluator( const std::vector<double>& solutionDofs ) const;
+
+    //! Index of the element class of each element in the given direction (see detail::findElementClasses)
+    const std::vector<size_t>& elementClasses( size_t axis ) const;
+
+    const KnotVector& knotVector( size_t axis ) const;
+
+    //! Bezier extraction operator of each element in the given direction (see bezierExtractionOperators)
+    const std::vector<linalg::Matrix>& extractionOperators( size_t axis ) const;
     
 private:
+    //! Integration points and 1D basis tables of one representative element per element class
+    struct QuadratureTables
+    {
+        std::array<IntegrationPoints, 2> integrationPoints;
+        std::array<std::vector<BasisFunctionTable>, 2> basisTables;
+    };
+
+    QuadratureTables evaluateQuadratureTables( ) const;
+
+    //! The tables of this patch, evaluated on first use and shared by all element integrations
+    const QuadratureTables& quadratureTables( ) const;
+
+    //! Active basis functions and derivatives in one direction, mapped from the Bernstein basis
+    void evaluateExtractedBasis( size_t axis, double x, size_t maxDiffOrder, double* target ) const;
+
     std::array<size_t, 2> numberOfElements_, polynomialDegrees_, continuities_;
     std::array<double, 2> lengths_, origin_;
 
     IntegrationPointProvider integrationPointProvider_;
     
-    KnotVectors knotVectors_;
+    std::array<KnotVector, 2> knotVectors_;
     LocationMaps locationMaps_;
+
+    // Kernels specialized for the polynomial degrees (if available), selected on construction
+    std::array<BasisTableKernel, 2> basisTableKernels_;
+    ElementKernel elementKernel_;
+
+    // Elements with identical local knot configuration share their basis tables
+    std::array<std::vector<size_t>, 2> elementClasses_, classRepresentatives_;
+
+    // N = C_e * B on each element, with the Bernstein basis B on the local coordinates [-1, 1]
+    std::array<std::vector<linalg::Matrix>, 2> extractionOperators_;
+
+    // Built once per patch (and shared by its copies), but not on construction, such that
+    // patches can be set up without a working integration point provider
+    struct QuadratureCache
+    {
+        std::once_flag evaluated;
+        QuadratureTables tables;
+    };
+
+    std::shared_ptr<QuadratureCache> quadratureCache_;
 };
 
 namespace detail
@@ -75,6 +128,12 @@ LocationMaps constructLocationMaps( std::array<size_t, 2> numberOfElements,
                                     std::array<size_t, 2> polynomialDegrees,
                                     std::array<size_t, 2> continuities );
 
+/*! Group the elements of a knot vector into classes with the same local knot configuration,   *
+ *  i.e. the same knots in the support of the active basis functions relative to the element. *
+ *  The basis functions of all elements in one class coincide up to a translation. On uniform *
+ *  open knot vectors only the elements close to the boundary get their own class.            */
+std::vector<size_t> findElementClasses( const KnotVector& knotVector );
+
 } // namespace detail
 } // namespace splinekernel
 } // namespace cie
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "surface.hpp"
+
+#include <array>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+/*! Least squares fit of a 2D B-Spline patch to scattered data. Minimizes                         *
+ *      sum_k | S(r_k, s_k) - P_k |^2 + smoothingWeight * int S_rr^2 + 2 S_rs^2 + S_ss^2 dr ds    *
+ *  where the second term is the thin plate energy in parameter space, which does not change     *
+ *  linear fields and keeps control points without nearby data well defined. The points are    *
+ *  bucketed by knot span cell (counting sort) and the normal equations are accumulated per      *
+ *  cell like element matrices, then scattered into a CompressedSparseRowMatrix. Rows of cells   *
+ *  that do not share control points are processed by numberOfThreads threads (0: all hardware   *
+ *  threads) at the same time. The normal equations are solved with a BandedCholesky, numbering  *
+ *  the control points along the direction with fewer of them last, and all fields share the   *
+ *  factorization. Throws if the system is singular, e.g. for empty regions without smoothing.  *
+ *  @param polynomialDegrees The degrees in r and s, the number of control points follows       *
+ *  @param points One vector per field (e.g. x, y and z) with one value per data point          *
+ *  @return The control points as for evaluateSurface with the same knot vectors                */
+VectorOfMatrices fitSurface( const std::array<std::vector<double>, 2>& knotVectors,
+                             std::array<size_t, 2> polynomialDegrees,
+                             const std::vector<std::vector<double>>& points,
+                             const std::vector<double>& rCoordinates,
+                             const std::vector<double>& sCoordinates,
+                             double smoothingWeight = 0.0,
+                             size_t numberOfThreads = 0 );
+
+} // namespace splinekernel
+} // namespace cie
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include "stddef.h"
+
+namespace cie
+{
+namespace splinekernel
+{
+
+/*! Knot vector of a B-Spline basis with polynomial degree p. Besides the full sequence of knots  *
+ *  we store the unique knots with their multiplicities. The non-empty knot spans in [t_p, t_n]   *
+ *  are the elements, which can be located with a binary search on the unique knots. For streams *
+ *  of coherent queries (e.g. sorted sample points) the previous element can be passed as a hint, *
+ *  which is checked first and makes the lookup O(1) as long as the queries stay close.           */
+class KnotVector
+{
+public:
+    KnotVector( );
+
+    KnotVector( const std::vector<double>& knots, size_t degree );
+
+    size_t degree( ) const;
+    size_t size( ) const;
+    size_t numberOfBasisFunctions( ) const;
+    size_t numberOfElements( ) const;
+
+    const std::vector<double>& knots( ) const;
+    const std::vector<double>& uniqueKnots( ) const;
+    const std::vector<size_t>& multiplicities( ) const;
+
+    double operator[]( size_t index ) const;
+
+    //! Index of the element containing t. Parameters outside are mapped to the first or last element.
+    size_t findElement( double t ) const;
+
+    //! Same as above, but checks the hinted element and its successor before doing a binary search.
+    size_t findElement( double t, size_t hint ) const;
+
+    //! Index i of the knot span [t_i, t_{i+1}) belonging to the given element
+    size_t spanIndex( size_t elementIndex ) const;
+
+    //! Shorthand for spanIndex( findElement( t ) )
+    size_t findSpan( double t ) const;
+
+    //! Lower and upper parametric bound of the given element
+    double elementBegin( size_t elementIndex ) const;
+    double elementEnd( size_t elementIndex ) const;
+
+private:
+    bool contains( size_t elementIndex, double t ) const;
+
+    size_t degree_;
+
+    std::vector<double> knots_;
+    std::vector<double> uniqueKnots_;
+    std::vector<size_t> multiplicities_;
+
+    // Boundaries of the elements (unique knots in [t_p, t_n]) and the knot span index of each element
+    std::vector<double> elementBoundaries_;
+    std::vector<size_t> elementSpans_;
+};
+
+} // namespace splinekernel
+} // namespace cie
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "curve.hpp"
+
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+//! Closest points on a curve: parameters, distances and feet (one vector per coordinate)
+struct CurveProjection
+{
+    std::vector<double> parameters;
+    std::vector<double> distances;
+    std::vector<std::vector<double>> points;
+};
+
+/*! Projects query points onto a curve (point inversion). The curve is sampled once at          *
+ *  samplesPerSpan points per knot span. For each query the spans are visited in order and a     *
+ *  span is skipped if the bounding box of its p + 1 active control points (which contains the   *
+ *  curve on this span) is further away than the best sample so far. The best sample is then    *
+ *  polished with Newton iterations on f(t) = C'(t) . (C(t) - q), clamped to the parameter range. *
+ *  @param queryPoints One vector per coordinate, like the control points of CurveEvaluator      *
+ *  @param numberOfThreads Number of threads the queries are distributed to (0: all hardware     *
+ *                         threads)                                                              */
+CurveProjection projectOntoCurve( const CurveEvaluator& curve,
+                                  const std::vector<std::vector<double>>& queryPoints,
+                                  size_t numberOfThreads = 0,
+                                  size_t samplesPerSpan = 8,
+                                  size_t maximumNumberOfIterations = 20 );
+
+} // namespace splinekernel
+} // namespace cie
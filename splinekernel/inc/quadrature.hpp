@@ -0,0 +1,14 @@
+#pragma once
+
+#include "alias.hpp"
+
+namespace cie
+{
+namespace splinekernel
+{
+
+//! Gauss-Legendre points and weights on [-1, 1], computed by Newton iterations on the Legendre polynomial
+IntegrationPoints gaussLegendrePoints( size_t numberOfPoints );
+
+} // namespace splinekernel
+} // namespace cie
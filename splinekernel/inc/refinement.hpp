@@ -0,0 +1,119 @@
+#pragma once
+
+#include "linalg.hpp"
+#include "finiteelements.hpp"
+
+#include <array>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+/*! Sparse prolongation operator P in compressed sparse row format that maps the coefficients of  *
+ *  a spline to the coefficients of the same spline on a refined knot vector: fine = P * coarse.  *
+ *  The rows correspond to the refined and the columns to the original basis functions.           */
+class ProlongationOperator
+{
+public:
+    ProlongationOperator( ) = default;
+
+    ProlongationOperator( size_t numberOfColumns,
+                          std::vector<size_t> indptr,
+                          std::vector<size_t> indices,
+                          std::vector<double> data );
+
+    size_t size1( ) const;
+    size_t size2( ) const;
+    size_t nnz( ) const;
+
+    double operator()( size_t i, size_t j ) const;
+
+    std::vector<double> operator*( const std::vector<double>& coarseCoefficients ) const;
+
+    const std::vector<size_t>& indptr( ) const;
+    const std::vector<size_t>& indices( ) const;
+    const std::vector<double>& data( ) const;
+
+private:
+    size_t numberOfColumns_ = 0;
+
+    std::vector<size_t> indptr_ = { 0 }, indices_;
+    std::vector<double> data_;
+};
+
+//! Refined knot vector together with the prolongation from the original one
+struct KnotRefinement
+{
+    std::vector<double> knotVector;
+    ProlongationOperator prolongation;
+};
+
+/*! Insert a single knot t using Boehm's algorithm. Each refined coefficient is a convex *
+ *  combination of at most two original coefficients.                                    */
+KnotRefinement insertKnot( const std::vector<double>& knotVector,
+                           size_t p,
+                           double t );
+
+/*! Insert all knots in newKnots at once (Oslo algorithm). Each row of the prolongation is   *
+ *  computed independently by a triangular Cox-de Boor like recursion in which the k-th      *
+ *  level is evaluated at the k-th knot of the refined knot vector following the row index.  */
+KnotRefinement refineKnotVector( const std::vector<double>& knotVector,
+                                 size_t p,
+                                 std::vector<double> newKnots );
+
+//! Prolongation of a tensor product basis with global index i * nS + j (like in constructLocationMaps)
+ProlongationOperator tensorProduct( const ProlongationOperator& prolongationR,
+                                    const ProlongationOperator& prolongationS );
+
+//! Refine a grid of control points (or coefficients) of a surface: PR * C * PS^T
+linalg::Matrix refineControlGrid( const ProlongationOperator& prolongationR,
+                                  const ProlongationOperator& prolongationS,
+                                  const linalg::Matrix& controlGrid );
+
+/*! Prolongation from the degrees of freedom of a patch to those of a refined patch. The knot *
+ *  vectors of the refined patch must contain the ones of the coarse patch, for example when  *
+ *  the number of elements is multiplied by an integer and the continuities are not raised.   */
+ProlongationOperator patchProlongation( const BSplineFiniteElementPatch& coarsePatch,
+                                        const BSplineFiniteElementPatch& finePatch );
+
+//! Coarsened curve representation together with an upper bound of its distance to the original curve
+struct CurveReduction
+{
+    std::vector<double> knotVector;
+    size_t degree;
+    std::vector<std::vector<double>> controlPoints;
+    double errorBound;
+};
+
+/*! Remove interior knots as long as the accumulated error bound stays below tolerance. Removing *
+ *  one copy of a knot is the inverse of Boehm's algorithm: the p - s new control points are      *
+ *  solved from both sides and the remaining equation gives the distance d of one control point   *
+ *  of the reinserted curve to the original one. Since the basis functions are bounded by one, d   *
+ *  bounds the deviation of the curve and the bounds of consecutive removals are summed up.       *
+ *  @param controlPoints One vector per coordinate, like the control points of CurveEvaluator    */
+CurveReduction removeKnots( const std::vector<double>& knotVector,
+                            size_t p,
+                            const std::vector<std::vector<double>>& controlPoints,
+                            double tolerance );
+
+/*! Reduce the degree of a curve with open knot vector from p to p - 1. The curve is decomposed    *
+ *  into Bezier segments, each of which is reduced separately (the end points are kept, the error  *
+ *  bound is the largest mismatch in the middle of the segment). The result has C0 continuity at  *
+ *  the knots, which can be recovered by removeKnots if the original curve was smoother.           */
+CurveReduction reduceDegree( const std::vector<double>& knotVector,
+                             size_t p,
+                             const std::vector<std::vector<double>>& controlPoints );
+
+/*! Compress a curve within tolerance: optionally reduce the degree as long as the error bound is *
+ *  within tolerance (at least degree one is kept), then remove as many knots as possible with    *
+ *  the remaining tolerance. The reported error bound includes all steps.                          */
+CurveReduction compressCurve( const std::vector<double>& knotVector,
+                              size_t p,
+                              const std::vector<std::vector<double>>& controlPoints,
+                              double tolerance,
+                              bool reduceDegrees = false );
+
+} // namespace splinekernel
+} // namespace cie
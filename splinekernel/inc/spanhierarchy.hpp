@@ -0,0 +1,101 @@
+#pragma once
+
+#include "curvefleet.hpp"
+
+#include <limits>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+//! Knot span of one curve of a fleet that is a leaf of a SpanHierarchy
+struct CurveSpan
+{
+    size_t curveIndex;
+    size_t elementIndex;
+    double lowerParameter;
+    double upperParameter;
+};
+
+/*! Bounding volume hierarchy over the knot spans of all curves in a CurveFleet. Each span is   *
+ *  bounded by the axis aligned box of its Bezier control points, which is tighter than the box  *
+ *  of the p + 1 active B-Spline control points (these are used for knot vectors that are not   *
+ *  open). The tree is built top down by median splits along the longest axis. When control     *
+ *  points of the fleet move, update refits the boxes bottom up without rebuilding the tree.    *
+ *  The hierarchy keeps a reference to the fleet, which must outlive it.                        */
+class SpanHierarchy
+{
+public:
+    explicit SpanHierarchy( const CurveFleet& fleet, size_t maximumLeafSize = 2 );
+
+    //! Recompute the boxes after control points of the fleet changed
+    void update( );
+
+    //! Same as above if only the control points of the given curve changed
+    void update( size_t curveIndex );
+
+    size_t numberOfSpans( ) const;
+    size_t numberOfNodes( ) const;
+
+    const CurveSpan& span( size_t spanIndex ) const;
+
+    //! Bounding box of a span or, if spanIndex is omitted, of all spans
+    std::vector<double> lowerBounds( size_t spanIndex ) const;
+    std::vector<double> upperBounds( size_t spanIndex ) const;
+    std::vector<double> lowerBounds( ) const;
+    std::vector<double> upperBounds( ) const;
+
+    //! Indices of all spans whose box overlaps the given box
+    std::vector<size_t> intersectBox( const std::vector<double>& lower,
+                                      const std::vector<double>& upper ) const;
+
+    /*! Indices of all spans whose box is hit by the ray origin + s * direction with              *
+     *  0 <= s <= maximumDistance, ordered by the ray parameter s at which the box is entered.   */
+    std::vector<size_t> intersectRay( const std::vector<double>& origin,
+                                      const std::vector<double>& direction,
+                                      double maximumDistance = std::numeric_limits<double>::infinity( ) ) const;
+
+    /*! Spans that can contain the curve point closest to the given point, ordered by the distance *
+     *  of their boxes. The search is best first: the end points of the spans lie on the curves    *
+     *  and give an upper bound of the distance, which prunes all boxes that are further away.     *
+     *  The closest point itself can then be found by projecting onto the first few candidates.    */
+    std::vector<size_t> nearestSpans( const std::vector<double>& point ) const;
+
+private:
+    struct Node
+    {
+        size_t begin, end;
+
+        // Index of the second child, the first one follows the node directly. Zero for leaves.
+        size_t right;
+    };
+
+    void computeSpanBounds( size_t spanIndex );
+    void computeEndPoints( size_t beginCurve, size_t endCurve );
+    void refit( );
+
+    size_t build( size_t begin, size_t end, size_t maximumLeafSize );
+
+    double boxDistance( const double* lower, const double* upper, const double* point ) const;
+
+    const CurveFleet& fleet_;
+
+    size_t numberOfDimensions_;
+
+    std::vector<CurveSpan> spans_;
+
+    // First span of each curve, active control point offset and Bezier extraction coefficients per span
+    std::vector<size_t> curveSpanOffsets_, activePointOffsets_, operatorOffsets_;
+    std::vector<double> operators_;
+
+    // Two corners per span and per node, and the curve points at both ends of each span
+    std::vector<double> spanBounds_, nodeBounds_, endPoints_;
+
+    std::vector<Node> nodes_;
+    std::vector<size_t> order_;
+};
+
+} // namespace splinekernel
+} // namespace cie
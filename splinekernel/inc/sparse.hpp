@@ -29,11 +29,34 @@ public:
     void scatter( const linalg::Matrix& elementMatrix, const LocationMap& locationMap );
     
     std::tuple<IndexType*, IndexType*, double*> dataStructure( );
+    std::tuple<const IndexType*, const IndexType*, const double*> dataStructure( ) const;
     
 private:
     std::vector<IndexType> indices_, indptr_;
     std::vector<double> data_;
 };
 
+/* Cholesky factorization L L^T of a symmetric positive definite sparse matrix. L is stored as a  *
+ * dense band of width b = max |i - j| over the non-zero entries, which fits matrices assembled    *
+ * on tensor product grids with lexicographic numbering (b = p_r * n_s + p_s). The factorization   *
+ * takes O(n b^2) and each solve O(n b) operations, so the shorter direction should be numbered    *
+ * last. Throws if the matrix is not (numerically) positive definite.                              */
+class BandedCholesky
+{
+public:
+    explicit BandedCholesky( const CompressedSparseRowMatrix& matrix );
+
+    size_t size( ) const;
+    size_t bandwidth( ) const;
+
+    std::vector<double> solve( const std::vector<double>& rhs ) const;
+
+private:
+    size_t size_, bandwidth_;
+
+    // Row i holds L(i, i - b), ..., L(i, i) at band_[i * (b + 1)], entries with i - b < 0 are zero
+    std::vector<double> band_;
+};
+
 } // namespace splinekernel
 } // namespace cie
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "linalg.hpp"
+#include "knotvector.hpp"
+
+#include <array>
+#include <vector>
 
 namespace cie
 {
@@ -21,11 +25,153 @@ using VectorOfMatrices = std::vector<linalg::Matrix>;
 * @return A vector of matrices, similar to the controlPoints but now with the dimensions specified
 *         by numberOfSamples. In the above example we would return a 50 x 50 matrix of x-values,
 *         a 50 x 50 matrix of y-values, etc.
+* @param numberOfThreads The sample rows are distributed to this many threads (0: all hardware threads).
+*                        The result is bit-for-bit the same for every number of threads.
 */
 
 VectorOfMatrices evaluateSurface( const std::array<std::vector<double>, 2>& knotVectors,
                                   const VectorOfMatrices& controlPoints,
-                                  std::array<size_t, 2> numberOfSamplePoints );
+                                  std::array<size_t, 2> numberOfSamplePoints,
+                                  size_t numberOfThreads = 0 );
+
+/*
+* Kernel of evaluateSurface, instantiated for ScalarType float and double. Each field is stored row by
+* row in a contiguous array: controlPoints[iField] points to numberOfControlPoints[0] x numberOfControl-
+* Points[1] values and the samples are written to results[iField], which must provide space for
+* numberOfSamplePoints[0] x numberOfSamplePoints[1] values.
+*/
+template<typename ScalarType>
+void evaluateSurfaceFields( const std::array<std::vector<double>, 2>& knotVectors,
+                            const std::vector<const ScalarType*>& controlPoints,
+                            std::array<size_t, 2> numberOfControlPoints,
+                            std::array<size_t, 2> numberOfSamplePoints,
+                            const std::vector<ScalarType*>& results,
+                            size_t numberOfThreads = 0 );
+
+/*
+* Evaluates a 2D B-Spline patch at scattered points (r[k], s[k]), e.g. mesh vertices. The points are
+* bucketed by the knot span cell they are in (counting sort), so that consecutive evaluations use the
+* same active control points, and the buckets are distributed to numberOfThreads threads (0: all hard-
+* ware threads). Each point only evaluates its pr + 1 and ps + 1 active basis functions. Coordinates
+* outside of the parameter range are mapped to the first or last knot span. The results do not
+* depend on the number of threads.
+* @return One vector per field with the values at all points in the given order
+*/
+std::vector<std::vector<double>> evaluateSurfaceAt( const std::array<std::vector<double>, 2>& knotVectors,
+                                                    const VectorOfMatrices& controlPoints,
+                                                    const std::vector<double>& rCoordinates,
+                                                    const std::vector<double>& sCoordinates,
+                                                    size_t numberOfThreads = 0 );
+
+/*
+* Kernel of evaluateSurfaceAt with the same storage as in evaluateSurfaceFields, instantiated for
+* ScalarType float and double. results[iField] must provide space for numberOfPoints values.
+*/
+template<typename ScalarType>
+void evaluateSurfaceFieldsAt( const std::array<std::vector<double>, 2>& knotVectors,
+                              const std::vector<const ScalarType*>& controlPoints,
+                              std::array<size_t, 2> numberOfControlPoints,
+                              const ScalarType* rCoordinates,
+                              const ScalarType* sCoordinates,
+                              size_t numberOfPoints,
+                              const std::vector<ScalarType*>& results,
+                              size_t numberOfThreads = 0 );
+
+/*
+* Sample grid of evaluateSurface that is kept up to date while single control points are edited, e.g.
+* dragged in an interactive editor. The spans and active basis values of all sample lines are stored on
+* construction. Control point (i, j) only influences the samples whose knot spans in r and s include it,
+* which is a rectangle of at most (pr + 1) x (ps + 1) knot span cells, so an update only re-evaluates
+* this rectangle with the same operations as evaluateSurface. The cost of an edit does not depend on the
+* size of the surface or on the total number of samples.
+*/
+class SurfaceGridEvaluator
+{
+public:
+    /*
+    * Evaluates the full grid once, with the same arguments as evaluateSurface
+    */
+    SurfaceGridEvaluator( const std::array<std::vector<double>, 2>& knotVectors,
+                          const VectorOfMatrices& controlPoints,
+                          std::array<size_t, 2> numberOfSamplePoints,
+                          size_t numberOfThreads = 0 );
+
+    //! Add delta (one value per field) to control point (i, j) and update the affected samples
+    void moveControlPoint( size_t i, size_t j, const std::vector<double>& delta );
+
+    //! Replace control point (i, j) with the given values (one per field)
+    void setControlPoint( size_t i, size_t j, const std::vector<double>& values );
+
+    //! Sample index ranges [rBegin, rEnd) and [sBegin, sEnd) that depend on control point (i, j)
+    std::array<size_t, 4> affectedSamples( size_t i, size_t j ) const;
+
+    std::array<size_t, 2> numberOfSamplePoints( ) const;
+
+    const VectorOfMatrices& controlPoints( ) const;
+
+    //! The samples with the same layout as the result of evaluateSurface
+    const VectorOfMatrices& samples( ) const;
+
+private:
+    void updateSamples( size_t i, size_t j );
+
+    std::array<KnotVector, 2> knotVectors_;
+
+    VectorOfMatrices controlPoints_, samples_;
+
+    // Knot span and the p + 1 active basis values of each sample line in r and s
+    std::array<std::vector<size_t>, 2> spans_;
+    std::array<std::vector<double>, 2> basis_;
+};
+
+/*
+* Evaluates a 2D NURBS patch. The weighted basis and its sum are computed once per sample point and
+* shared by all components of the control points.
+* @param weights A matrix with the same dimensions as the control point matrices
+* @return The same as for evaluateSurface
+*/
+VectorOfMatrices evaluateRationalSurface( const std::array<std::vector<double>, 2>& knotVectors,
+                                          const VectorOfMatrices& controlPoints,
+                                          const linalg::Matrix& weights,
+                                          std::array<size_t, 2> numberOfSamplePoints );
+
+/*
+* Evaluates the first partial derivatives of a 2D NURBS patch using the quotient rule.
+* @return Two vectors of matrices with the derivatives in r and in s direction of each component
+*/
+std::array<VectorOfMatrices, 2> evaluateRationalSurfaceDerivatives( const std::array<std::vector<double>, 2>& knotVectors,
+                                                                    const VectorOfMatrices& controlPoints,
+                                                                    const linalg::Matrix& weights,
+                                                                    std::array<size_t, 2> numberOfSamplePoints );
+
+/*
+* Differential geometry of a surface in 3D, each entry with one matrix per sample point grid like the
+* result of evaluateSurface. The vector quantities have one matrix for x, y and z.
+*/
+struct SurfaceGeometry
+{
+    VectorOfMatrices position;
+    VectorOfMatrices derivativeR, derivativeS;
+    VectorOfMatrices derivativeRR, derivativeRS, derivativeSS;
+
+    //! Unit normal in the direction of S_r x S_s
+    VectorOfMatrices normal;
+
+    //! Curvatures from the first and second fundamental forms, with the sign of the mean curvature
+    //! relative to the normal (negative if the surface bends away from it)
+    linalg::Matrix gaussianCurvature, meanCurvature;
+};
+
+/*
+* Evaluates positions, first and second derivatives, normals and Gaussian and mean curvature of a 2D
+* B-Spline patch with x, y and z control point components on the same sample grid as evaluateSurface.
+* The active basis functions and their first and second derivatives are evaluated once per sample line
+* and all quantities at a sample point are accumulated in one pass over the active control points.
+* Where S_r x S_s vanishes the normal and the curvatures are not defined and set to NaN.
+*/
+SurfaceGeometry evaluateSurfaceGeometry( const std::array<std::vector<double>, 2>& knotVectors,
+                                         const VectorOfMatrices& controlPoints,
+                                         std::array<size_t, 2> numberOfSamplePoints );
 
 } // namespace splinekernel
 } // namespace cie
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "curve.hpp"
+#include "surface.hpp"
+
+#include <array>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+//! Polyline with the curve parameters of its vertices and one vector per coordinate
+struct Polyline
+{
+    std::vector<double> parameters;
+    std::vector<std::vector<double>> points;
+};
+
+/*! Adaptive tessellation of a curve into a polyline. Every knot span is subdivided recursively *
+ *  at the parametric midpoint until the curve points at the quarter, half and three quarter    *
+ *  parameters of a segment deviate less than chordTolerance from the chord (chord height) and  *
+ *  the turning angle at the midpoint is less than angleTolerance (in radians). Both quarter     *
+ *  points become the midpoints of the two halves, so no evaluation is done twice. A tolerance  *
+ *  smaller or equal to zero disables the corresponding criterion, but at least one is needed.  *
+ *  Segments are not subdivided further than maximumDepth levels below their knot span.        */
+Polyline tessellateCurve( const CurveEvaluator& curve,
+                          double chordTolerance,
+                          double angleTolerance = 0.0,
+                          size_t maximumDepth = 24 );
+
+//! Receives the x, y and z coordinates of the three vertices of a triangle in counterclockwise order
+using TriangleCallback = std::function<void( const std::array<std::array<double, 3>, 3>& vertices )>;
+
+/*! Adaptive triangulation of a B-Spline patch with x, y and z control point components (as for   *
+ *  evaluateSurface). Every knot span cell is subdivided as a quadtree until the surface points at  *
+ *  the midpoints of the edges and at the center of a quad deviate less than chordTolerance from    *
+ *  its bilinear interpolation, plus the twist of the corners that is lost when splitting it into   *
+ *  triangles. Quads without hanging vertices are split into two triangles, the others into a fan   *
+ *  around their center that includes the corners of all finer neighbours on the edges. Every point *
+ *  is evaluated from the same knot spans regardless of the quad it belongs to, so vertices shared   *
+ *  by neighbours have identical coordinates and the mesh is watertight. The cells are processed row *
+ *  by row in r and the triangles of a row are passed to the callback as soon as the next row is     *
+ *  subdivided, so at most two rows of quads are kept in memory. Each vertex is evaluated only once. *
+ *  The orientation of the triangles follows the normal S_r x S_s.                                   */
+void tessellateSurface( const std::array<std::vector<double>, 2>& knotVectors,
+                        const VectorOfMatrices& controlPoints,
+                        double chordTolerance,
+                        const TriangleCallback& callback,
+                        size_t maximumDepth = 8 );
+
+/*! Stream the triangles of tessellateSurface to a binary STL file (single precision, little endian *
+ *  hosts). The number of triangles in the header is written at the end, so the stream must be       *
+ *  seekable. Returns the number of triangles.                                                       */
+size_t writeSurfaceStl( const std::array<std::vector<double>, 2>& knotVectors,
+                        const VectorOfMatrices& controlPoints,
+                        double chordTolerance,
+                        std::ostream& output,
+                        size_t maximumDepth = 8 );
+
+/*! Same as writeSurfaceStl for a binary PLY file with shared vertices. The vertices are written when *
+ *  they first appear in a triangle, the faces must follow them and are therefore kept as indices   *
+ *  (12 bytes per triangle) until the end. Returns the number of triangles.                        */
+size_t writeSurfacePly( const std::array<std::vector<double>, 2>& knotVectors,
+                        const VectorOfMatrices& controlPoints,
+                        double chordTolerance,
+                        std::ostream& output,
+                        size_t maximumDepth = 8 );
+
+} // namespace splinekernel
+} // namespace cie
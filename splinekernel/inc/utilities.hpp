@@ -1,5 +1,8 @@
 #pragma once
 
+#include <functional>
+#include "stddef.h"
+
 namespace cie
 {
 namespace splinekernel
@@ -7,5 +10,16 @@ namespace splinekernel
 
 void runtime_check(bool result, const char message[]);
 
+//! Number of threads used when zero threads are requested (the number of hardware threads)
+size_t defaultNumberOfThreads( );
+
+/*! Calls body( begin, end ) for contiguous chunks of [0, size) on numberOfThreads threads  *
+ *  (or defaultNumberOfThreads( ) if zero). The chunks only depend on size and the number  *
+ *  of threads, such that results do not depend on the scheduling. The first exception     *
+ *  thrown by a chunk is rethrown on the calling thread after all threads have finished.    */
+void parallelFor( size_t size,
+                  size_t numberOfThreads,
+                  const std::function<void( size_t begin, size_t end )>& body );
+
 } // namespace splinekernel
 } // namespace cie
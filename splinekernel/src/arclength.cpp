@@ -0,0 +1,204 @@
+#include "arclength.hpp"
+#include "quadrature.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+ArcLengthTable::ArcLengthTable( const CurveEvaluator& curve,
+                                size_t numberOfSubdivisions,
+                                size_t numberOfGaussPoints ) :
+    curve_( curve ),
+    gaussPoints_( gaussLegendrePoints( numberOfGaussPoints ) )
+{
+    runtime_check( numberOfSubdivisions > 0, "At least one subdivision per knot span is needed." );
+
+    const KnotVector& knotVector = curve.knotVector( );
+
+    size_t numberOfElements = knotVector.numberOfElements( );
+
+    breakpoints_.reserve( numberOfElements * numberOfSubdivisions + 1 );
+    arcLengths_.reserve( numberOfElements * numberOfSubdivisions + 1 );
+
+    breakpoints_.push_back( knotVector.elementBegin( 0 ) );
+    arcLengths_.push_back( 0.0 );
+
+    std::vector<double> derivatives( 2 * curve.numberOfDimensions( ) );
+
+    for( size_t iElement = 0; iElement < numberOfElements; ++iElement )
+    {
+        double begin = knotVector.elementBegin( iElement );
+        double end = knotVector.elementEnd( iElement );
+
+        for( size_t iSubdivision = 1; iSubdivision <= numberOfSubdivisions; ++iSubdivision )
+        {
+            double t = iSubdivision == numberOfSubdivisions ? end :
+                begin + iSubdivision * ( end - begin ) / numberOfSubdivisions;
+
+            arcLengths_.push_back( arcLengths_.back( ) + integrate( breakpoints_.back( ), t, derivatives ) );
+            breakpoints_.push_back( t );
+        }
+    }
+}
+
+double ArcLengthTable::speed( double t, std::vector<double>& derivatives ) const
+{
+    size_t numberOfDimensions = curve_.numberOfDimensions( );
+
+    curve_.evaluateDerivatives( t, 1, derivatives.data( ) );
+
+    double squaredSpeed = 0.0;
+
+    for( size_t d = 0; d < numberOfDimensions; ++d )
+    {
+        squaredSpeed += derivatives[numberOfDimensions + d] * derivatives[numberOfDimensions + d];
+    }
+
+    return std::sqrt( squaredSpeed );
+}
+
+double ArcLengthTable::integrate( double t0, double t1, std::vector<double>& derivatives ) const
+{
+    double center = 0.5 * ( t0 + t1 );
+    double halfLength = 0.5 * ( t1 - t0 );
+
+    double result = 0.0;
+
+    for( size_t i = 0; i < gaussPoints_[0].size( ); ++i )
+    {
+        result += gaussPoints_[1][i] * speed( center + halfLength * gaussPoints_[0][i], derivatives );
+    }
+
+    return halfLength * result;
+}
+
+double ArcLengthTable::length( ) const
+{
+    return arcLengths_.back( );
+}
+
+double ArcLengthTable::arcLength( double t ) const
+{
+    runtime_check( t >= breakpoints_.front( ) && t <= breakpoints_.back( ), "Parameter is outside of the curve." );
+
+    // Last breakpoint that is smaller or equal to t
+    size_t index = std::upper_bound( breakpoints_.begin( ), breakpoints_.end( ), t ) - breakpoints_.begin( ) - 1;
+
+    if( index + 1 == breakpoints_.size( ) )
+    {
+        return length( );
+    }
+
+    std::vector<double> derivatives( 2 * curve_.numberOfDimensions( ) );
+
+    return arcLengths_[index] + integrate( breakpoints_[index], t, derivatives );
+}
+
+double ArcLengthTable::parameter( double s, double tolerance ) const
+{
+    return parameters( { s }, tolerance )[0];
+}
+
+std::vector<double> ArcLengthTable::parameters( const std::vector<double>& arcLengths, double tolerance ) const
+{
+    double totalLength = length( );
+
+    std::vector<double> result( arcLengths.size( ) );
+    std::vector<double> derivatives( 2 * curve_.numberOfDimensions( ) );
+
+    for( size_t i = 0; i < arcLengths.size( ); ++i )
+    {
+        double s = arcLengths[i];
+
+        runtime_check( s >= -tolerance * totalLength && s <= ( 1.0 + tolerance ) * totalLength,
+                       "Arc length is outside of the curve." );
+
+        s = std::min( std::max( s, 0.0 ), totalLength );
+
+        // Interval with arcLengths_[index] <= s < arcLengths_[index + 1]
+        size_t index = std::upper_bound( arcLengths_.begin( ), arcLengths_.end( ), s ) - arcLengths_.begin( );
+
+        index = std::min( std::max( index, size_t { 1 } ), arcLengths_.size( ) - 1 ) - 1;
+
+        double lower = breakpoints_[index];
+        double upper = breakpoints_[index + 1];
+
+        double intervalLength = arcLengths_[index + 1] - arcLengths_[index];
+        double target = s - arcLengths_[index];
+
+        if( intervalLength <= 0.0 )
+        {
+            result[i] = lower;
+
+            continue;
+        }
+
+        // Linear interpolation in the table as initial guess
+        double t = lower + ( upper - lower ) * target / intervalLength;
+
+        for( size_t iteration = 0; iteration < 50; ++iteration )
+        {
+            double residual = integrate( breakpoints_[index], t, derivatives ) - target;
+
+            if( std::abs( residual ) <= tolerance * totalLength )
+            {
+                break;
+            }
+
+            // Keep a bracket for the bisection fallback, the arc length is monotonic in t
+            ( residual < 0.0 ? lower : upper ) = t;
+
+            double ds = speed( t, derivatives );
+            double next = ds > 0.0 ? t - residual / ds : lower;
+
+            t = next > lower && next < upper ? next : 0.5 * ( lower + upper );
+        }
+
+        result[i] = t;
+    }
+
+    return result;
+}
+
+std::vector<double> ArcLengthTable::uniformParameters( size_t numberOfPoints, double tolerance ) const
+{
+    runtime_check( numberOfPoints >= 2, "At least two points are needed." );
+
+    std::vector<double> arcLengths( numberOfPoints );
+
+    for( size_t i = 0; i < numberOfPoints; ++i )
+    {
+        arcLengths[i] = i * length( ) / ( numberOfPoints - 1 );
+    }
+
+    std::vector<double> result = parameters( arcLengths, tolerance );
+
+    // Exact end points
+    result.front( ) = breakpoints_.front( );
+    result.back( ) = breakpoints_.back( );
+
+    return result;
+}
+
+const std::vector<double>& ArcLengthTable::breakpoints( ) const
+{
+    return breakpoints_;
+}
+
+const std::vector<double>& ArcLengthTable::arcLengths( ) const
+{
+    return arcLengths_;
+}
+
+const CurveEvaluator& ArcLengthTable::curve( ) const
+{
+    return curve_;
+}
+
+} // namespace splinekernel
+} // namespace cie
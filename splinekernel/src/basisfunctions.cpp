@@ -1,8 +1,12 @@
 #include "basisfunctions.hpp"
 
+#include "utilities.hpp"
+
 #include <string>
 #include <cmath>
 #include <stdexcept>
+#include <algorithm>
+#include <numeric>
 
 namespace cie
 {
@@ -46,6 +50,46 @@ double evaluateBSplineBasis( double t,
     }
 }
 
+namespace detail
+{
+
+// Derivative of order k from N' = p / (t_{i+p} - t_i) N_{i,p-1} - p / (t_{i+p+1} - t_{i+1}) N_{i+1,p-1}
+double evaluateBSplineDerivativeRecursive( double t,
+                                           size_t functionIndex,
+                                           size_t degree,
+                                           const std::vector<double>& knotVector,
+                                           size_t diffOrder )
+{
+    if (diffOrder == 0)
+    {
+        return evaluateBSplineBasis(t, functionIndex, degree, knotVector);
+    }
+
+    if (diffOrder > degree)
+    {
+        return 0.0;
+    }
+
+    double factor1 = knotVector[functionIndex + degree] - knotVector[functionIndex];
+    double factor2 = knotVector[functionIndex + degree + 1] - knotVector[functionIndex + 1];
+
+    double result = 0.0;
+
+    if (std::abs(factor1) > 1e-10)
+    {
+        result += degree / factor1 * evaluateBSplineDerivativeRecursive(t, functionIndex, degree - 1, knotVector, diffOrder - 1);
+    }
+
+    if (std::abs(factor2) > 1e-10)
+    {
+        result -= degree / factor2 * evaluateBSplineDerivativeRecursive(t, functionIndex + 1, degree - 1, knotVector, diffOrder - 1);
+    }
+
+    return result;
+}
+
+} // namespace detail
+
 double evaluateBSplineDerivative( double t,
                                   size_t functionIndex,
                                   size_t degree,
@@ -56,33 +100,381 @@ double evaluateBSplineDerivative( double t,
     {
         return evaluateBSplineBasis(t, functionIndex, degree, knotVector);
     }
-    else if (diffOrder == 1)
+
+    if (degree == 0)
+    {
+        throw std::runtime_error("Invalid polynomial degree!");
+    }
+
+    if (t < knotVector.front() || t > knotVector.back())
+    {
+        return 0.0;
+    }
+
+    size_t n = knotVector.size() - degree - 1;
+
+    // On knot vectors that are not open, findKnotSpanIndex clamps t outside of [t_p, t_n] to
+    // the first or last span, which belongs to a different polynomial piece. There the knot
+    // interval is searched in the full knot vector and the recursive definition is used.
+    if (t < knotVector[degree] || t > knotVector[n])
+    {
+        size_t interval = static_cast<size_t>(std::upper_bound(knotVector.begin(), knotVector.end(), t) - knotVector.begin()) - 1;
+
+        interval = std::min(interval, knotVector.size() - 2);
+
+        if (functionIndex + degree < interval || functionIndex > interval)
+        {
+            return 0.0;
+        }
+
+        return detail::evaluateBSplineDerivativeRecursive(t, functionIndex, degree, knotVector, diffOrder);
+    }
+
+    size_t span = findKnotSpanIndex(t, degree, knotVector);
+
+    // Function is not supported on this knot span
+    if (functionIndex + degree < span || functionIndex > span)
+    {
+        return 0.0;
+    }
+
+    // Derivatives of order larger than the degree vanish, also at the knots
+    if (diffOrder > degree)
+    {
+        return 0.0;
+    }
+
+    // Stack table for common degrees, as in evaluateActiveBSplineDerivatives
+    constexpr size_t maximumStackDegree = 8;
+
+    double storage[(maximumStackDegree + 1) * (maximumStackDegree + 1)];
+
+    std::vector<double> heap(degree > maximumStackDegree ? (diffOrder + 1) * (degree + 1) : 0);
+
+    double* derivatives = degree > maximumStackDegree ? heap.data() : storage;
+
+    evaluateActiveBSplineDerivatives(t, span, degree, knotVector, diffOrder, derivatives);
+
+    return derivatives[diffOrder * (degree + 1) + functionIndex + degree - span];
+}
+
+size_t findKnotSpanIndex( double t,
+                          size_t p,
+                          const std::vector<double>& knotVector )
+{
+    runtime_check( knotVector.size( ) >= 2 * ( p + 1 ), "Knot vector is too short for given polynomial degree." );
+
+    size_t n = knotVector.size( ) - p - 1; // number of basis functions
+
+    if( t >= knotVector[n] )
+    {
+        return n - 1;
+    }
+
+    if( t <= knotVector[p] )
+    {
+        return p;
+    }
+
+    // Last knot t_i <= t, which always starts a non-empty span
+    auto upper = std::upper_bound( knotVector.begin( ) + p, knotVector.begin( ) + n + 1, t );
+
+    return static_cast<size_t>( upper - knotVector.begin( ) ) - 1;
+}
+
+template<typename ScalarType>
+void evaluateActiveBSplineBasis( ScalarType t,
+                                 size_t knotSpanIndex,
+                                 size_t p,
+                                 const std::vector<double>& knotVector,
+                                 ScalarType* target )
+{
+    evaluateActiveBSplineBasis( t, knotSpanIndex, p, knotVector.data( ), target );
+}
+
+template<typename ScalarType>
+void evaluateActiveBSplineBasis( ScalarType t,
+                                 size_t knotSpanIndex,
+                                 size_t p,
+                                 const double* knotVector,
+                                 ScalarType* target )
+{
+    // Build the triangle of non-zero basis functions degree by degree, starting from
+    // the single constant function on the span. The denominators cannot vanish since
+    // every knot interval involved contains the non-empty knot span.
+    target[0] = 1;
+
+    for( size_t j = 1; j <= p; ++j )
+    {
+        ScalarType saved = 0;
+
+        for( size_t r = 0; r < j; ++r )
+        {
+            ScalarType leftKnot = static_cast<ScalarType>( knotVector[knotSpanIndex + 1 + r - j] );
+            ScalarType rightKnot = static_cast<ScalarType>( knotVector[knotSpanIndex + 1 + r] );
+
+            ScalarType temp = target[r] / ( rightKnot - leftKnot );
+
+            target[r] = saved + ( rightKnot - t ) * temp;
+            saved = ( t - leftKnot ) * temp;
+        }
+
+        target[j] = saved;
+    }
+}
+
+template<typename ScalarType>
+void evaluateActiveBSplineDerivatives( ScalarType t,
+                                       size_t knotSpanIndex,
+                                       size_t p,
+                                       const std::vector<double>& knotVector,
+                                       size_t maxDiffOrder,
+                                       ScalarType* target )
+{
+    // Algorithm A2.3 from Piegl and Tiller, The NURBS Book. The upper triangle of ndu stores 
+    // the basis functions of all degrees up to p, the lower triangle the knot differences.
+    int degree = static_cast<int>( p );
+    int n = static_cast<int>( std::min( maxDiffOrder, p ) );
+
+    // The tables live on the stack for common degrees, so evaluations in tight loops (e.g. the
+    // Newton iterations in projectOntoCurve) do not allocate. Higher degrees fall back to the heap.
+    constexpr size_t maximumStackDegree = 8;
+
+    ScalarType nduStorage[( maximumStackDegree + 1 ) * ( maximumStackDegree + 1 )];
+    ScalarType aStorage[2 * ( maximumStackDegree + 1 )];
+
+    std::vector<ScalarType> nduHeap, aHeap;
+
+    ScalarType* ndu = nduStorage;
+    ScalarType* a = aStorage;
+
+    if( p > maximumStackDegree )
+    {
+        nduHeap.resize( ( p + 1 ) * ( p + 1 ) );
+        aHeap.resize( 2 * ( p + 1 ) );
+
+        ndu = nduHeap.data( );
+        a = aHeap.data( );
+    }
+
+    auto NDU = [&]( int i, int j ) -> ScalarType& { return ndu[i * ( degree + 1 ) + j]; };
+    auto A = [&]( int i, int j ) -> ScalarType& { return a[i * ( degree + 1 ) + j]; };
+
+    NDU( 0, 0 ) = 1;
+
+    for( int j = 1; j <= degree; ++j )
     {
-        if (degree == 0)
+        ScalarType saved = 0;
+
+        for( int r = 0; r < j; ++r )
         {
-            throw std::runtime_error("Invalid polynomial degree!");
+            ScalarType left = t - static_cast<ScalarType>( knotVector[knotSpanIndex + 1 + r - j] );
+            ScalarType right = static_cast<ScalarType>( knotVector[knotSpanIndex + 1 + r] ) - t;
+
+            NDU( j, r ) = right + left;
+
+            ScalarType temp = NDU( r, j - 1 ) / NDU( j, r );
+
+            NDU( r, j ) = saved + right * temp;
+            saved = left * temp;
         }
 
-        double factor1 = knotVector[functionIndex + degree] - knotVector[functionIndex];
-        double factor2 = knotVector[functionIndex + degree + 1] - knotVector[functionIndex + 1];
+        NDU( j, j ) = saved;
+    }
+
+    for( int j = 0; j <= degree; ++j )
+    {
+        target[j] = NDU( j, degree );
+    }
+
+    // Derivatives as linear combinations of the lower degree functions from the table
+    for( int r = 0; r <= degree; ++r )
+    {
+        int s1 = 0, s2 = 1;
 
-        if (std::abs(factor1) > 1e-10)
+        A( 0, 0 ) = 1;
+
+        for( int k = 1; k <= n; ++k )
         {
-            factor1 = degree / factor1 * evaluateBSplineBasis(t, functionIndex, degree - 1, knotVector);
+            ScalarType d = 0;
+            int rk = r - k, pk = degree - k;
+
+            if( r >= k )
+            {
+                A( s2, 0 ) = A( s1, 0 ) / NDU( pk + 1, rk );
+                d = A( s2, 0 ) * NDU( rk, pk );
+            }
+
+            int j1 = rk >= -1 ? 1 : -rk;
+            int j2 = r - 1 <= pk ? k - 1 : degree - r;
+
+            for( int j = j1; j <= j2; ++j )
+            {
+                A( s2, j ) = ( A( s1, j ) - A( s1, j - 1 ) ) / NDU( pk + 1, rk + j );
+                d += A( s2, j ) * NDU( rk + j, pk );
+            }
+
+            if( r <= pk )
+            {
+                A( s2, k ) = -A( s1, k - 1 ) / NDU( pk + 1, r );
+                d += A( s2, k ) * NDU( r, pk );
+            }
+
+            target[k * ( degree + 1 ) + r] = d;
+
+            std::swap( s1, s2 );
         }
+    }
+
+    // Multiply by the factors p! / (p - k)!
+    ScalarType factor = static_cast<ScalarType>( degree );
 
-        if (std::abs(factor2) > 1e-10)
+    for( int k = 1; k <= n; ++k )
+    {
+        for( int j = 0; j <= degree; ++j )
         {
-            factor2 = degree / factor2 * evaluateBSplineBasis(t, functionIndex + 1, degree - 1, knotVector);
+            target[k * ( degree + 1 ) + j] *= factor;
         }
 
-        return factor1 - factor2;
+        factor *= static_cast<ScalarType>( degree - k );
     }
-    else
+
+    for( size_t k = n + 1; k <= maxDiffOrder; ++k )
     {
-        throw std::runtime_error("Invalid diff order.");
+        std::fill( target + k * ( p + 1 ), target + ( k + 1 ) * ( p + 1 ), ScalarType( 0 ) );
     }
 }
 
+template<typename ScalarType>
+void evaluateActiveBSplineBasisBatch( const ScalarType* tCoordinates,
+                                      size_t numberOfPoints,
+                                      const KnotVector& knotVector,
+                                      size_t* spanIndices,
+                                      ScalarType* basisValues )
+{
+    size_t p = knotVector.degree( );
+    size_t numberOfElements = knotVector.numberOfElements( );
+
+    const std::vector<double>& knots = knotVector.knots( );
+
+    // Find elements (with hint for sorted input) and sort the points by element with a counting sort
+    std::vector<size_t> elementIndices( numberOfPoints );
+    std::vector<size_t> elementOffsets( numberOfElements + 1, 0 );
+
+    size_t element = 0;
+
+    for( size_t iPoint = 0; iPoint < numberOfPoints; ++iPoint )
+    {
+        element = knotVector.findElement( tCoordinates[iPoint], element );
+
+        elementIndices[iPoint] = element;
+        spanIndices[iPoint] = knotVector.spanIndex( element );
+        elementOffsets[element + 1] += 1;
+    }
+
+    std::partial_sum( elementOffsets.begin( ), elementOffsets.end( ), elementOffsets.begin( ) );
+
+    std::vector<size_t> permutation( numberOfPoints );
+    std::vector<size_t> position( elementOffsets.begin( ), elementOffsets.end( ) - 1 );
+
+    for( size_t iPoint = 0; iPoint < numberOfPoints; ++iPoint )
+    {
+        permutation[position[elementIndices[iPoint]]++] = iPoint;
+    }
+
+    // Structure of arrays for the current block of points: N[r * W + lane]. The number of lanes
+    // is chosen such that a block occupies the same number of bytes for all scalar types.
+    constexpr size_t W = batchLaneWidth * sizeof( double ) / sizeof( ScalarType );
+
+    std::vector<ScalarType> N( ( p + 1 ) * W );
+
+    ScalarType t[W], saved[W];
+
+    for( size_t iElement = 0; iElement < numberOfElements; ++iElement )
+    {
+        size_t span = knotVector.spanIndex( iElement );
+
+        for( size_t begin = elementOffsets[iElement]; begin < elementOffsets[iElement + 1]; begin += W )
+        {
+            size_t size = std::min( W, elementOffsets[iElement + 1] - begin );
+
+            // Gather parameters and pad the remaining lanes with the last value
+            for( size_t lane = 0; lane < W; ++lane )
+            {
+                t[lane] = tCoordinates[permutation[begin + std::min( lane, size - 1 )]];
+                N[lane] = 1;
+            }
+
+            // Same recurrence as in evaluateActiveBSplineBasis, but all lanes share the knots
+            for( size_t j = 1; j <= p; ++j )
+            {
+                std::fill( saved, saved + W, ScalarType( 0 ) );
+
+                for( size_t r = 0; r < j; ++r )
+                {
+                    ScalarType leftKnot = static_cast<ScalarType>( knots[span + 1 + r - j] );
+                    ScalarType rightKnot = static_cast<ScalarType>( knots[span + 1 + r] );
+                    ScalarType inverse = 1 / ( rightKnot - leftKnot );
+
+                    ScalarType* Nr = N.data( ) + r * W;
+
+                    for( size_t lane = 0; lane < W; ++lane )
+                    {
+                        ScalarType temp = Nr[lane] * inverse;
+
+                        Nr[lane] = saved[lane] + ( rightKnot - t[lane] ) * temp;
+                        saved[lane] = ( t[lane] - leftKnot ) * temp;
+                    }
+                }
+
+                std::copy( saved, saved + W, N.data( ) + j * W );
+            }
+
+            // Scatter back to the original point order
+            for( size_t lane = 0; lane < size; ++lane )
+            {
+                ScalarType* target = basisValues + permutation[begin + lane] * ( p + 1 );
+
+                for( size_t r = 0; r <= p; ++r )
+                {
+                    target[r] = N[r * W + lane];
+                }
+            }
+        }
+    }
+
+    // On knot vectors that are not open, findElement clamps t outside of [t_p, t_n] to the first
+    // or last element, which belongs to a different polynomial piece. The functions of the clamped
+    // span include all that are non-zero there, so they are evaluated from the recursive definition.
+    double lowerBound = knots[p], upperBound = knots[knots.size( ) - p - 1];
+
+    for( size_t iPoint = 0; iPoint < numberOfPoints; ++iPoint )
+    {
+        double t = tCoordinates[iPoint];
+
+        if( t < lowerBound || t > upperBound )
+        {
+            for( size_t r = 0; r <= p; ++r )
+            {
+                basisValues[iPoint * ( p + 1 ) + r] = static_cast<ScalarType>(
+                    evaluateBSplineBasis( t, spanIndices[iPoint] - p + r, p, knots ) );
+            }
+        }
+    }
+}
+
+
+// Explicit instantiations for single and double precision
+template void evaluateActiveBSplineBasis<float>( float, size_t, size_t, const std::vector<double>&, float* );
+template void evaluateActiveBSplineBasis<double>( double, size_t, size_t, const std::vector<double>&, double* );
+template void evaluateActiveBSplineBasis<float>( float, size_t, size_t, const double*, float* );
+template void evaluateActiveBSplineBasis<double>( double, size_t, size_t, const double*, double* );
+
+template void evaluateActiveBSplineDerivatives<float>( float, size_t, size_t, const std::vector<double>&, size_t, float* );
+template void evaluateActiveBSplineDerivatives<double>( double, size_t, size_t, const std::vector<double>&, size_t, double* );
+
+template void evaluateActiveBSplineBasisBatch<float>( const float*, size_t, const KnotVector&, size_t*, float* );
+template void evaluateActiveBSplineBasisBatch<double>( const double*, size_t, const KnotVector&, size_t*, double* );
+
 } // splinekernel
 } // cie
@@ -0,0 +1,97 @@
+#include "bezierextraction.hpp"
+#include "basisfunctions.hpp"
+#include "refinement.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+std::vector<linalg::Matrix> bezierExtractionOperators( const KnotVector& knotVector )
+{
+    size_t p = knotVector.degree( );
+
+    const auto& multiplicities = knotVector.multiplicities( );
+    const auto& uniqueKnots = knotVector.uniqueKnots( );
+
+    runtime_check( multiplicities.front( ) == p + 1 && multiplicities.back( ) == p + 1,
+                   "Bezier extraction requires an open knot vector." );
+
+    // Raise the multiplicity of all interior knots to p
+    std::vector<double> newKnots;
+
+    for( size_t i = 1; i + 1 < uniqueKnots.size( ); ++i )
+    {
+        for( size_t m = multiplicities[i]; m < p; ++m )
+        {
+            newKnots.push_back( uniqueKnots[i] );
+        }
+    }
+
+    KnotRefinement refinement = refineKnotVector( knotVector.knots( ), p, newKnots );
+
+    KnotVector bezierKnots( refinement.knotVector, p );
+
+    size_t numberOfElements = knotVector.numberOfElements( );
+
+    std::vector<linalg::Matrix> operators( numberOfElements, linalg::Matrix( p + 1, p + 1, 0.0 ) );
+
+    // The elements of both knot vectors coincide. Coarse function N_j is the sum of P(i, j) * fine function i.
+    for( size_t iElement = 0; iElement < numberOfElements; ++iElement )
+    {
+        size_t coarseFirst = knotVector.spanIndex( iElement ) - p;
+        size_t fineFirst = bezierKnots.spanIndex( iElement ) - p;
+
+        for( size_t a = 0; a <= p; ++a )
+        {
+            for( size_t b = 0; b <= p; ++b )
+            {
+                operators[iElement]( a, b ) = refinement.prolongation( fineFirst + b, coarseFirst + a );
+            }
+        }
+    }
+
+    return operators;
+}
+
+void evaluateBernsteinBasis( double xi, size_t p, size_t maxDiffOrder, double* target )
+{
+    // The B-Spline basis of the knot vector [-1, ..., -1, 1, ..., 1] is the Bernstein basis
+    std::vector<double> bezierKnots( 2 * ( p + 1 ), 1.0 );
+
+    std::fill( bezierKnots.begin( ), bezierKnots.begin( ) + p + 1, -1.0 );
+
+    evaluateActiveBSplineDerivatives( xi, p, p, bezierKnots, maxDiffOrder, target );
+}
+
+void applyExtractionOperator( const linalg::Matrix& extractionOperator,
+                              const double* bernstein,
+                              size_t numberOfRows,
+                              double* target )
+{
+    size_t size = extractionOperator.size1( );
+
+    for( size_t iRow = 0; iRow < numberOfRows; ++iRow )
+    {
+        const double* B = bernstein + iRow * size;
+        double* N = target + iRow * size;
+
+        for( size_t a = 0; a < size; ++a )
+        {
+            double value = 0.0;
+
+            for( size_t b = 0; b < size; ++b )
+            {
+                value += extractionOperator( a, b ) * B[b];
+            }
+
+            N[a] = value;
+        }
+    }
+}
+
+} // namespace splinekernel
+} // namespace cie
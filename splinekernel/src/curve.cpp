@@ -1,58 +1,474 @@
 #include "basisfunctions.hpp"
 #include "curve.hpp"
+#include "knotvector.hpp"
+#include "utilities.hpp"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
 #include <string>
+#include <utility>
 
 namespace cie
 {
 namespace splinekernel
 {
 
-    std::array<std::vector<double>, 2> evaluate2DCurve( const std::vector<double>& tCoordinates,
-                                                        const std::vector<double>& xCoordinates,
-                                                        const std::vector<double>& yCoordinates,
-                                                        const std::vector<double>& knotVector )
+    template<typename ScalarType>
+    std::array<std::vector<ScalarType>, 2> evaluate2DCurve( const std::vector<ScalarType>& tCoordinates,
+                                                            const std::vector<ScalarType>& xCoordinates,
+                                                            const std::vector<ScalarType>& yCoordinates,
+                                                            const std::vector<double>& knotVector )
     {
         size_t numberOfSamples = tCoordinates.size();   // number of evaluation points/samples
         
         size_t m = knotVector.size();   // number of knots
         size_t n = xCoordinates.size();   // number of control points/vertices
+
+        runtime_check(yCoordinates.size() == n, "Inconsistent number of x and y coordinates.");
+        runtime_check(m > n, "Knot vector is too short for the number of control points.");
+
         size_t p = m - n - 1;   // degree of the B-spline curve (m = n + p + 1)
 
-        std::vector<double> curveX(numberOfSamples, 0.0);
-        std::vector<double> curveY(numberOfSamples, 0.0);
+        std::vector<ScalarType> curveX(numberOfSamples, 0);
+        std::vector<ScalarType> curveY(numberOfSamples, 0);
+
+        // Only p + 1 basis functions are non-zero at each parametric coordinate, so we
+        // evaluate those for all samples at once and multiply with the corresponding control points
+        KnotVector knots(knotVector, p);
 
-        // evaluate all n shape functions and multiply with the corresponding n control points
-        // at each parametric coordinate tCoordinates
-        for (size_t i = 0; i < n; ++i)
+        std::vector<size_t> spans(numberOfSamples);
+        std::vector<ScalarType> N(numberOfSamples * (p + 1));
+
+        evaluateActiveBSplineBasisBatch(tCoordinates.data(), numberOfSamples, knots, spans.data(), N.data());
+
+        for (size_t j = 0; j < numberOfSamples; ++j)
         {
-            for (size_t j = 0; j < numberOfSamples; ++j)
+            for (size_t i = 0; i <= p; ++i)
             {
-                double basis = evaluateBSplineBasis(tCoordinates.at(j), i, p, knotVector);
-                
-                curveX.at(j) += basis * xCoordinates.at(i);
-                curveY.at(j) += basis * yCoordinates.at(i);
+                curveX[j] += N[j * (p + 1) + i] * xCoordinates[spans[j] - p + i];
+                curveY[j] += N[j * (p + 1) + i] * yCoordinates[spans[j] - p + i];
             }
         }
 
-        /* Alternative:
-        for (size_t i = 0; i < numberOfSamples; ++i)
+        // Moved rather than copied, which also avoids a false -Wfree-nonheap-object of GCC 12 at -O3
+        return { std::move(curveX), std::move(curveY) };
+    }
+
+    namespace detail
+    {
+
+    // Computes the rational curve (diffOrder = 0) or its first derivative (diffOrder = 1)
+    template<typename ScalarType>
+    std::array<std::vector<ScalarType>, 2> evaluate2DRationalCurve( const std::vector<ScalarType>& tCoordinates,
+                                                                    const std::vector<ScalarType>& xCoordinates,
+                                                                    const std::vector<ScalarType>& yCoordinates,
+                                                                    const std::vector<ScalarType>& weights,
+                                                                    const std::vector<double>& knotVector,
+                                                                    size_t diffOrder )
+    {
+        size_t numberOfSamples = tCoordinates.size();
+        size_t n = xCoordinates.size();
+
+        runtime_check(yCoordinates.size() == n, "Inconsistent number of x and y coordinates.");
+        runtime_check(weights.size() == n, "Inconsistent number of weights.");
+        runtime_check(knotVector.size() > n, "Knot vector is too short for the number of control points.");
+
+        size_t p = knotVector.size() - n - 1;
+
+        KnotVector knots(knotVector, p);
+
+        std::vector<ScalarType> curveX(numberOfSamples), curveY(numberOfSamples);
+        std::vector<ScalarType> N((diffOrder + 1) * (p + 1));
+
+        size_t element = 0;
+
+        double lowerBound = knotVector[p], upperBound = knotVector[n];
+
+        for (size_t j = 0; j < numberOfSamples; ++j)
         {
-            for (size_t j = 0; j < n; ++j)
+            // All basis functions vanish outside of the knot vector, the curve is (0, 0) there as in evaluate2DCurve
+            if (tCoordinates[j] < knotVector.front() || tCoordinates[j] > knotVector.back())
+            {
+                continue;
+            }
+
+            element = knots.findElement(tCoordinates[j], element);
+
+            size_t span = knots.spanIndex(element);
+
+            // Outside of [t_p, t_n] the span is clamped, so the basis is evaluated in the actual knot interval
+            if (tCoordinates[j] < lowerBound || tCoordinates[j] > upperBound)
+            {
+                for (size_t k = 0; k <= diffOrder; ++k)
+                {
+                    for (size_t i = 0; i <= p; ++i)
+                    {
+                        N[k * (p + 1) + i] = static_cast<ScalarType>(evaluateBSplineDerivative(tCoordinates[j], span - p + i, p, knotVector, k));
+                    }
+                }
+
+                // E.g. at the first knot of a knot vector that is not open
+                if (std::all_of(N.begin(), N.begin() + p + 1, [](ScalarType value) { return value == 0; }))
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                evaluateActiveBSplineDerivatives(tCoordinates[j], span, p, knotVector, diffOrder, N.data());
+            }
+
+            // Weighted sums of the homogeneous coordinates and their derivatives
+            std::array<ScalarType, 2> W = { 0, 0 }, X = { 0, 0 }, Y = { 0, 0 };
+
+            for (size_t k = 0; k <= diffOrder; ++k)
             {
-                double N = evaluateBSplineBasis(tCoordinates[i], j, p, knotVector);
+                for (size_t i = 0; i <= p; ++i)
+                {
+                    size_t index = span - p + i;
+                    ScalarType weightedBasis = N[k * (p + 1) + i] * weights[index];
 
-                curveX[i] += N * xCoordinates[j];
-                curveY[i] += N * yCoordinates[j];
+                    W[k] += weightedBasis;
+                    X[k] += weightedBasis * xCoordinates[index];
+                    Y[k] += weightedBasis * yCoordinates[index];
+                }
+            }
+
+            runtime_check(W[0] != 0, "Rational basis is undefined for zero weight sum.");
+
+            curveX[j] = X[0] / W[0];
+            curveY[j] = Y[0] / W[0];
+
+            if (diffOrder == 1)
+            {
+                curveX[j] = (X[1] - W[1] * curveX[j]) / W[0];
+                curveY[j] = (Y[1] - W[1] * curveY[j]) / W[0];
             }
         }
-        */
 
         return { curveX, curveY };
     }
 
+    } // namespace detail
+
+    template<typename ScalarType>
+    std::array<std::vector<ScalarType>, 2> evaluate2DRationalCurve( const std::vector<ScalarType>& tCoordinates,
+                                                                    const std::vector<ScalarType>& xCoordinates,
+                                                                    const std::vector<ScalarType>& yCoordinates,
+                                                                    const std::vector<ScalarType>& weights,
+                                                                    const std::vector<double>& knotVector )
+    {
+        return detail::evaluate2DRationalCurve( tCoordinates, xCoordinates, yCoordinates, weights, knotVector, 0 );
+    }
+
+    template<typename ScalarType>
+    std::array<std::vector<ScalarType>, 2> evaluate2DRationalCurveDerivative( const std::vector<ScalarType>& tCoordinates,
+                                                                              const std::vector<ScalarType>& xCoordinates,
+                                                                              const std::vector<ScalarType>& yCoordinates,
+                                                                              const std::vector<ScalarType>& weights,
+                                                                              const std::vector<double>& knotVector )
+    {
+        return detail::evaluate2DRationalCurve( tCoordinates, xCoordinates, yCoordinates, weights, knotVector, 1 );
+    }
+
+    CurveEvaluator::CurveEvaluator( const std::vector<double>& knotVector,
+                                    const std::vector<std::vector<double>>& controlPoints ) :
+        numberOfDimensions_( controlPoints.size( ) )
+    {
+        runtime_check( numberOfDimensions_ > 0, "No control point coordinates given." );
+
+        size_t n = controlPoints[0].size( );
+
+        for( const auto& coordinates : controlPoints )
+        {
+            runtime_check( coordinates.size( ) == n, "Inconsistent number of control point coordinates." );
+        }
+
+        runtime_check( knotVector.size( ) > n + 1, "Knot vector is too short for the number of control points." );
+
+        knotVector_ = KnotVector( knotVector, knotVector.size( ) - n - 1 );
+
+        controlPoints_.resize( n * numberOfDimensions_ );
+
+        for( size_t i = 0; i < n; ++i )
+        {
+            for( size_t d = 0; d < numberOfDimensions_; ++d )
+            {
+                controlPoints_[i * numberOfDimensions_ + d] = controlPoints[d][i];
+            }
+        }
+    }
+
+    size_t CurveEvaluator::degree( ) const
+    {
+        return knotVector_.degree( );
+    }
+
+    size_t CurveEvaluator::numberOfDimensions( ) const
+    {
+        return numberOfDimensions_;
+    }
+
+    size_t CurveEvaluator::numberOfControlPoints( ) const
+    {
+        return knotVector_.numberOfBasisFunctions( );
+    }
+
+    const KnotVector& CurveEvaluator::knotVector( ) const
+    {
+        return knotVector_;
+    }
+
+    const std::vector<double>& CurveEvaluator::controlPoints( ) const
+    {
+        return controlPoints_;
+    }
+
+    void CurveEvaluator::evaluate( double t, double* target ) const
+    {
+        evaluateDerivatives( t, 0, target );
+    }
+
+    void CurveEvaluator::evaluateDerivatives( double t, size_t maxDiffOrder, double* target ) const
+    {
+        // Small tables (e.g. cubic curves up to third derivatives) fit on the stack
+        constexpr size_t stackSize = 64;
+
+        size_t size = ( maxDiffOrder + 1 ) * ( knotVector_.degree( ) + 1 );
+
+        if( size <= stackSize )
+        {
+            double N[stackSize];
+
+            evaluateDerivatives( t, maxDiffOrder, target, N );
+        }
+        else
+        {
+            std::vector<double> N( size );
+
+            evaluateDerivatives( t, maxDiffOrder, target, N.data( ) );
+        }
+    }
+
+    void CurveEvaluator::evaluateDerivatives( double t, size_t maxDiffOrder, double* target, double* basisWorkspace ) const
+    {
+        size_t p = knotVector_.degree( );
+        size_t span = knotVector_.findSpan( t );
+
+        evaluateActiveBSplineDerivatives( t, span, p, knotVector_.knots( ), maxDiffOrder, basisWorkspace );
+
+        const double* N = basisWorkspace;
+
+        // The active control points are one contiguous block
+        const double* activePoints = controlPoints_.data( ) + ( span - p ) * numberOfDimensions_;
+
+        for( size_t k = 0; k <= maxDiffOrder; ++k )
+        {
+            double* derivative = target + k * numberOfDimensions_;
+
+            std::fill( derivative, derivative + numberOfDimensions_, 0.0 );
+
+            for( size_t a = 0; a <= p; ++a )
+            {
+                double Na = N[k * ( p + 1 ) + a];
+
+                for( size_t d = 0; d < numberOfDimensions_; ++d )
+                {
+                    derivative[d] += Na * activePoints[a * numberOfDimensions_ + d];
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<double>> CurveEvaluator::evaluate( const std::vector<double>& tCoordinates ) const
+    {
+        size_t numberOfSamples = tCoordinates.size( );
+        size_t p = knotVector_.degree( );
+
+        std::vector<size_t> spans( numberOfSamples );
+        std::vector<double> N( numberOfSamples * ( p + 1 ) );
+
+        evaluateActiveBSplineBasisBatch( tCoordinates.data( ), numberOfSamples, knotVector_, spans.data( ), N.data( ) );
+
+        std::vector<std::vector<double>> result( numberOfDimensions_, std::vector<double>( numberOfSamples, 0.0 ) );
+        std::vector<double> point( numberOfDimensions_ );
+
+        for( size_t j = 0; j < numberOfSamples; ++j )
+        {
+            const double* activePoints = controlPoints_.data( ) + ( spans[j] - p ) * numberOfDimensions_;
+
+            std::fill( point.begin( ), point.end( ), 0.0 );
+
+            for( size_t a = 0; a <= p; ++a )
+            {
+                for( size_t d = 0; d < numberOfDimensions_; ++d )
+                {
+                    point[d] += N[j * ( p + 1 ) + a] * activePoints[a * numberOfDimensions_ + d];
+                }
+            }
+
+            for( size_t d = 0; d < numberOfDimensions_; ++d )
+            {
+                result[d][j] = point[d];
+            }
+        }
+
+        return result;
+    }
+
+    std::vector<std::vector<double>> CurveEvaluator::evaluateDerivatives( double t, size_t maxDiffOrder ) const
+    {
+        std::vector<double> derivatives( ( maxDiffOrder + 1 ) * numberOfDimensions_ );
+
+        evaluateDerivatives( t, maxDiffOrder, derivatives.data( ) );
+
+        std::vector<std::vector<double>> result( maxDiffOrder + 1 );
+
+        for( size_t k = 0; k <= maxDiffOrder; ++k )
+        {
+            result[k].assign( derivatives.begin( ) + k * numberOfDimensions_, derivatives.begin( ) + ( k + 1 ) * numberOfDimensions_ );
+        }
+
+        return result;
+    }
+
+    CurveSweep::CurveSweep( const CurveEvaluator& curve ) :
+        curve_( curve )
+    {
+        size_t p = curve.degree( );
+
+        leftKnots_.resize( p * ( p + 1 ) / 2 );
+        rightKnots_.resize( p * ( p + 1 ) / 2 );
+        inverses_.resize( p * ( p + 1 ) / 2 );
+
+        N_.resize( p + 1 );
+
+        reset( );
+    }
+
+    void CurveSweep::reset( )
+    {
+        previous_ = -std::numeric_limits<double>::infinity( );
+
+        enterSpan( curve_.knotVector( ).spanIndex( 0 ) );
+    }
+
+    size_t CurveSweep::span( ) const
+    {
+        return span_;
+    }
+
+    const CurveEvaluator& CurveSweep::curve( ) const
+    {
+        return curve_;
+    }
+
+    void CurveSweep::enterSpan( size_t span )
+    {
+        const std::vector<double>& knots = curve_.knotVector( ).knots( );
+
+        size_t p = curve_.degree( );
+        size_t index = 0;
+
+        for( size_t j = 1; j <= p; ++j )
+        {
+            for( size_t r = 0; r < j; ++r, ++index )
+            {
+                leftKnots_[index] = knots[span + 1 + r - j];
+                rightKnots_[index] = knots[span + 1 + r];
+                inverses_[index] = 1.0 / ( rightKnots_[index] - leftKnots_[index] );
+            }
+        }
+
+        span_ = span;
+    }
+
+    void CurveSweep::evaluate( const double* tCoordinates, size_t numberOfSamples, double* target )
+    {
+        const std::vector<double>& knots = curve_.knotVector( ).knots( );
+
+        size_t p = curve_.degree( );
+        size_t lastSpan = curve_.knotVector( ).spanIndex( curve_.knotVector( ).numberOfElements( ) - 1 );
+        size_t numberOfDimensions = curve_.numberOfDimensions( );
+
+        const double* controlPoints = curve_.controlPoints( ).data( );
+
+        for( size_t i = 0; i < numberOfSamples; ++i )
+        {
+            double t = tCoordinates[i];
+
+            runtime_check( t >= previous_, "Parameters must be non-decreasing." );
+
+            previous_ = t;
+
+            // Advance to the last span with t_span <= t, empty spans are skipped on the way
+            size_t span = span_;
+
+            while( span < lastSpan && t >= knots[span + 1] )
+            {
+                ++span;
+            }
+
+            if( span != span_ )
+            {
+                enterSpan( span );
+            }
+
+            // Same recurrence as in evaluateActiveBSplineBasis with stored knot differences
+            N_[0] = 1.0;
+
+            for( size_t j = 1, index = 0; j <= p; ++j )
+            {
+                double saved = 0.0;
+
+                for( size_t r = 0; r < j; ++r, ++index )
+                {
+                    double temp = N_[r] * inverses_[index];
+
+                    N_[r] = saved + ( rightKnots_[index] - t ) * temp;
+                    saved = ( t - leftKnots_[index] ) * temp;
+                }
+
+                N_[j] = saved;
+            }
+
+            const double* activePoints = controlPoints + ( span_ - p ) * numberOfDimensions;
+
+            double* point = target + i * numberOfDimensions;
+
+            std::fill( point, point + numberOfDimensions, 0.0 );
+
+            for( size_t a = 0; a <= p; ++a )
+            {
+                for( size_t d = 0; d < numberOfDimensions; ++d )
+                {
+                    point[d] += N_[a] * activePoints[a * numberOfDimensions + d];
+                }
+            }
+        }
+    }
+
+    // Explicit instantiations for single and double precision
+    template std::array<std::vector<float>, 2> evaluate2DCurve( const std::vector<float>&, const std::vector<float>&,
+                                                                const std::vector<float>&, const std::vector<double>& );
+    template std::array<std::vector<double>, 2> evaluate2DCurve( const std::vector<double>&, const std::vector<double>&,
+                                                                 const std::vector<double>&, const std::vector<double>& );
+
+    template std::array<std::vector<float>, 2> evaluate2DRationalCurve( const std::vector<float>&, const std::vector<float>&,
+                                                                        const std::vector<float>&, const std::vector<float>&,
+                                                                        const std::vector<double>& );
+    template std::array<std::vector<double>, 2> evaluate2DRationalCurve( const std::vector<double>&, const std::vector<double>&,
+                                                                         const std::vector<double>&, const std::vector<double>&,
+                                                                         const std::vector<double>& );
+
+    template std::array<std::vector<float>, 2> evaluate2DRationalCurveDerivative( const std::vector<float>&, const std::vector<float>&,
+                                                                                  const std::vector<float>&, const std::vector<float>&,
+                                                                                  const std::vector<double>& );
+    template std::array<std::vector<double>, 2> evaluate2DRationalCurveDerivative( const std::vector<double>&, const std::vector<double>&,
+                                                                                   const std::vector<double>&, const std::vector<double>&,
+                                                                                   const std::vector<double>& );
+
 } // namespace splinekernel
 } // namespace cie
@@ -0,0 +1,266 @@
+#include "curvefleet.hpp"
+#include "basisfunctions.hpp"
+#include "knotvector.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+CurveFleet::CurveFleet( size_t numberOfDimensions ) :
+    numberOfDimensions_( numberOfDimensions ),
+    knotOffsets_( 1, 0 ),
+    controlPointOffsets_( 1, 0 ),
+    maximumDegree_( 0 )
+{
+    runtime_check( numberOfDimensions > 0, "Curves need at least one coordinate." );
+}
+
+CurveFleet::CurveFleet( size_t numberOfDimensions,
+                        std::vector<double> knots,
+                        std::vector<size_t> knotOffsets,
+                        std::vector<double> controlPoints,
+                        std::vector<size_t> controlPointOffsets ) :
+    numberOfDimensions_( numberOfDimensions ),
+    knots_( std::move( knots ) ),
+    knotOffsets_( std::move( knotOffsets ) ),
+    controlPoints_( std::move( controlPoints ) ),
+    controlPointOffsets_( std::move( controlPointOffsets ) ),
+    maximumDegree_( 0 )
+{
+    runtime_check( numberOfDimensions > 0, "Curves need at least one coordinate." );
+    runtime_check( !knotOffsets_.empty( ) && knotOffsets_.size( ) == controlPointOffsets_.size( ),
+                   "Inconsistent number of knot and control point offsets." );
+    runtime_check( knotOffsets_.front( ) == 0 && knotOffsets_.back( ) == knots_.size( ), "Invalid knot offsets." );
+    runtime_check( controlPointOffsets_.front( ) == 0 && controlPointOffsets_.back( ) * numberOfDimensions == controlPoints_.size( ),
+                   "Invalid control point offsets." );
+
+    for( size_t iCurve = 0; iCurve < numberOfCurves( ); ++iCurve )
+    {
+        checkCurve( iCurve );
+
+        maximumDegree_ = std::max( maximumDegree_, degree( iCurve ) );
+    }
+}
+
+void CurveFleet::checkCurve( size_t curveIndex ) const
+{
+    runtime_check( knotOffsets_[curveIndex + 1] >= knotOffsets_[curveIndex] && 
+                   controlPointOffsets_[curveIndex + 1] >= controlPointOffsets_[curveIndex], "Offsets are not sorted." );
+
+    size_t numberOfKnots = knotOffsets_[curveIndex + 1] - knotOffsets_[curveIndex];
+    size_t numberOfControlPoints = controlPointOffsets_[curveIndex + 1] - controlPointOffsets_[curveIndex];
+
+    runtime_check( numberOfKnots > numberOfControlPoints, "Inconsistent number of knots and control points." );
+
+    // Checks the knots and that the curve has at least one non-empty knot span
+    auto begin = knots_.begin( ) + knotOffsets_[curveIndex];
+
+    KnotVector( std::vector<double>( begin, begin + numberOfKnots ), numberOfKnots - numberOfControlPoints - 1 );
+}
+
+size_t CurveFleet::addCurve( const std::vector<double>& knotVector,
+                             const std::vector<std::vector<double>>& controlPoints )
+{
+    runtime_check( controlPoints.size( ) == numberOfDimensions_, "Inconsistent number of control point coordinates." );
+
+    size_t numberOfControlPoints = controlPoints[0].size( );
+
+    for( const auto& coordinates : controlPoints )
+    {
+        runtime_check( coordinates.size( ) == numberOfControlPoints, "Inconsistent number of control points." );
+    }
+
+    runtime_check( knotVector.size( ) > numberOfControlPoints, "Inconsistent number of knots and control points." );
+
+    KnotVector( knotVector, knotVector.size( ) - numberOfControlPoints - 1 );
+
+    knots_.insert( knots_.end( ), knotVector.begin( ), knotVector.end( ) );
+    knotOffsets_.push_back( knots_.size( ) );
+
+    for( size_t i = 0; i < numberOfControlPoints; ++i )
+    {
+        for( size_t d = 0; d < numberOfDimensions_; ++d )
+        {
+            controlPoints_.push_back( controlPoints[d][i] );
+        }
+    }
+
+    controlPointOffsets_.push_back( controlPointOffsets_.back( ) + numberOfControlPoints );
+
+    size_t index = numberOfCurves( ) - 1;
+
+    maximumDegree_ = std::max( maximumDegree_, degree( index ) );
+
+    return index;
+}
+
+void CurveFleet::setControlPoints( size_t curveIndex,
+                                   const std::vector<std::vector<double>>& controlPoints )
+{
+    runtime_check( curveIndex < numberOfCurves( ), "Curve index out of range." );
+    runtime_check( controlPoints.size( ) == numberOfDimensions_, "Inconsistent number of control point coordinates." );
+
+    size_t offset = controlPointOffsets_[curveIndex];
+    size_t numberOfControlPoints = controlPointOffsets_[curveIndex + 1] - offset;
+
+    for( const auto& coordinates : controlPoints )
+    {
+        runtime_check( coordinates.size( ) == numberOfControlPoints, "Inconsistent number of control points." );
+    }
+
+    for( size_t i = 0; i < numberOfControlPoints; ++i )
+    {
+        for( size_t d = 0; d < numberOfDimensions_; ++d )
+        {
+            controlPoints_[( offset + i ) * numberOfDimensions_ + d] = controlPoints[d][i];
+        }
+    }
+}
+
+size_t CurveFleet::numberOfCurves( ) const
+{
+    return knotOffsets_.size( ) - 1;
+}
+
+size_t CurveFleet::numberOfDimensions( ) const
+{
+    return numberOfDimensions_;
+}
+
+size_t CurveFleet::degree( size_t curveIndex ) const
+{
+    runtime_check( curveIndex < numberOfCurves( ), "Curve index out of range." );
+
+    return ( knotOffsets_[curveIndex + 1] - knotOffsets_[curveIndex] ) -
+           ( controlPointOffsets_[curveIndex + 1] - controlPointOffsets_[curveIndex] ) - 1;
+}
+
+double CurveFleet::lowerBound( size_t curveIndex ) const
+{
+    return knots_[knotOffsets_[curveIndex] + degree( curveIndex )];
+}
+
+double CurveFleet::upperBound( size_t curveIndex ) const
+{
+    return knots_[controlPointOffsets_[curveIndex + 1] - controlPointOffsets_[curveIndex] + knotOffsets_[curveIndex]];
+}
+
+const std::vector<double>& CurveFleet::knots( ) const
+{
+    return knots_;
+}
+
+const std::vector<size_t>& CurveFleet::knotOffsets( ) const
+{
+    return knotOffsets_;
+}
+
+const std::vector<double>& CurveFleet::controlPoints( ) const
+{
+    return controlPoints_;
+}
+
+const std::vector<size_t>& CurveFleet::controlPointOffsets( ) const
+{
+    return controlPointOffsets_;
+}
+
+void CurveFleet::evaluate( const double* tCoordinates,
+                           const size_t* sampleOffsets,
+                           double* target,
+                           size_t numberOfThreads ) const
+{
+    runtime_check( sampleOffsets[0] == 0, "Sample offsets must start at zero." );
+
+    for( size_t iCurve = 0; iCurve < numberOfCurves( ); ++iCurve )
+    {
+        runtime_check( sampleOffsets[iCurve + 1] >= sampleOffsets[iCurve], "Sample offsets are not sorted." );
+    }
+
+    parallelFor( numberOfCurves( ), numberOfThreads, [&]( size_t begin, size_t end )
+    {
+        std::vector<double> N( maximumDegree_ + 1 );
+
+        for( size_t iCurve = begin; iCurve < end; ++iCurve )
+        {
+            size_t p = degree( iCurve );
+            size_t n = controlPointOffsets_[iCurve + 1] - controlPointOffsets_[iCurve];
+
+            const double* knots = knots_.data( ) + knotOffsets_[iCurve];
+            const double* points = controlPoints_.data( ) + controlPointOffsets_[iCurve] * numberOfDimensions_;
+
+            // Beyond the last knot the last non-empty span is used, as in findKnotSpanIndex
+            size_t lastSpan = static_cast<size_t>( std::lower_bound( knots + p, knots + n, knots[n] ) - knots ) - 1;
+
+            for( size_t k = sampleOffsets[iCurve]; k < sampleOffsets[iCurve + 1]; ++k )
+            {
+                double t = tCoordinates[k];
+
+                size_t span = t >= knots[n] ? lastSpan : 
+                    static_cast<size_t>( std::upper_bound( knots + p + 1, knots + n, t ) - knots ) - 1;
+
+                evaluateActiveBSplineBasis( t, span, p, knots, N.data( ) );
+
+                const double* activePoints = points + ( span - p ) * numberOfDimensions_;
+
+                double* point = target + k * numberOfDimensions_;
+
+                std::fill( point, point + numberOfDimensions_, 0.0 );
+
+                for( size_t a = 0; a <= p; ++a )
+                {
+                    for( size_t d = 0; d < numberOfDimensions_; ++d )
+                    {
+                        point[d] += N[a] * activePoints[a * numberOfDimensions_ + d];
+                    }
+                }
+            }
+        }
+    } );
+}
+
+std::vector<double> CurveFleet::evaluate( const std::vector<double>& tCoordinates,
+                                          const std::vector<size_t>& sampleOffsets,
+                                          size_t numberOfThreads ) const
+{
+    runtime_check( sampleOffsets.size( ) == numberOfCurves( ) + 1, "Invalid number of sample offsets." );
+    runtime_check( sampleOffsets.back( ) == tCoordinates.size( ), "Inconsistent number of samples." );
+
+    std::vector<double> result( tCoordinates.size( ) * numberOfDimensions_ );
+
+    evaluate( tCoordinates.data( ), sampleOffsets.data( ), result.data( ), numberOfThreads );
+
+    return result;
+}
+
+std::vector<double> CurveFleet::evaluateUniform( size_t numberOfSamples,
+                                                 size_t numberOfThreads ) const
+{
+    runtime_check( numberOfSamples >= 2, "At least two samples per curve are needed." );
+
+    std::vector<double> tCoordinates( numberOfCurves( ) * numberOfSamples );
+    std::vector<size_t> sampleOffsets( numberOfCurves( ) + 1 );
+
+    for( size_t iCurve = 0; iCurve < numberOfCurves( ); ++iCurve )
+    {
+        double t0 = lowerBound( iCurve );
+        double t1 = upperBound( iCurve );
+
+        for( size_t j = 0; j < numberOfSamples; ++j )
+        {
+            tCoordinates[iCurve * numberOfSamples + j] = t0 + j * ( t1 - t0 ) / ( numberOfSamples - 1 );
+        }
+
+        sampleOffsets[iCurve + 1] = ( iCurve + 1 ) * numberOfSamples;
+    }
+
+    return evaluate( tCoordinates, sampleOffsets, numberOfThreads );
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -0,0 +1,137 @@
+#include "elementkernels.hpp"
+#include "basisfunctions.hpp"
+
+#include <utility>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+void evaluateGenericBasisTable( const std::vector<double>& coordinates,
+                                size_t knotSpanIndex,
+                                const KnotVector& knotVector,
+                                BasisFunctionTable& table )
+{
+    size_t p = knotVector.degree( );
+
+    table.degree = p;
+    table.numberOfPoints = coordinates.size( );
+    table.values.resize( coordinates.size( ) * ( p + 1 ) );
+    table.derivatives.resize( coordinates.size( ) * ( p + 1 ) );
+
+    std::vector<double> derivatives( 2 * ( p + 1 ) );
+
+    for( size_t iPoint = 0; iPoint < coordinates.size( ); ++iPoint )
+    {
+        evaluateActiveBSplineDerivatives( coordinates[iPoint], knotSpanIndex, p, 
+                                          knotVector.knots( ), 1, derivatives.data( ) );
+
+        std::copy( derivatives.begin( ), derivatives.begin( ) + p + 1, 
+                   table.values.begin( ) + iPoint * ( p + 1 ) );
+        std::copy( derivatives.begin( ) + p + 1, derivatives.end( ), 
+                   table.derivatives.begin( ) + iPoint * ( p + 1 ) );
+    }
+}
+
+void integrateGenericElement( const BasisFunctionTable& tableX,
+                              const BasisFunctionTable& tableY,
+                              const std::vector<double>& weights,
+                              const std::vector<double>& sourceValues,
+                              linalg::Matrix& Ke,
+                              std::vector<double>& Fe )
+{
+    size_t px = tableX.degree;
+    size_t py = tableY.degree;
+    size_t ny = tableY.numberOfPoints;
+
+    size_t numberOfElementDofs = ( px + 1 ) * ( py + 1 );
+
+    std::vector<double> N( numberOfElementDofs ), dNdx( numberOfElementDofs ), dNdy( numberOfElementDofs );
+
+    for( size_t iPoint = 0; iPoint < tableX.numberOfPoints; ++iPoint )
+    {
+        for( size_t jPoint = 0; jPoint < ny; ++jPoint )
+        {
+            for( size_t i = 0; i <= px; ++i )
+            {
+                for( size_t j = 0; j <= py; ++j )
+                {
+                    double Bx = tableX.values[iPoint * ( px + 1 ) + i];
+                    double By = tableY.values[jPoint * ( py + 1 ) + j];
+
+                    N[i * ( py + 1 ) + j] = Bx * By;
+                    dNdx[i * ( py + 1 ) + j] = tableX.derivatives[iPoint * ( px + 1 ) + i] * By;
+                    dNdy[i * ( py + 1 ) + j] = Bx * tableY.derivatives[jPoint * ( py + 1 ) + j];
+                }
+            }
+
+            double weight = weights[iPoint * ny + jPoint];
+            double f = sourceValues[iPoint * ny + jPoint];
+
+            for( size_t i = 0; i < numberOfElementDofs; ++i )
+            {
+                for( size_t j = 0; j < numberOfElementDofs; ++j )
+                {
+                    Ke( i, j ) += ( dNdx[i] * dNdx[j] + dNdy[i] * dNdy[j] ) * weight;
+                }
+
+                Fe[i] += N[i] * f * weight;
+            }
+        }
+    }
+}
+
+namespace detail
+{
+
+// Build the dispatch tables for degrees 1, ..., maximumFixedDegree at compile time
+template<size_t... P>
+std::array<BasisTableKernel, sizeof...( P )> makeBasisTableKernels( std::index_sequence<P...> )
+{
+    return { { &evaluateFixedDegreeBasisTable<P + 1>... } };
+}
+
+template<size_t PX, size_t... PY>
+std::array<ElementKernel, sizeof...( PY )> makeElementKernelRow( std::index_sequence<PY...> )
+{
+    return { { &integrateFixedDegreeElement<PX, PY + 1>... } };
+}
+
+template<size_t... PX>
+std::array<std::array<ElementKernel, maximumFixedDegree>, sizeof...( PX )> makeElementKernels( std::index_sequence<PX...> )
+{
+    return { { makeElementKernelRow<PX + 1>( std::make_index_sequence<maximumFixedDegree>( ) )... } };
+}
+
+} // namespace detail
+
+BasisTableKernel selectBasisTableKernel( size_t p )
+{
+    static const auto kernels = detail::makeBasisTableKernels( std::make_index_sequence<maximumFixedDegree>( ) );
+
+    if( p >= 1 && p <= maximumFixedDegree )
+    {
+        return kernels[p - 1];
+    }
+
+    return &evaluateGenericBasisTable;
+}
+
+ElementKernel selectElementKernel( std::array<size_t, 2> polynomialDegrees )
+{
+    static const auto kernels = detail::makeElementKernels( std::make_index_sequence<maximumFixedDegree>( ) );
+
+    size_t px = polynomialDegrees[0];
+    size_t py = polynomialDegrees[1];
+
+    if( px >= 1 && px <= maximumFixedDegree && py >= 1 && py <= maximumFixedDegree )
+    {
+        return kernels[px - 1][py - 1];
+    }
+
+    return &integrateGenericElement;
+}
+
+} // namespace splinekernel
+} // namespace cie
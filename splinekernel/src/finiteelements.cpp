@@ -1,10 +1,12 @@
 #include "finiteelements.hpp"
 #include "basisfunctions.hpp"
+#include "bezierextraction.hpp"
 #include "sparse.hpp"
 
 #include <cmath>
 #include <algorithm>
 #include <numeric>
+#include <stdexcept>
 
 namespace cie
 {
@@ -148,6 +150,48 @@ LocationMaps constructLocationMaps( std::array<size_t, 2> numberOfElements,
     return locationMaps;
 }
 
+std::vector<size_t> findElementClasses( const KnotVector& knotVector )
+{
+    size_t p = knotVector.degree( );
+    size_t numberOfElements = knotVector.numberOfElements( );
+
+    std::vector<size_t> elementClasses( numberOfElements );
+    std::vector<std::vector<double>> classWindows;
+
+    std::vector<double> window( 2 * p );
+
+    for( size_t iElement = 0; iElement < numberOfElements; ++iElement )
+    {
+        size_t span = knotVector.spanIndex( iElement );
+        double begin = knotVector.elementBegin( iElement );
+        double tolerance = 1e-10 * ( knotVector.elementEnd( iElement ) - begin );
+
+        // Knots t_{i-p+1}, ..., t_{i+p} relative to the element, which define the active basis
+        // functions on it. Since t_{i+1} is included, the element length is compared as well.
+        for( size_t k = 0; k < 2 * p; ++k )
+        {
+            window[k] = knotVector[span + 1 + k - p] - begin;
+        }
+
+        auto equal = [&]( const std::vector<double>& other )
+        {
+            return std::equal( window.begin( ), window.end( ), other.begin( ), [=]( double a, double b )
+                               { return std::abs( a - b ) <= tolerance; } );
+        };
+
+        auto match = std::find_if( classWindows.begin( ), classWindows.end( ), equal );
+
+        elementClasses[iElement] = static_cast<size_t>( match - classWindows.begin( ) );
+
+        if( match == classWindows.end( ) )
+        {
+            classWindows.push_back( window );
+        }
+    }
+
+    return elementClasses;
+}
+
 } // namespace detail
 
 BSplineFiniteElementPatch::BSplineFiniteElementPatch( std::array<size_t, 2> numberOfElements,
@@ -164,8 +208,34 @@ BSplineFiniteElementPatch::BSplineFiniteElementPatch( std::array<size_t, 2> numb
     origin_( origin ),
     integrationPointProvider_( integrationPointProvider )
 { 
-    knotVectors_ = detail::constructOpenKnotVectors(numberOfElements, polynomialDegrees, continuities, lengths, origin);
+    KnotVectors knotVectors = detail::constructOpenKnotVectors(numberOfElements, polynomialDegrees, continuities, lengths, origin);
+
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        knotVectors_[axis] = KnotVector( knotVectors[axis], polynomialDegrees[axis] );
+        basisTableKernels_[axis] = selectBasisTableKernel( polynomialDegrees[axis] );
+    }
+
+    elementKernel_ = selectElementKernel( polynomialDegrees );
+
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        elementClasses_[axis] = detail::findElementClasses( knotVectors_[axis] );
+        extractionOperators_[axis] = bezierExtractionOperators( knotVectors_[axis] );
+
+        // First element of each class (classes are numbered in the order they first appear)
+        for (size_t iElement = 0; iElement < elementClasses_[axis].size(); ++iElement)
+        {
+            if (elementClasses_[axis][iElement] == classRepresentatives_[axis].size())
+            {
+                classRepresentatives_[axis].push_back( iElement );
+            }
+        }
+    }
+
     locationMaps_ = detail::constructLocationMaps(numberOfElements, polynomialDegrees, continuities);
+
+    quadratureCache_ = std::make_shared<QuadratureCache>( );
 } 
 
 // When we call this function internally we often know the knot span/element indices in which
@@ -174,36 +244,166 @@ BSplineFiniteElementPatch::BSplineFiniteElementPatch( std::array<size_t, 2> numb
 std::vector<double> BSplineFiniteElementPatch::evaluateActiveBasisAt( std::array<double, 2> globalCoordinates,
                                                                       std::array<size_t, 2> diffOrders ) const
 {
-    size_t iElement = detail::findKnotSpan(origin_[0], origin_[0] + lengths_[0], numberOfElements_[0], globalCoordinates[0]);
-    size_t jElement = detail::findKnotSpan(origin_[1], origin_[1] + lengths_[1], numberOfElements_[1], globalCoordinates[1]);
-
-    size_t index0 = iElement * (polynomialDegrees_[0] - continuities_[0]);   // first basis function with support on iElement (See ppt "Knots&KnotSpans&BasisFunctionSupport")
-    size_t index1 = jElement * (polynomialDegrees_[1] - continuities_[1]);   // first basis function with support on jElement
-    
     size_t px = polynomialDegrees_[0];
     size_t py = polynomialDegrees_[1];
 
+    // All derivatives up to the requested order are computed anyway, we keep only the last row
+    std::vector<double> Bx( (diffOrders[0] + 1) * (px + 1) ), By( (diffOrders[1] + 1) * (py + 1) );
+
+    evaluateExtractedBasis( 0, globalCoordinates[0], diffOrders[0], Bx.data( ) );
+    evaluateExtractedBasis( 1, globalCoordinates[1], diffOrders[1], By.data( ) );
+
+    const double* Nx = Bx.data( ) + diffOrders[0] * (px + 1);
+    const double* Ny = By.data( ) + diffOrders[1] * (py + 1);
+
     std::vector<double> activeBasis;
     activeBasis.reserve( (px + 1) * (py + 1) );   // optional, to increase efficiency
-    // std::vector<double> activeBasis( (px + 1) * (py + 1), 0.0 );
 
     for (size_t i = 0; i < px + 1; ++i)
     {
         for (size_t j = 0; j < py + 1; ++j)
         {
-            double Bx = evaluateBSplineDerivative(globalCoordinates[0], index0 + i, px, knotVectors_[0], diffOrders[0]);
-            double By = evaluateBSplineDerivative(globalCoordinates[1], index1 + j, py, knotVectors_[1], diffOrders[1]);
-            activeBasis.push_back( Bx * By );
-            // activeBasis[i * (py + 1) + j] = Bx * By;
+            activeBasis.push_back( Nx[i] * Ny[j] );
         }
     }
 
     return activeBasis;
 }
 
+std::vector<std::vector<double>> BSplineFiniteElementPatch::evaluateActiveBasisDerivativesAt( std::array<double, 2> globalCoordinates,
+                                                                                          size_t maxDiffOrder ) const
+{
+    size_t px = polynomialDegrees_[0];
+    size_t py = polynomialDegrees_[1];
+
+    std::vector<double> Bx( (maxDiffOrder + 1) * (px + 1) ), By( (maxDiffOrder + 1) * (py + 1) );
+
+    evaluateExtractedBasis( 0, globalCoordinates[0], maxDiffOrder, Bx.data( ) );
+    evaluateExtractedBasis( 1, globalCoordinates[1], maxDiffOrder, By.data( ) );
+
+    std::vector<std::vector<double>> derivatives( (maxDiffOrder + 1) * (maxDiffOrder + 1) );
+
+    for (size_t kx = 0; kx <= maxDiffOrder; ++kx)
+    {
+        for (size_t ky = 0; ky <= maxDiffOrder; ++ky)
+        {
+            std::vector<double>& activeBasis = derivatives[kx * (maxDiffOrder + 1) + ky];
+
+            activeBasis.resize( (px + 1) * (py + 1) );
+
+            for (size_t i = 0; i < px + 1; ++i)
+            {
+                for (size_t j = 0; j < py + 1; ++j)
+                {
+                    activeBasis[i * (py + 1) + j] = Bx[kx * (px + 1) + i] * By[ky * (py + 1) + j];
+                }
+            }
+        }
+    }
+
+    return derivatives;
+}
+
+void BSplineFiniteElementPatch::evaluateExtractedBasis( size_t axis, double x, size_t maxDiffOrder, double* target ) const
+{
+    const KnotVector& knotVector = knotVectors_[axis];
+
+    size_t p = polynomialDegrees_[axis];
+    size_t element = knotVector.findElement( x );
+
+    double begin = knotVector.elementBegin( element );
+    double end = knotVector.elementEnd( element );
+
+    std::vector<double> bernstein( (maxDiffOrder + 1) * (p + 1) );
+
+    evaluateBernsteinBasis( 2.0 * (x - begin) / (end - begin) - 1.0, p, maxDiffOrder, bernstein.data( ) );
+
+    // Chain rule for the mapping from [-1, 1] to [begin, end]
+    double factor = 1.0;
+
+    for (size_t k = 1; k <= maxDiffOrder; ++k)
+    {
+        factor *= 2.0 / (end - begin);
+
+        for (size_t a = 0; a <= p; ++a)
+        {
+            bernstein[k * (p + 1) + a] *= factor;
+        }
+    }
+
+    applyExtractionOperator( extractionOperators_[axis][element], bernstein.data( ), maxDiffOrder + 1, target );
+}
+
+BSplineFiniteElementPatch::QuadratureTables BSplineFiniteElementPatch::evaluateQuadratureTables( ) const
+{
+    QuadratureTables tables;
+
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        const KnotVector& knotVector = knotVectors_[axis];
+
+        size_t p = polynomialDegrees_[axis];
+
+        tables.integrationPoints[axis] = integrationPointProvider_( p + 1 );
+
+        // The Bernstein basis is the same for all elements and evaluated only once, directly on the
+        // local coordinates as the B-Spline basis of the knot vector [-1, ..., -1, 1, ..., 1]
+        std::vector<double> bezierKnots( 2 * (p + 1), 1.0 );
+
+        std::fill( bezierKnots.begin( ), bezierKnots.begin( ) + p + 1, -1.0 );
+
+        BasisFunctionTable bernstein;
+
+        basisTableKernels_[axis]( tables.integrationPoints[axis][0], p, KnotVector( bezierKnots, p ), bernstein );
+
+        size_t numberOfPoints = bernstein.numberOfPoints;
+
+        // Map to the B-Spline basis for one element per class
+        for (size_t representative : classRepresentatives_[axis])
+        {
+            const linalg::Matrix& extractionOperator = extractionOperators_[axis][representative];
+
+            double jacobian = 2.0 / (knotVector.elementEnd( representative ) - knotVector.elementBegin( representative ));
+
+            tables.basisTables[axis].emplace_back( );
+
+            BasisFunctionTable& table = tables.basisTables[axis].back( );
+
+            table.degree = p;
+            table.numberOfPoints = numberOfPoints;
+            table.values.resize( numberOfPoints * (p + 1) );
+            table.derivatives.resize( numberOfPoints * (p + 1) );
+
+            applyExtractionOperator( extractionOperator, bernstein.values.data( ), numberOfPoints, table.values.data( ) );
+            applyExtractionOperator( extractionOperator, bernstein.derivatives.data( ), numberOfPoints, table.derivatives.data( ) );
+
+            for (double& derivative : table.derivatives)
+            {
+                derivative *= jacobian;
+            }
+        }
+    }
+
+    return tables;
+}
+
+const BSplineFiniteElementPatch::QuadratureTables& BSplineFiniteElementPatch::quadratureTables( ) const
+{
+    // Basis evaluation is done once per element class instead of once per element. If the
+    // integration point provider throws, the next call tries again.
+    std::call_once( quadratureCache_->evaluated, [this]( )
+    {
+        quadratureCache_->tables = evaluateQuadratureTables( );
+    } );
+
+    return quadratureCache_->tables;
+}
+
 ElementLinearSystem BSplineFiniteElementPatch::integrateElementSystem( std::array<size_t, 2> elementIndices,
                                                                        const SpatialFunction& sourceFunction ) const
 {
+    const QuadratureTables& tables = quadratureTables( );
+
     // Note: we are still on the local element-level, not global system-level!
     // Compute number of element dofs!
     size_t numberOfElementDofs = (polynomialDegrees_[0] + 1) * (polynomialDegrees_[1] + 1);
@@ -211,10 +411,19 @@ ElementLinearSystem BSplineFiniteElementPatch::integrateElementSystem( std::arra
     linalg::Matrix Ke( numberOfElementDofs, numberOfElementDofs, 0.0 );
     std::vector<double> Fe( numberOfElementDofs, 0.0 );
 
-    std::vector<size_t> numberOfIntegrationPoints = { polynomialDegrees_[0] + 1, polynomialDegrees_[1] + 1 };
-    
-    IntegrationPoints integrationPointsX = integrationPointProvider_(numberOfIntegrationPoints[0]);
-    IntegrationPoints integrationPointsY = integrationPointProvider_(numberOfIntegrationPoints[1]);
+    const IntegrationPoints& integrationPointsX = tables.integrationPoints[0];
+    const IntegrationPoints& integrationPointsY = tables.integrationPoints[1];
+
+    std::vector<size_t> numberOfIntegrationPoints = { integrationPointsX[0].size( ), integrationPointsY[0].size( ) };
+
+    double detJ = (1.0 / 4) * (lengths_[0] / numberOfElements_[0]) * (lengths_[1] / numberOfElements_[1]);
+    // or double detJ = ((float)1 / 4) * (lengths_[0] / numberOfElements_[0]) * (lengths_[1] / numberOfElements_[1]);
+    // or double detJ = (lengths_[0] / numberOfElements_[0]) * (lengths_[1] / numberOfElements_[1]) / 4.0;
+    // Do not write (1 / 4) * (lengths_[0] / numberOfElements_[0]) * (lengths_[1] / numberOfElements_[1]);
+    // ---> The first term will be truncated to zero!
+
+    std::vector<double> weights( numberOfIntegrationPoints[0] * numberOfIntegrationPoints[1] );
+    std::vector<double> sourceValues( weights.size( ) );
 
     // Loop over integration points
     for (size_t iPoint = 0; iPoint < numberOfIntegrationPoints[0]; ++iPoint)
@@ -224,40 +433,26 @@ ElementLinearSystem BSplineFiniteElementPatch::integrateElementSystem( std::arra
             std::array<double, 2> localCoordinates = { integrationPointsX[0][iPoint],
                                                        integrationPointsY[0][jPoint] };
 
-            std::array<double, 2> weights = { integrationPointsX[1][iPoint],
-                                              integrationPointsY[1][jPoint] };
-            double weight = weights[0] * weights[1];
-
             std::array<double, 2> globalCoordinates = detail::mapToGlobalCoordinates( localCoordinates,
                                                                                       elementIndices,
                                                                                       lengths_,
                                                                                       origin_,
                                                                                       numberOfElements_ );
 
-            auto N = evaluateActiveBasisAt( globalCoordinates, { 0,0 } );
-            auto dNdx = evaluateActiveBasisAt( globalCoordinates, { 1,0 } );
-            auto dNdy = evaluateActiveBasisAt( globalCoordinates, { 0,1 } );
-
-            double detJ = (1.0 / 4) * (lengths_[0] / numberOfElements_[0]) * (lengths_[1] / numberOfElements_[1]);
-            // or double detJ = ((float)1 / 4) * (lengths_[0] / numberOfElements_[0]) * (lengths_[1] / numberOfElements_[1]);
-            // or double detJ = (lengths_[0] / numberOfElements_[0]) * (lengths_[1] / numberOfElements_[1]) / 4.0;
-            // Do not write (1 / 4) * (lengths_[0] / numberOfElements_[0]) * (lengths_[1] / numberOfElements_[1]);
-            // ---> The first term will be truncated to zero!
-
-            double f = sourceFunction( globalCoordinates[0], globalCoordinates[1] );
+            size_t index = iPoint * numberOfIntegrationPoints[1] + jPoint;
 
-            // Loop over test function and trial function, i.e., Loop over element dofs
-            for (size_t i = 0; i < numberOfElementDofs; ++i)
-            {
-                for (size_t j = 0; j < numberOfElementDofs; ++j)
-                {
-                    Ke(i, j) += (dNdx[i] * dNdx[j] + dNdy[i] * dNdy[j]) * weight * detJ;
-                }
-                Fe[i] += N[i] * f * weight * detJ;
-            }
+            weights[index] = integrationPointsX[1][iPoint] * integrationPointsY[1][jPoint] * detJ;
+            sourceValues[index] = sourceFunction( globalCoordinates[0], globalCoordinates[1] );
         }
     }
 
+    // The basis tables only depend on the element class, the tensor product integration
+    // kernel is specialized for the polynomial degrees and was selected in the constructor.
+    const BasisFunctionTable& tableX = tables.basisTables[0][elementClasses_[0][elementIndices[0]]];
+    const BasisFunctionTable& tableY = tables.basisTables[1][elementClasses_[1][elementIndices[1]]];
+
+    elementKernel_( tableX, tableY, weights, sourceValues, Ke, Fe );
+
     // ElementLinearSystem elementSystem = std::make_pair(Ke, Fe);
     // return elementSystem; 
     return { Ke, Fe };
@@ -296,9 +491,9 @@ std::vector<size_t> BSplineFiniteElementPatch::boundaryDofIds(const std::string&
     std::vector<size_t> boundaryDofIds;
     
     // size_t numberOfDofsX = numberOfElements_[0] * (polynomialDegrees_[0] - continuities_[0]) + (continuities_[0] + 1);
-    size_t numberOfDofsX = knotVectors_[0].size() - polynomialDegrees_[0] - 1;
+    size_t numberOfDofsX = knotVectors_[0].numberOfBasisFunctions();
     // size_t numberOfDofsY = numberOfElements_[1] * (polynomialDegrees_[1] - continuities_[1]) + (continuities_[1] + 1);
-    size_t numberOfDofsY = knotVectors_[1].size() - polynomialDegrees_[1] - 1;
+    size_t numberOfDofsY = knotVectors_[1].numberOfBasisFunctions();
 
     if ( side == "top" )
     {
@@ -337,14 +532,29 @@ std::vector<size_t> BSplineFiniteElementPatch::boundaryDofIds(const std::string&
     return boundaryDofIds;
 }
 
+const std::vector<size_t>& BSplineFiniteElementPatch::elementClasses( size_t axis ) const
+{
+    return elementClasses_[axis];
+}
+
+const KnotVector& BSplineFiniteElementPatch::knotVector( size_t axis ) const
+{
+    return knotVectors_[axis];
+}
+
+const std::vector<linalg::Matrix>& BSplineFiniteElementPatch::extractionOperators( size_t axis ) const
+{
+    return extractionOperators_[axis];
+}
+
 SpatialFunction BSplineFiniteElementPatch::solutionEvaluator(const std::vector<double>& solutionDofs) const
 {
     return [=]( double x, double y ) -> double
     {
         std::vector<double> N = evaluateActiveBasisAt( { x, y }, { 0, 0 } );
 
-        size_t elementIdxI = detail::findKnotSpan(origin_[0], origin_[0] + lengths_[0], numberOfElements_[0], x);
-        size_t elementIdxJ = detail::findKnotSpan(origin_[1], origin_[1] + lengths_[1], numberOfElements_[1], y);
+        size_t elementIdxI = knotVectors_[0].findElement( x );
+        size_t elementIdxJ = knotVectors_[1].findElement( y );
         
         const LocationMap& locationMap = locationMaps_[elementIdxI * numberOfElements_[1] + elementIdxJ];
         
@@ -0,0 +1,244 @@
+#include "fitting.hpp"
+#include "basisfunctions.hpp"
+#include "knotvector.hpp"
+#include "quadrature.hpp"
+#include "sparse.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+VectorOfMatrices fitSurface( const std::array<std::vector<double>, 2>& knotVectors,
+                             std::array<size_t, 2> polynomialDegrees,
+                             const std::vector<std::vector<double>>& points,
+                             const std::vector<double>& rCoordinates,
+                             const std::vector<double>& sCoordinates,
+                             double smoothingWeight,
+                             size_t numberOfThreads )
+{
+    runtime_check( !points.empty( ), "No data points given." );
+    runtime_check( rCoordinates.size( ) == sCoordinates.size( ), "Inconsistent number of r and s coordinates." );
+    runtime_check( smoothingWeight >= 0.0, "Smoothing weight must not be negative." );
+
+    size_t numberOfPoints = rCoordinates.size( );
+    size_t numberOfFields = points.size( );
+
+    for( const auto& field : points )
+    {
+        runtime_check( field.size( ) == numberOfPoints, "Inconsistent number of data points." );
+    }
+
+    std::array<KnotVector, 2> knots { KnotVector( knotVectors[0], polynomialDegrees[0] ),
+                                      KnotVector( knotVectors[1], polynomialDegrees[1] ) };
+
+    size_t pr = polynomialDegrees[0], ps = polynomialDegrees[1];
+    size_t nR = knots[0].numberOfBasisFunctions( ), nS = knots[1].numberOfBasisFunctions( );
+
+    size_t numberOfElementsR = knots[0].numberOfElements( );
+    size_t numberOfElementsS = knots[1].numberOfElements( );
+    size_t numberOfCells = numberOfElementsR * numberOfElementsS;
+
+    size_t numberOfLocalDofs = ( pr + 1 ) * ( ps + 1 );
+
+    // Lexicographic numbering with the shorter direction last has the smaller bandwidth
+    bool rowMajor = pr * nS + ps <= ps * nR + pr;
+
+    auto dofIndex = [&]( size_t i, size_t j )
+    {
+        return rowMajor ? i * nS + j : j * nR + i;
+    };
+
+    LocationMaps locationMaps( numberOfCells );
+
+    for( size_t iElement = 0; iElement < numberOfElementsR; ++iElement )
+    {
+        for( size_t jElement = 0; jElement < numberOfElementsS; ++jElement )
+        {
+            auto& locationMap = locationMaps[iElement * numberOfElementsS + jElement];
+
+            size_t firstR = knots[0].spanIndex( iElement ) - pr;
+            size_t firstS = knots[1].spanIndex( jElement ) - ps;
+
+            for( size_t a = 0; a <= pr; ++a )
+            {
+                for( size_t b = 0; b <= ps; ++b )
+                {
+                    locationMap.push_back( dofIndex( firstR + a, firstS + b ) );
+                }
+            }
+        }
+    }
+
+    CompressedSparseRowMatrix matrix( locationMaps );
+
+    std::vector<std::vector<double>> rhs( numberOfFields, std::vector<double>( nR * nS, 0.0 ) );
+
+    // Counting sort of the points by knot span cell, as in evaluateSurfaceFieldsAt
+    std::vector<size_t> cells( numberOfPoints ), cellOffsets( numberOfCells + 1, 0 ), order( numberOfPoints );
+
+    for( size_t iPoint = 0; iPoint < numberOfPoints; ++iPoint )
+    {
+        cells[iPoint] = knots[0].findElement( rCoordinates[iPoint] ) * numberOfElementsS + knots[1].findElement( sCoordinates[iPoint] );
+        cellOffsets[cells[iPoint] + 1] += 1;
+    }
+
+    std::partial_sum( cellOffsets.begin( ), cellOffsets.end( ), cellOffsets.begin( ) );
+
+    std::vector<size_t> fill( cellOffsets.begin( ), cellOffsets.end( ) - 1 );
+
+    for( size_t iPoint = 0; iPoint < numberOfPoints; ++iPoint )
+    {
+        order[fill[cells[iPoint]]++] = iPoint;
+    }
+
+    IntegrationPoints gaussR = gaussLegendrePoints( pr + 1 );
+    IntegrationPoints gaussS = gaussLegendrePoints( ps + 1 );
+
+    // Normal equations and thin plate energy of one cell, then scattered to the global system
+    auto assembleCell = [&]( size_t iElement, size_t jElement, std::vector<double>& N, linalg::Matrix& cellMatrix )
+    {
+        size_t cell = iElement * numberOfElementsS + jElement;
+        size_t spanR = knots[0].spanIndex( iElement ), spanS = knots[1].spanIndex( jElement );
+
+        std::vector<double> local( numberOfLocalDofs * numberOfLocalDofs, 0.0 );
+        std::vector<double> localRhs( numberOfFields * numberOfLocalDofs, 0.0 );
+
+        std::vector<double> Nr( 3 * ( pr + 1 ) ), Ns( 3 * ( ps + 1 ) );
+
+        for( size_t k = cellOffsets[cell]; k < cellOffsets[cell + 1]; ++k )
+        {
+            size_t iPoint = order[k];
+
+            evaluateActiveBSplineBasis( rCoordinates[iPoint], spanR, pr, knots[0].knots( ), Nr.data( ) );
+            evaluateActiveBSplineBasis( sCoordinates[iPoint], spanS, ps, knots[1].knots( ), Ns.data( ) );
+
+            for( size_t a = 0; a <= pr; ++a )
+            {
+                for( size_t b = 0; b <= ps; ++b )
+                {
+                    N[a * ( ps + 1 ) + b] = Nr[a] * Ns[b];
+                }
+            }
+
+            // Upper triangle only, the matrix is symmetric
+            for( size_t I = 0; I < numberOfLocalDofs; ++I )
+            {
+                for( size_t J = I; J < numberOfLocalDofs; ++J )
+                {
+                    local[I * numberOfLocalDofs + J] += N[I] * N[J];
+                }
+
+                for( size_t iField = 0; iField < numberOfFields; ++iField )
+                {
+                    localRhs[iField * numberOfLocalDofs + I] += N[I] * points[iField][iPoint];
+                }
+            }
+        }
+
+        if( smoothingWeight > 0.0 )
+        {
+            double r0 = knots[0].elementBegin( iElement ), r1 = knots[0].elementEnd( iElement );
+            double s0 = knots[1].elementBegin( jElement ), s1 = knots[1].elementEnd( jElement );
+
+            std::vector<double> Nrr( numberOfLocalDofs ), Nrs( numberOfLocalDofs ), Nss( numberOfLocalDofs );
+
+            for( size_t iGauss = 0; iGauss <= pr; ++iGauss )
+            {
+                double r = r0 + ( gaussR[0][iGauss] + 1.0 ) / 2.0 * ( r1 - r0 );
+
+                evaluateActiveBSplineDerivatives( r, spanR, pr, knots[0].knots( ), 2, Nr.data( ) );
+
+                for( size_t jGauss = 0; jGauss <= ps; ++jGauss )
+                {
+                    double s = s0 + ( gaussS[0][jGauss] + 1.0 ) / 2.0 * ( s1 - s0 );
+
+                    evaluateActiveBSplineDerivatives( s, spanS, ps, knots[1].knots( ), 2, Ns.data( ) );
+
+                    double weight = smoothingWeight * gaussR[1][iGauss] * gaussS[1][jGauss] * ( r1 - r0 ) * ( s1 - s0 ) / 4.0;
+
+                    for( size_t a = 0; a <= pr; ++a )
+                    {
+                        for( size_t b = 0; b <= ps; ++b )
+                        {
+                            Nrr[a * ( ps + 1 ) + b] = Nr[2 * ( pr + 1 ) + a] * Ns[b];
+                            Nrs[a * ( ps + 1 ) + b] = Nr[( pr + 1 ) + a] * Ns[( ps + 1 ) + b];
+                            Nss[a * ( ps + 1 ) + b] = Nr[a] * Ns[2 * ( ps + 1 ) + b];
+                        }
+                    }
+
+                    for( size_t I = 0; I < numberOfLocalDofs; ++I )
+                    {
+                        for( size_t J = I; J < numberOfLocalDofs; ++J )
+                        {
+                            local[I * numberOfLocalDofs + J] += weight * ( Nrr[I] * Nrr[J] + 2.0 * Nrs[I] * Nrs[J] + Nss[I] * Nss[J] );
+                        }
+                    }
+                }
+            }
+        }
+
+        for( size_t I = 0; I < numberOfLocalDofs; ++I )
+        {
+            for( size_t J = I; J < numberOfLocalDofs; ++J )
+            {
+                cellMatrix( I, J ) = local[I * numberOfLocalDofs + J];
+                cellMatrix( J, I ) = local[I * numberOfLocalDofs + J];
+            }
+
+            for( size_t iField = 0; iField < numberOfFields; ++iField )
+            {
+                rhs[iField][locationMaps[cell][I]] += localRhs[iField * numberOfLocalDofs + I];
+            }
+        }
+
+        matrix.scatter( cellMatrix, locationMaps[cell] );
+    };
+
+    // Cell rows that are at least pr + 1 rows apart have no control point in common, so each
+    // group of them is assembled in parallel without two threads writing to the same entry
+    for( size_t iColor = 0; iColor <= pr; ++iColor )
+    {
+        size_t numberOfRows = iColor < numberOfElementsR ? ( numberOfElementsR - iColor + pr ) / ( pr + 1 ) : 0;
+
+        parallelFor( numberOfRows, numberOfThreads, [&]( size_t begin, size_t end )
+        {
+            std::vector<double> N( numberOfLocalDofs );
+            linalg::Matrix cellMatrix( numberOfLocalDofs, numberOfLocalDofs, 0.0 );
+
+            for( size_t iRow = begin; iRow < end; ++iRow )
+            {
+                for( size_t jElement = 0; jElement < numberOfElementsS; ++jElement )
+                {
+                    assembleCell( iColor + iRow * ( pr + 1 ), jElement, N, cellMatrix );
+                }
+            }
+        } );
+    }
+
+    BandedCholesky factorization( matrix );
+
+    VectorOfMatrices controlPoints( numberOfFields, linalg::Matrix( nR, nS, 0.0 ) );
+
+    for( size_t iField = 0; iField < numberOfFields; ++iField )
+    {
+        std::vector<double> solution = factorization.solve( rhs[iField] );
+
+        for( size_t i = 0; i < nR; ++i )
+        {
+            for( size_t j = 0; j < nS; ++j )
+            {
+                controlPoints[iField]( i, j ) = solution[dofIndex( i, j )];
+            }
+        }
+    }
+
+    return controlPoints;
+}
+
+} // namespace splinekernel
+} // namespace cie
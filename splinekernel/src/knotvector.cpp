@@ -0,0 +1,156 @@
+#include "knotvector.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+KnotVector::KnotVector( ) :
+    degree_( 0 )
+{ }
+
+KnotVector::KnotVector( const std::vector<double>& knots, size_t degree ) :
+    degree_( degree ),
+    knots_( knots )
+{
+    runtime_check( knots.size( ) >= 2 * ( degree + 1 ), "Knot vector is too short for given polynomial degree." );
+    runtime_check( std::is_sorted( knots.begin( ), knots.end( ) ), "Knot vector is not sorted." );
+
+    // Compress the knots into unique values and multiplicities
+    for( size_t i = 0; i < knots.size( ); ++i )
+    {
+        if( i == 0 || knots[i] != knots[i - 1] )
+        {
+            uniqueKnots_.push_back( knots[i] );
+            multiplicities_.push_back( 0 );
+        }
+
+        multiplicities_.back( ) += 1;
+    }
+
+    // Elements are the non-empty knot spans within [t_p, t_n]
+    size_t n = numberOfBasisFunctions( );
+
+    for( size_t i = degree; i < n; ++i )
+    {
+        if( knots[i] < knots[i + 1] )
+        {
+            elementBoundaries_.push_back( knots[i] );
+            elementSpans_.push_back( i );
+        }
+    }
+
+    runtime_check( !elementSpans_.empty( ), "Knot vector has no non-empty knot span." );
+
+    elementBoundaries_.push_back( knots[n] );
+}
+
+size_t KnotVector::degree( ) const
+{
+    return degree_;
+}
+
+size_t KnotVector::size( ) const
+{
+    return knots_.size( );
+}
+
+size_t KnotVector::numberOfBasisFunctions( ) const
+{
+    return knots_.size( ) - degree_ - 1;
+}
+
+size_t KnotVector::numberOfElements( ) const
+{
+    return elementSpans_.size( );
+}
+
+const std::vector<double>& KnotVector::knots( ) const
+{
+    return knots_;
+}
+
+const std::vector<double>& KnotVector::uniqueKnots( ) const
+{
+    return uniqueKnots_;
+}
+
+const std::vector<size_t>& KnotVector::multiplicities( ) const
+{
+    return multiplicities_;
+}
+
+double KnotVector::operator[]( size_t index ) const
+{
+    return knots_[index];
+}
+
+bool KnotVector::contains( size_t elementIndex, double t ) const
+{
+    return elementBoundaries_[elementIndex] <= t && ( t < elementBoundaries_[elementIndex + 1] ||
+        ( elementIndex + 1 == elementSpans_.size( ) && t <= elementBoundaries_[elementIndex + 1] ) );
+}
+
+size_t KnotVector::findElement( double t ) const
+{
+    size_t numberOfElements = elementSpans_.size( );
+
+    if( t >= elementBoundaries_[numberOfElements] )
+    {
+        return numberOfElements - 1;
+    }
+
+    if( t <= elementBoundaries_[0] )
+    {
+        return 0;
+    }
+
+    // Last boundary that is smaller or equal than t
+    auto upper = std::upper_bound( elementBoundaries_.begin( ), elementBoundaries_.end( ), t );
+
+    return static_cast<size_t>( upper - elementBoundaries_.begin( ) ) - 1;
+}
+
+size_t KnotVector::findElement( double t, size_t hint ) const
+{
+    if( hint < elementSpans_.size( ) )
+    {
+        if( contains( hint, t ) )
+        {
+            return hint;
+        }
+
+        if( hint + 1 < elementSpans_.size( ) && contains( hint + 1, t ) )
+        {
+            return hint + 1;
+        }
+    }
+
+    return findElement( t );
+}
+
+size_t KnotVector::spanIndex( size_t elementIndex ) const
+{
+    return elementSpans_[elementIndex];
+}
+
+size_t KnotVector::findSpan( double t ) const
+{
+    return elementSpans_[findElement( t )];
+}
+
+double KnotVector::elementBegin( size_t elementIndex ) const
+{
+    return elementBoundaries_[elementIndex];
+}
+
+double KnotVector::elementEnd( size_t elementIndex ) const
+{
+    return elementBoundaries_[elementIndex + 1];
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -0,0 +1,204 @@
+#include "projection.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+CurveProjection projectOntoCurve( const CurveEvaluator& curve,
+                                  const std::vector<std::vector<double>>& queryPoints,
+                                  size_t numberOfThreads,
+                                  size_t samplesPerSpan,
+                                  size_t maximumNumberOfIterations )
+{
+    size_t numberOfDimensions = curve.numberOfDimensions( );
+
+    runtime_check( queryPoints.size( ) == numberOfDimensions, "Inconsistent number of query point coordinates." );
+    runtime_check( samplesPerSpan >= 2, "At least two samples per span are needed." );
+
+    size_t numberOfQueries = queryPoints[0].size( );
+
+    for( const auto& coordinates : queryPoints )
+    {
+        runtime_check( coordinates.size( ) == numberOfQueries, "Inconsistent number of query points." );
+    }
+
+    const KnotVector& knotVector = curve.knotVector( );
+
+    size_t p = curve.degree( );
+    size_t numberOfElements = knotVector.numberOfElements( );
+
+    // Samples including both ends of each span and bounding boxes of the active control points
+    std::vector<double> sampleParameters( numberOfElements * samplesPerSpan );
+    std::vector<double> lowerBounds( numberOfElements * numberOfDimensions, std::numeric_limits<double>::max( ) );
+    std::vector<double> upperBounds( numberOfElements * numberOfDimensions, std::numeric_limits<double>::lowest( ) );
+
+    for( size_t iElement = 0; iElement < numberOfElements; ++iElement )
+    {
+        double begin = knotVector.elementBegin( iElement );
+        double end = knotVector.elementEnd( iElement );
+
+        for( size_t iSample = 0; iSample < samplesPerSpan; ++iSample )
+        {
+            sampleParameters[iElement * samplesPerSpan + iSample] = begin + iSample * ( end - begin ) / ( samplesPerSpan - 1 );
+        }
+
+        const double* activePoints = curve.controlPoints( ).data( ) + ( knotVector.spanIndex( iElement ) - p ) * numberOfDimensions;
+
+        for( size_t a = 0; a <= p; ++a )
+        {
+            for( size_t d = 0; d < numberOfDimensions; ++d )
+            {
+                double value = activePoints[a * numberOfDimensions + d];
+
+                lowerBounds[iElement * numberOfDimensions + d] = std::min( lowerBounds[iElement * numberOfDimensions + d], value );
+                upperBounds[iElement * numberOfDimensions + d] = std::max( upperBounds[iElement * numberOfDimensions + d], value );
+            }
+        }
+    }
+
+    std::vector<std::vector<double>> samples = curve.evaluate( sampleParameters );
+
+    double tMin = knotVector.elementBegin( 0 );
+    double tMax = knotVector.elementEnd( numberOfElements - 1 );
+    double tolerance = 1e-14 * ( tMax - tMin );
+
+    CurveProjection projection;
+
+    projection.parameters.resize( numberOfQueries );
+    projection.distances.resize( numberOfQueries );
+    projection.points.resize( numberOfDimensions, std::vector<double>( numberOfQueries ) );
+
+    parallelFor( numberOfQueries, numberOfThreads, [&]( size_t begin, size_t end )
+    {
+        // Allocated once per chunk, the Newton iterations below do not allocate
+        std::vector<double> q( numberOfDimensions ), derivatives( 3 * numberOfDimensions );
+        std::vector<double> basisWorkspace( 3 * ( curve.degree( ) + 1 ) );
+
+        for( size_t iQuery = begin; iQuery < end; ++iQuery )
+        {
+            for( size_t d = 0; d < numberOfDimensions; ++d )
+            {
+                q[d] = queryPoints[d][iQuery];
+            }
+
+            auto squaredDistanceToSample = [&]( size_t iSample )
+            {
+                double distance = 0.0;
+
+                for( size_t d = 0; d < numberOfDimensions; ++d )
+                {
+                    distance += ( samples[d][iSample] - q[d] ) * ( samples[d][iSample] - q[d] );
+                }
+
+                return distance;
+            };
+
+            // Coarse bracketing over the samples of spans that may contain a closer point
+            double best = std::numeric_limits<double>::max( );
+            size_t bestSample = 0;
+
+            for( size_t iElement = 0; iElement < numberOfElements; ++iElement )
+            {
+                double boxDistance = 0.0;
+
+                for( size_t d = 0; d < numberOfDimensions; ++d )
+                {
+                    double outside = std::max( { lowerBounds[iElement * numberOfDimensions + d] - q[d],
+                                                 q[d] - upperBounds[iElement * numberOfDimensions + d], 0.0 } );
+
+                    boxDistance += outside * outside;
+                }
+
+                if( boxDistance >= best )
+                {
+                    continue;
+                }
+
+                for( size_t iSample = iElement * samplesPerSpan; iSample < ( iElement + 1 ) * samplesPerSpan; ++iSample )
+                {
+                    double distance = squaredDistanceToSample( iSample );
+
+                    if( distance < best )
+                    {
+                        best = distance;
+                        bestSample = iSample;
+                    }
+                }
+            }
+
+            // Newton iterations for C'(t) . (C(t) - q) = 0
+            double t = sampleParameters[bestSample];
+
+            for( size_t iteration = 0; iteration < maximumNumberOfIterations; ++iteration )
+            {
+                curve.evaluateDerivatives( t, 2, derivatives.data( ), basisWorkspace.data( ) );
+
+                double f = 0.0, df = 0.0;
+
+                for( size_t d = 0; d < numberOfDimensions; ++d )
+                {
+                    double difference = derivatives[d] - q[d];
+
+                    f += derivatives[numberOfDimensions + d] * difference;
+                    df += derivatives[2 * numberOfDimensions + d] * difference + 
+                          derivatives[numberOfDimensions + d] * derivatives[numberOfDimensions + d];
+                }
+
+                if( df <= 0.0 )
+                {
+                    break;
+                }
+
+                double tNew = std::min( std::max( t - f / df, tMin ), tMax );
+                double step = std::abs( tNew - t );
+
+                t = tNew;
+
+                if( step <= tolerance )
+                {
+                    break;
+                }
+            }
+
+            // Accept the Newton result only if it improved the sample
+            curve.evaluate( t, derivatives.data( ) );
+
+            double distance = 0.0;
+
+            for( size_t d = 0; d < numberOfDimensions; ++d )
+            {
+                distance += ( derivatives[d] - q[d] ) * ( derivatives[d] - q[d] );
+            }
+
+            if( distance > best )
+            {
+                t = sampleParameters[bestSample];
+                distance = best;
+
+                for( size_t d = 0; d < numberOfDimensions; ++d )
+                {
+                    derivatives[d] = samples[d][bestSample];
+                }
+            }
+
+            projection.parameters[iQuery] = t;
+            projection.distances[iQuery] = std::sqrt( distance );
+
+            for( size_t d = 0; d < numberOfDimensions; ++d )
+            {
+                projection.points[d][iQuery] = derivatives[d];
+            }
+        }
+    } );
+
+    return projection;
+}
+
+} // namespace splinekernel
+} // namespace cie
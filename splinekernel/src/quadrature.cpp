@@ -0,0 +1,73 @@
+#include "quadrature.hpp"
+#include "utilities.hpp"
+
+#include <cmath>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+IntegrationPoints gaussLegendrePoints( size_t numberOfPoints )
+{
+    runtime_check( numberOfPoints > 0, "At least one integration point is needed." );
+
+    const double pi = std::acos( -1.0 );
+
+    IntegrationPoints points;
+
+    points[0].resize( numberOfPoints );
+    points[1].resize( numberOfPoints );
+
+    // Roots are symmetric, so only compute the ones in [0, 1] and mirror them
+    for( size_t i = 0; i < ( numberOfPoints + 1 ) / 2; ++i )
+    {
+        double x = std::cos( pi * ( i + 0.75 ) / ( numberOfPoints + 0.5 ) );
+        double derivative = 0.0;
+
+        for( size_t iteration = 0; iteration < 100; ++iteration )
+        {
+            // Three term recurrence for P_n( x ) and P_{n-1}( x )
+            double P0 = 1.0, P1 = x;
+
+            for( size_t k = 2; k <= numberOfPoints; ++k )
+            {
+                double P2 = ( ( 2.0 * k - 1.0 ) * x * P1 - ( k - 1.0 ) * P0 ) / k;
+
+                P0 = P1;
+                P1 = P2;
+            }
+
+            double Pn = numberOfPoints == 1 ? x : P1;
+            double Pnm1 = numberOfPoints == 1 ? 1.0 : P0;
+
+            derivative = numberOfPoints * ( x * Pn - Pnm1 ) / ( x * x - 1.0 );
+
+            double dx = Pn / derivative;
+
+            x -= dx;
+
+            if( std::abs( dx ) <= 1e-15 )
+            {
+                break;
+            }
+        }
+
+        double weight = 2.0 / ( ( 1.0 - x * x ) * derivative * derivative );
+
+        points[0][i] = -x;
+        points[0][numberOfPoints - 1 - i] = x;
+        points[1][i] = weight;
+        points[1][numberOfPoints - 1 - i] = weight;
+    }
+
+    if( numberOfPoints % 2 == 1 )
+    {
+        points[0][numberOfPoints / 2] = 0.0;
+    }
+
+    return points;
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -0,0 +1,685 @@
+#include "refinement.hpp"
+#include "basisfunctions.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+ProlongationOperator::ProlongationOperator( size_t numberOfColumns,
+                                            std::vector<size_t> indptr,
+                                            std::vector<size_t> indices,
+                                            std::vector<double> data ) :
+    numberOfColumns_( numberOfColumns ),
+    indptr_( std::move( indptr ) ),
+    indices_( std::move( indices ) ),
+    data_( std::move( data ) )
+{
+    runtime_check( !indptr_.empty( ) && indptr_.back( ) == indices_.size( ), "Inconsistent row pointers." );
+    runtime_check( indices_.size( ) == data_.size( ), "Inconsistent number of indices and values." );
+}
+
+size_t ProlongationOperator::size1( ) const
+{
+    return indptr_.size( ) - 1;
+}
+
+size_t ProlongationOperator::size2( ) const
+{
+    return numberOfColumns_;
+}
+
+size_t ProlongationOperator::nnz( ) const
+{
+    return data_.size( );
+}
+
+double ProlongationOperator::operator()( size_t i, size_t j ) const
+{
+    runtime_check( i < size1( ) && j < size2( ), "Index out of range." );
+
+    auto begin = indices_.begin( ) + indptr_[i];
+    auto end = indices_.begin( ) + indptr_[i + 1];
+
+    auto result = std::lower_bound( begin, end, j );
+
+    return ( result != end && *result == j ) ? data_[result - indices_.begin( )] : 0.0;
+}
+
+std::vector<double> ProlongationOperator::operator*( const std::vector<double>& coarseCoefficients ) const
+{
+    runtime_check( coarseCoefficients.size( ) == size2( ), "Invalid number of coefficients." );
+
+    std::vector<double> result( size1( ), 0.0 );
+
+    for( size_t i = 0; i < size1( ); ++i )
+    {
+        for( size_t k = indptr_[i]; k < indptr_[i + 1]; ++k )
+        {
+            result[i] += data_[k] * coarseCoefficients[indices_[k]];
+        }
+    }
+
+    return result;
+}
+
+const std::vector<size_t>& ProlongationOperator::indptr( ) const
+{
+    return indptr_;
+}
+
+const std::vector<size_t>& ProlongationOperator::indices( ) const
+{
+    return indices_;
+}
+
+const std::vector<double>& ProlongationOperator::data( ) const
+{
+    return data_;
+}
+
+KnotRefinement insertKnot( const std::vector<double>& knotVector,
+                           size_t p,
+                           double t )
+{
+    size_t n = knotVector.size( ) - p - 1;
+
+    runtime_check( knotVector.size( ) >= 2 * ( p + 1 ), "Knot vector is too short for given polynomial degree." );
+    runtime_check( t > knotVector[p] && t < knotVector[n], "Knot to insert is outside of the parameter range." );
+
+    size_t k = findKnotSpanIndex( t, p, knotVector );
+    size_t multiplicity = static_cast<size_t>( std::count( knotVector.begin( ), knotVector.end( ), t ) );
+
+    runtime_check( multiplicity <= p, "Knot multiplicity would exceed p + 1." );
+
+    KnotRefinement refinement;
+
+    refinement.knotVector = knotVector;
+    refinement.knotVector.insert( refinement.knotVector.begin( ) + k + 1, t );
+
+    std::vector<size_t> indptr( 1, 0 ), indices;
+    std::vector<double> data;
+
+    auto push = [&]( size_t j, double value )
+    {
+        if( value != 0.0 )
+        {
+            indices.push_back( j );
+            data.push_back( value );
+        }
+    };
+
+    // Q_i = P_i for i <= k - p, Q_i = alpha_i P_i + (1 - alpha_i) P_{i - 1} for k - p < i <= k
+    // and Q_i = P_{i - 1} for i > k, where alpha_i = (t - t_i) / (t_{i + p} - t_i)
+    for( size_t i = 0; i <= n; ++i )
+    {
+        if( i + p <= k )
+        {
+            push( i, 1.0 );
+        }
+        else if( i <= k )
+        {
+            double alpha = ( t - knotVector[i] ) / ( knotVector[i + p] - knotVector[i] );
+
+            push( i - 1, 1.0 - alpha );
+            push( i, alpha );
+        }
+        else
+        {
+            push( i - 1, 1.0 );
+        }
+
+        indptr.push_back( indices.size( ) );
+    }
+
+    refinement.prolongation = ProlongationOperator( n, std::move( indptr ), std::move( indices ), std::move( data ) );
+
+    return refinement;
+}
+
+KnotRefinement refineKnotVector( const std::vector<double>& knotVector,
+                                 size_t p,
+                                 std::vector<double> newKnots )
+{
+    size_t n = knotVector.size( ) - p - 1;
+
+    runtime_check( knotVector.size( ) >= 2 * ( p + 1 ), "Knot vector is too short for given polynomial degree." );
+
+    std::sort( newKnots.begin( ), newKnots.end( ) );
+
+    for( double t : newKnots )
+    {
+        runtime_check( t > knotVector[p] && t < knotVector[n], "Knot to insert is outside of the parameter range." );
+    }
+
+    KnotRefinement refinement;
+
+    auto& fine = refinement.knotVector;
+
+    fine.resize( knotVector.size( ) + newKnots.size( ) );
+
+    std::merge( knotVector.begin( ), knotVector.end( ), newKnots.begin( ), newKnots.end( ), fine.begin( ) );
+
+    for( size_t i = 0; i + p + 1 < fine.size( ); ++i )
+    {
+        runtime_check( fine[i] < fine[i + p + 1], "Knot multiplicity would exceed p + 1." );
+    }
+
+    size_t numberOfFineFunctions = fine.size( ) - p - 1;
+
+    std::vector<size_t> indptr( 1, 0 ), indices;
+    std::vector<double> data;
+
+    std::vector<double> alpha( p + 1 );
+
+    for( size_t i = 0; i < numberOfFineFunctions; ++i )
+    {
+        size_t mu = findKnotSpanIndex( fine[i], p, knotVector );
+
+        // Same triangular scheme as evaluateActiveBSplineBasis, but the level k is evaluated at fine[i + k]
+        alpha[0] = 1.0;
+
+        for( size_t k = 1; k <= p; ++k )
+        {
+            double x = fine[i + k];
+            double saved = 0.0;
+
+            for( size_t r = 0; r < k; ++r )
+            {
+                double upper = knotVector[mu + r + 1];
+                double lower = knotVector[mu + r + 1 - k];
+
+                double temp = alpha[r] / ( upper - lower );
+
+                alpha[r] = saved + ( upper - x ) * temp;
+                saved = ( x - lower ) * temp;
+            }
+
+            alpha[k] = saved;
+        }
+
+        for( size_t a = 0; a <= p; ++a )
+        {
+            if( alpha[a] != 0.0 )
+            {
+                indices.push_back( mu - p + a );
+                data.push_back( alpha[a] );
+            }
+        }
+
+        indptr.push_back( indices.size( ) );
+    }
+
+    refinement.prolongation = ProlongationOperator( n, std::move( indptr ), std::move( indices ), std::move( data ) );
+
+    return refinement;
+}
+
+ProlongationOperator tensorProduct( const ProlongationOperator& prolongationR,
+                                    const ProlongationOperator& prolongationS )
+{
+    const auto& indptrR = prolongationR.indptr( );
+    const auto& indptrS = prolongationS.indptr( );
+
+    size_t numberOfColumnsS = prolongationS.size2( );
+
+    std::vector<size_t> indptr( 1, 0 ), indices;
+    std::vector<double> data;
+
+    indices.reserve( prolongationR.nnz( ) * prolongationS.nnz( ) );
+    data.reserve( prolongationR.nnz( ) * prolongationS.nnz( ) );
+
+    // Iterating the rows of both factors in order keeps the column indices of each row sorted
+    for( size_t i = 0; i < prolongationR.size1( ); ++i )
+    {
+        for( size_t j = 0; j < prolongationS.size1( ); ++j )
+        {
+            for( size_t kR = indptrR[i]; kR < indptrR[i + 1]; ++kR )
+            {
+                for( size_t kS = indptrS[j]; kS < indptrS[j + 1]; ++kS )
+                {
+                    indices.push_back( prolongationR.indices( )[kR] * numberOfColumnsS + prolongationS.indices( )[kS] );
+                    data.push_back( prolongationR.data( )[kR] * prolongationS.data( )[kS] );
+                }
+            }
+
+            indptr.push_back( indices.size( ) );
+        }
+    }
+
+    return ProlongationOperator( prolongationR.size2( ) * numberOfColumnsS, std::move( indptr ),
+                                 std::move( indices ), std::move( data ) );
+}
+
+linalg::Matrix refineControlGrid( const ProlongationOperator& prolongationR,
+                                  const ProlongationOperator& prolongationS,
+                                  const linalg::Matrix& controlGrid )
+{
+    runtime_check( controlGrid.size1( ) == prolongationR.size2( ) && controlGrid.size2( ) == prolongationS.size2( ),
+                   "Inconsistent control grid size." );
+
+    size_t numberOfCoarseS = controlGrid.size2( );
+
+    linalg::Matrix refinedR( prolongationR.size1( ), numberOfCoarseS, 0.0 );
+    linalg::Matrix refined( prolongationR.size1( ), prolongationS.size1( ), 0.0 );
+
+    // First PR * C, then (PR * C) * PS^T
+    for( size_t i = 0; i < prolongationR.size1( ); ++i )
+    {
+        for( size_t k = prolongationR.indptr( )[i]; k < prolongationR.indptr( )[i + 1]; ++k )
+        {
+            size_t a = prolongationR.indices( )[k];
+
+            for( size_t b = 0; b < numberOfCoarseS; ++b )
+            {
+                refinedR( i, b ) += prolongationR.data( )[k] * controlGrid( a, b );
+            }
+        }
+    }
+
+    for( size_t i = 0; i < refined.size1( ); ++i )
+    {
+        for( size_t j = 0; j < refined.size2( ); ++j )
+        {
+            double value = 0.0;
+
+            for( size_t k = prolongationS.indptr( )[j]; k < prolongationS.indptr( )[j + 1]; ++k )
+            {
+                value += prolongationS.data( )[k] * refinedR( i, prolongationS.indices( )[k] );
+            }
+
+            refined( i, j ) = value;
+        }
+    }
+
+    return refined;
+}
+
+ProlongationOperator patchProlongation( const BSplineFiniteElementPatch& coarsePatch,
+                                        const BSplineFiniteElementPatch& finePatch )
+{
+    std::array<ProlongationOperator, 2> prolongations;
+
+    for( size_t axis = 0; axis < 2; ++axis )
+    {
+        const KnotVector& coarse = coarsePatch.knotVector( axis );
+        const KnotVector& fine = finePatch.knotVector( axis );
+
+        runtime_check( coarse.degree( ) == fine.degree( ), "Inconsistent polynomial degrees." );
+
+        double tolerance = 1e-10 * ( coarse[coarse.size( ) - 1] - coarse[0] );
+
+        // Knots of the fine patch that are not in the coarse patch (up to round-off)
+        std::vector<double> newKnots;
+
+        size_t iCoarse = 0;
+
+        for( size_t iFine = 0; iFine < fine.size( ); ++iFine )
+        {
+            if( iCoarse < coarse.size( ) && std::abs( coarse[iCoarse] - fine[iFine] ) <= tolerance )
+            {
+                ++iCoarse;
+            }
+            else
+            {
+                runtime_check( iCoarse == coarse.size( ) || fine[iFine] < coarse[iCoarse],
+                               "Fine patch is not a refinement of the coarse patch." );
+
+                newKnots.push_back( fine[iFine] );
+            }
+        }
+
+        runtime_check( iCoarse == coarse.size( ), "Fine patch is not a refinement of the coarse patch." );
+
+        prolongations[axis] = refineKnotVector( coarse.knots( ), coarse.degree( ), newKnots ).prolongation;
+    }
+
+    return tensorProduct( prolongations[0], prolongations[1] );
+}
+
+namespace detail
+{
+
+double distance( const std::vector<double>& point1, const std::vector<double>& point2 )
+{
+    double squaredDistance = 0.0;
+
+    for( size_t d = 0; d < point1.size( ); ++d )
+    {
+        squaredDistance += ( point1[d] - point2[d] ) * ( point1[d] - point2[d] );
+    }
+
+    return std::sqrt( squaredDistance );
+}
+
+// Try to remove one copy of the knot with last index r. The points are stored as points[i][d] here.
+bool tryRemoveKnot( std::vector<double>& knots,
+                    size_t p,
+                    std::vector<std::vector<double>>& points,
+                    size_t r,
+                    double tolerance,
+                    double& error )
+{
+    double u = knots[r];
+
+    size_t s = 1;
+
+    while( knots[r - s] == u )
+    {
+        ++s;
+    }
+
+    if( s > p )
+    {
+        return false;
+    }
+
+    // Knots without the removed copy and coefficient of Boehm's algorithm for reinserting it
+    auto knot = [&]( size_t i ) { return i < r ? knots[i] : knots[i + 1]; };
+    auto alpha = [&]( size_t i ) { return ( u - knot( i ) ) / ( knot( i + p ) - knot( i ) ); };
+
+    size_t first = r - p;
+    size_t last = r - s;
+
+    size_t h = ( p - s + 1 ) / 2;
+    size_t g = p - s - h;
+
+    // Q[i - first + 1] holds the new control point i, with known values at both ends
+    std::vector<std::vector<double>> Q( last - first + 2 );
+
+    Q.front( ) = points[first - 1];
+    Q.back( ) = points[last + 1];
+
+    size_t numberOfDimensions = points[0].size( );
+
+    for( size_t i = first; i < first + h; ++i )
+    {
+        Q[i - first + 1].resize( numberOfDimensions );
+
+        for( size_t d = 0; d < numberOfDimensions; ++d )
+        {
+            Q[i - first + 1][d] = ( points[i][d] - ( 1.0 - alpha( i ) ) * Q[i - first][d] ) / alpha( i );
+        }
+    }
+
+    for( size_t i = last; i + g > last; --i )
+    {
+        Q[i - first].resize( numberOfDimensions );
+
+        for( size_t d = 0; d < numberOfDimensions; ++d )
+        {
+            Q[i - first][d] = ( points[i][d] - alpha( i ) * Q[i - first + 1][d] ) / ( 1.0 - alpha( i ) );
+        }
+    }
+
+    // The remaining equation is only satisfied up to the error of control point m of the reinserted curve
+    size_t m = first + h;
+
+    std::vector<double> reinserted( numberOfDimensions );
+
+    for( size_t d = 0; d < numberOfDimensions; ++d )
+    {
+        reinserted[d] = alpha( m ) * Q[m - first + 1][d] + ( 1.0 - alpha( m ) ) * Q[m - first][d];
+    }
+
+    error = distance( reinserted, points[m] );
+
+    if( error > tolerance )
+    {
+        return false;
+    }
+
+    knots.erase( knots.begin( ) + r );
+
+    std::copy( Q.begin( ) + 1, Q.end( ) - 1, points.begin( ) + first );
+
+    points.erase( points.begin( ) + last );
+
+    return true;
+}
+
+std::vector<std::vector<double>> transpose( const std::vector<std::vector<double>>& points )
+{
+    std::vector<std::vector<double>> result( points[0].size( ), std::vector<double>( points.size( ) ) );
+
+    for( size_t i = 0; i < points.size( ); ++i )
+    {
+        for( size_t j = 0; j < points[i].size( ); ++j )
+        {
+            result[j][i] = points[i][j];
+        }
+    }
+
+    return result;
+}
+
+void checkCurve( const std::vector<double>& knotVector,
+                 size_t p,
+                 const std::vector<std::vector<double>>& controlPoints )
+{
+    runtime_check( knotVector.size( ) >= 2 * ( p + 1 ), "Knot vector is too short for given polynomial degree." );
+    runtime_check( !controlPoints.empty( ), "No control point coordinates given." );
+
+    for( const auto& coordinates : controlPoints )
+    {
+        runtime_check( coordinates.size( ) == knotVector.size( ) - p - 1, "Inconsistent number of control points." );
+    }
+}
+
+} // namespace detail
+
+CurveReduction removeKnots( const std::vector<double>& knotVector,
+                            size_t p,
+                            const std::vector<std::vector<double>>& controlPoints,
+                            double tolerance )
+{
+    detail::checkCurve( knotVector, p, controlPoints );
+
+    CurveReduction reduction { knotVector, p, { }, 0.0 };
+
+    auto& knots = reduction.knotVector;
+    auto points = detail::transpose( controlPoints );
+
+    double lower = knots[p];
+    double upper = knots[knots.size( ) - p - 1];
+
+    // Remove as many copies of each interior knot as possible, repeat until nothing changes
+    for( bool removed = true; removed; )
+    {
+        removed = false;
+
+        std::vector<double> interiorKnots;
+
+        std::unique_copy( knots.begin( ) + p + 1, knots.end( ) - p - 1, std::back_inserter( interiorKnots ) );
+
+        for( double u : interiorKnots )
+        {
+            if( u <= lower || u >= upper )
+            {
+                continue;
+            }
+
+            double error = 0.0;
+
+            while( std::count( knots.begin( ), knots.end( ), u ) > 0 )
+            {
+                size_t r = std::upper_bound( knots.begin( ), knots.end( ), u ) - knots.begin( ) - 1;
+
+                if( !detail::tryRemoveKnot( knots, p, points, r, tolerance - reduction.errorBound, error ) )
+                {
+                    break;
+                }
+
+                reduction.errorBound += error;
+                removed = true;
+            }
+        }
+    }
+
+    reduction.controlPoints = detail::transpose( points );
+
+    return reduction;
+}
+
+CurveReduction reduceDegree( const std::vector<double>& knotVector,
+                             size_t p,
+                             const std::vector<std::vector<double>>& controlPoints )
+{
+    detail::checkCurve( knotVector, p, controlPoints );
+
+    runtime_check( p >= 2, "Degree reduction needs polynomial degree of at least two." );
+
+    size_t n = knotVector.size( ) - p - 1;
+
+    for( size_t i = 1; i <= p; ++i )
+    {
+        runtime_check( knotVector[i] == knotVector[0] && knotVector[n + i - 1] == knotVector[n + p],
+                       "Degree reduction needs an open knot vector." );
+    }
+
+    // Bezier decomposition: raise all interior multiplicities to p
+    std::vector<double> breakpoints, newKnots;
+
+    std::unique_copy( knotVector.begin( ), knotVector.end( ), std::back_inserter( breakpoints ) );
+
+    for( size_t iKnot = 1; iKnot + 1 < breakpoints.size( ); ++iKnot )
+    {
+        size_t multiplicity = static_cast<size_t>( std::count( knotVector.begin( ), knotVector.end( ), breakpoints[iKnot] ) );
+
+        runtime_check( multiplicity <= p, "Degree reduction needs a continuous curve." );
+
+        newKnots.insert( newKnots.end( ), p - multiplicity, breakpoints[iKnot] );
+    }
+
+    auto decomposition = refineKnotVector( knotVector, p, newKnots );
+
+    std::vector<std::vector<double>> bezierPoints;
+
+    for( const auto& coordinates : controlPoints )
+    {
+        bezierPoints.push_back( decomposition.prolongation * coordinates );
+    }
+
+    bezierPoints = detail::transpose( bezierPoints );
+
+    size_t numberOfSegments = breakpoints.size( ) - 1;
+    size_t numberOfDimensions = controlPoints.size( );
+    size_t q = p - 1;
+    size_t r = ( p - 1 ) / 2;
+
+    CurveReduction reduction { { }, q, { }, 0.0 };
+
+    reduction.knotVector.insert( reduction.knotVector.end( ), q + 1, breakpoints.front( ) );
+
+    for( size_t iKnot = 1; iKnot + 1 < breakpoints.size( ); ++iKnot )
+    {
+        reduction.knotVector.insert( reduction.knotVector.end( ), q, breakpoints[iKnot] );
+    }
+
+    reduction.knotVector.insert( reduction.knotVector.end( ), q + 1, breakpoints.back( ) );
+
+    std::vector<std::vector<double>> points( numberOfSegments * q + 1, std::vector<double>( numberOfDimensions ) );
+
+    auto alpha = [=]( size_t i ) { return static_cast<double>( i ) / p; };
+
+    // Invert degree elevation P_i = alpha_i Q_(i - 1) + (1 - alpha_i) Q_i from both ends of each segment
+    for( size_t iSegment = 0; iSegment < numberOfSegments; ++iSegment )
+    {
+        const auto* P = &bezierPoints[iSegment * p];
+        auto* Q = &points[iSegment * q];
+
+        Q[0] = P[0];
+        Q[q] = P[p];
+
+        size_t leftEnd = p % 2 == 0 ? r : r - 1;
+
+        for( size_t i = 1; i <= leftEnd; ++i )
+        {
+            for( size_t d = 0; d < numberOfDimensions; ++d )
+            {
+                Q[i][d] = ( P[i][d] - alpha( i ) * Q[i - 1][d] ) / ( 1.0 - alpha( i ) );
+            }
+        }
+
+        for( size_t i = p - 1; i >= r + 2; --i )
+        {
+            for( size_t d = 0; d < numberOfDimensions; ++d )
+            {
+                Q[i - 1][d] = ( P[i][d] - ( 1.0 - alpha( i ) ) * Q[i][d] ) / alpha( i );
+            }
+        }
+
+        double error = 0.0;
+
+        if( p % 2 == 0 )
+        {
+            std::vector<double> middle( numberOfDimensions );
+
+            for( size_t d = 0; d < numberOfDimensions; ++d )
+            {
+                middle[d] = 0.5 * ( Q[r][d] + Q[r + 1][d] );
+            }
+
+            error = detail::distance( middle, P[r + 1] );
+        }
+        else
+        {
+            std::vector<double> left( numberOfDimensions ), right( numberOfDimensions );
+
+            for( size_t d = 0; d < numberOfDimensions; ++d )
+            {
+                left[d] = ( P[r][d] - alpha( r ) * Q[r - 1][d] ) / ( 1.0 - alpha( r ) );
+                right[d] = ( P[r + 1][d] - ( 1.0 - alpha( r + 1 ) ) * Q[r + 1][d] ) / alpha( r + 1 );
+
+                Q[r][d] = 0.5 * ( left[d] + right[d] );
+            }
+
+            error = 0.5 * ( 1.0 - alpha( r ) ) * detail::distance( left, right );
+        }
+
+        reduction.errorBound = std::max( reduction.errorBound, error );
+    }
+
+    reduction.controlPoints = detail::transpose( points );
+
+    return reduction;
+}
+
+CurveReduction compressCurve( const std::vector<double>& knotVector,
+                              size_t p,
+                              const std::vector<std::vector<double>>& controlPoints,
+                              double tolerance,
+                              bool reduceDegrees )
+{
+    CurveReduction reduction { knotVector, p, controlPoints, 0.0 };
+
+    while( reduceDegrees && reduction.degree >= 2 )
+    {
+        auto reduced = reduceDegree( reduction.knotVector, reduction.degree, reduction.controlPoints );
+
+        reduced.errorBound += reduction.errorBound;
+
+        if( reduced.errorBound > tolerance )
+        {
+            break;
+        }
+
+        reduction = std::move( reduced );
+    }
+
+    auto removal = removeKnots( reduction.knotVector, reduction.degree, reduction.controlPoints,
+                                tolerance - reduction.errorBound );
+
+    removal.errorBound += reduction.errorBound;
+
+    return removal;
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -0,0 +1,554 @@
+#include "spanhierarchy.hpp"
+#include "bezierextraction.hpp"
+#include "knotvector.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+SpanHierarchy::SpanHierarchy( const CurveFleet& fleet, size_t maximumLeafSize ) :
+    fleet_( fleet ),
+    numberOfDimensions_( fleet.numberOfDimensions( ) ),
+    curveSpanOffsets_( 1, 0 )
+{
+    runtime_check( maximumLeafSize > 0, "Leaves must contain at least one span." );
+
+    for( size_t iCurve = 0; iCurve < fleet.numberOfCurves( ); ++iCurve )
+    {
+        size_t p = fleet.degree( iCurve );
+
+        auto begin = fleet.knots( ).begin( ) + fleet.knotOffsets( )[iCurve];
+        auto end = fleet.knots( ).begin( ) + fleet.knotOffsets( )[iCurve + 1];
+
+        KnotVector knotVector( std::vector<double>( begin, end ), p );
+
+        bool open = std::count( begin, begin + p + 1, *begin ) == static_cast<std::ptrdiff_t>( p + 1 ) &&
+                    std::count( end - p - 1, end, *( end - 1 ) ) == static_cast<std::ptrdiff_t>( p + 1 );
+
+        std::vector<linalg::Matrix> extractionOperators;
+
+        if( open )
+        {
+            extractionOperators = bezierExtractionOperators( knotVector );
+        }
+
+        for( size_t iElement = 0; iElement < knotVector.numberOfElements( ); ++iElement )
+        {
+            spans_.push_back( { iCurve, iElement, knotVector.elementBegin( iElement ), knotVector.elementEnd( iElement ) } );
+
+            activePointOffsets_.push_back( fleet.controlPointOffsets( )[iCurve] + knotVector.spanIndex( iElement ) - p );
+            operatorOffsets_.push_back( operators_.size( ) );
+
+            // Coefficient of Bezier point b in terms of active control point a, identity if not open
+            for( size_t a = 0; a <= p; ++a )
+            {
+                for( size_t b = 0; b <= p; ++b )
+                {
+                    operators_.push_back( open ? extractionOperators[iElement]( a, b ) : ( a == b ? 1.0 : 0.0 ) );
+                }
+            }
+        }
+
+        curveSpanOffsets_.push_back( spans_.size( ) );
+    }
+
+    spanBounds_.resize( 2 * numberOfDimensions_ * spans_.size( ) );
+    endPoints_.resize( 2 * numberOfDimensions_ * spans_.size( ) );
+
+    for( size_t iSpan = 0; iSpan < spans_.size( ); ++iSpan )
+    {
+        computeSpanBounds( iSpan );
+    }
+
+    computeEndPoints( 0, fleet.numberOfCurves( ) );
+
+    order_.resize( spans_.size( ) );
+
+    std::iota( order_.begin( ), order_.end( ), size_t { 0 } );
+
+    if( !spans_.empty( ) )
+    {
+        build( 0, spans_.size( ), maximumLeafSize );
+    }
+
+    refit( );
+}
+
+void SpanHierarchy::computeSpanBounds( size_t spanIndex )
+{
+    size_t p = fleet_.degree( spans_[spanIndex].curveIndex );
+
+    const double* points = fleet_.controlPoints( ).data( ) + activePointOffsets_[spanIndex] * numberOfDimensions_;
+    const double* C = operators_.data( ) + operatorOffsets_[spanIndex];
+
+    double* lower = spanBounds_.data( ) + 2 * numberOfDimensions_ * spanIndex;
+    double* upper = lower + numberOfDimensions_;
+
+    std::fill( lower, upper, std::numeric_limits<double>::max( ) );
+    std::fill( upper, upper + numberOfDimensions_, std::numeric_limits<double>::lowest( ) );
+
+    for( size_t d = 0; d < numberOfDimensions_; ++d )
+    {
+        for( size_t b = 0; b <= p; ++b )
+        {
+            double value = 0.0;
+
+            for( size_t a = 0; a <= p; ++a )
+            {
+                value += C[a * ( p + 1 ) + b] * points[a * numberOfDimensions_ + d];
+            }
+
+            lower[d] = std::min( lower[d], value );
+            upper[d] = std::max( upper[d], value );
+        }
+    }
+}
+
+void SpanHierarchy::computeEndPoints( size_t beginCurve, size_t endCurve )
+{
+    size_t firstSpan = curveSpanOffsets_[beginCurve];
+
+    std::vector<double> tCoordinates;
+    std::vector<size_t> sampleOffsets( fleet_.numberOfCurves( ) + 1 );
+
+    for( size_t iSpan = firstSpan; iSpan < curveSpanOffsets_[endCurve]; ++iSpan )
+    {
+        tCoordinates.push_back( spans_[iSpan].lowerParameter );
+        tCoordinates.push_back( spans_[iSpan].upperParameter );
+    }
+
+    // Curves outside of [beginCurve, endCurve) get no samples
+    for( size_t iCurve = 0; iCurve <= fleet_.numberOfCurves( ); ++iCurve )
+    {
+        size_t clamped = std::min( std::max( iCurve, beginCurve ), endCurve );
+
+        sampleOffsets[iCurve] = 2 * ( curveSpanOffsets_[clamped] - firstSpan );
+    }
+
+    fleet_.evaluate( tCoordinates.data( ), sampleOffsets.data( ),
+                     endPoints_.data( ) + 2 * numberOfDimensions_ * firstSpan, 1 );
+}
+
+size_t SpanHierarchy::build( size_t begin, size_t end, size_t maximumLeafSize )
+{
+    size_t index = nodes_.size( );
+
+    nodes_.push_back( { begin, end, 0 } );
+
+    if( end - begin <= maximumLeafSize )
+    {
+        return index;
+    }
+
+    auto center = [&]( size_t spanIndex, size_t axis )
+    {
+        const double* bounds = spanBounds_.data( ) + 2 * numberOfDimensions_ * spanIndex;
+
+        return bounds[axis] + bounds[numberOfDimensions_ + axis];
+    };
+
+    // Split at the median of the box centers along the axis in which they are spread the most
+    size_t axis = 0;
+    double largestExtent = -1.0;
+
+    for( size_t d = 0; d < numberOfDimensions_; ++d )
+    {
+        auto range = std::minmax_element( order_.begin( ) + begin, order_.begin( ) + end, [&]( size_t i, size_t j )
+        {
+            return center( i, d ) < center( j, d );
+        } );
+
+        double extent = center( *range.second, d ) - center( *range.first, d );
+
+        if( extent > largestExtent )
+        {
+            largestExtent = extent;
+            axis = d;
+        }
+    }
+
+    size_t middle = ( begin + end ) / 2;
+
+    std::nth_element( order_.begin( ) + begin, order_.begin( ) + middle, order_.begin( ) + end, [&]( size_t i, size_t j )
+    {
+        return center( i, axis ) < center( j, axis ) || ( center( i, axis ) == center( j, axis ) && i < j );
+    } );
+
+    build( begin, middle, maximumLeafSize );
+
+    size_t right = build( middle, end, maximumLeafSize );
+
+    nodes_[index].right = right;
+
+    return index;
+}
+
+void SpanHierarchy::refit( )
+{
+    nodeBounds_.resize( 2 * numberOfDimensions_ * nodes_.size( ) );
+
+    auto merge = [&]( double* target, const double* source )
+    {
+        for( size_t d = 0; d < numberOfDimensions_; ++d )
+        {
+            target[d] = std::min( target[d], source[d] );
+            target[numberOfDimensions_ + d] = std::max( target[numberOfDimensions_ + d], source[numberOfDimensions_ + d] );
+        }
+    };
+
+    // Children are stored after their parents
+    for( size_t iNode = nodes_.size( ); iNode-- > 0; )
+    {
+        const Node& node = nodes_[iNode];
+
+        double* bounds = nodeBounds_.data( ) + 2 * numberOfDimensions_ * iNode;
+
+        std::fill( bounds, bounds + numberOfDimensions_, std::numeric_limits<double>::max( ) );
+        std::fill( bounds + numberOfDimensions_, bounds + 2 * numberOfDimensions_, std::numeric_limits<double>::lowest( ) );
+
+        if( node.right == 0 )
+        {
+            for( size_t i = node.begin; i < node.end; ++i )
+            {
+                merge( bounds, spanBounds_.data( ) + 2 * numberOfDimensions_ * order_[i] );
+            }
+        }
+        else
+        {
+            merge( bounds, nodeBounds_.data( ) + 2 * numberOfDimensions_ * ( iNode + 1 ) );
+            merge( bounds, nodeBounds_.data( ) + 2 * numberOfDimensions_ * node.right );
+        }
+    }
+}
+
+void SpanHierarchy::update( )
+{
+    for( size_t iSpan = 0; iSpan < spans_.size( ); ++iSpan )
+    {
+        computeSpanBounds( iSpan );
+    }
+
+    computeEndPoints( 0, fleet_.numberOfCurves( ) );
+
+    refit( );
+}
+
+void SpanHierarchy::update( size_t curveIndex )
+{
+    runtime_check( curveIndex < fleet_.numberOfCurves( ), "Curve index out of range." );
+
+    for( size_t iSpan = curveSpanOffsets_[curveIndex]; iSpan < curveSpanOffsets_[curveIndex + 1]; ++iSpan )
+    {
+        computeSpanBounds( iSpan );
+    }
+
+    computeEndPoints( curveIndex, curveIndex + 1 );
+
+    refit( );
+}
+
+size_t SpanHierarchy::numberOfSpans( ) const
+{
+    return spans_.size( );
+}
+
+size_t SpanHierarchy::numberOfNodes( ) const
+{
+    return nodes_.size( );
+}
+
+const CurveSpan& SpanHierarchy::span( size_t spanIndex ) const
+{
+    runtime_check( spanIndex < spans_.size( ), "Span index out of range." );
+
+    return spans_[spanIndex];
+}
+
+std::vector<double> SpanHierarchy::lowerBounds( size_t spanIndex ) const
+{
+    runtime_check( spanIndex < spans_.size( ), "Span index out of range." );
+
+    auto begin = spanBounds_.begin( ) + 2 * numberOfDimensions_ * spanIndex;
+
+    return std::vector<double>( begin, begin + numberOfDimensions_ );
+}
+
+std::vector<double> SpanHierarchy::upperBounds( size_t spanIndex ) const
+{
+    runtime_check( spanIndex < spans_.size( ), "Span index out of range." );
+
+    auto begin = spanBounds_.begin( ) + 2 * numberOfDimensions_ * spanIndex + numberOfDimensions_;
+
+    return std::vector<double>( begin, begin + numberOfDimensions_ );
+}
+
+std::vector<double> SpanHierarchy::lowerBounds( ) const
+{
+    runtime_check( !nodes_.empty( ), "Hierarchy is empty." );
+
+    return std::vector<double>( nodeBounds_.begin( ), nodeBounds_.begin( ) + numberOfDimensions_ );
+}
+
+std::vector<double> SpanHierarchy::upperBounds( ) const
+{
+    runtime_check( !nodes_.empty( ), "Hierarchy is empty." );
+
+    return std::vector<double>( nodeBounds_.begin( ) + numberOfDimensions_, nodeBounds_.begin( ) + 2 * numberOfDimensions_ );
+}
+
+double SpanHierarchy::boxDistance( const double* lower, const double* upper, const double* point ) const
+{
+    double squaredDistance = 0.0;
+
+    for( size_t d = 0; d < numberOfDimensions_; ++d )
+    {
+        double outside = std::max( { lower[d] - point[d], point[d] - upper[d], 0.0 } );
+
+        squaredDistance += outside * outside;
+    }
+
+    return std::sqrt( squaredDistance );
+}
+
+std::vector<size_t> SpanHierarchy::intersectBox( const std::vector<double>& lower,
+                                                 const std::vector<double>& upper ) const
+{
+    runtime_check( lower.size( ) == numberOfDimensions_ && upper.size( ) == numberOfDimensions_, "Inconsistent box dimensions." );
+
+    auto overlaps = [&]( const double* bounds )
+    {
+        for( size_t d = 0; d < numberOfDimensions_; ++d )
+        {
+            if( bounds[d] > upper[d] || bounds[numberOfDimensions_ + d] < lower[d] )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    std::vector<size_t> result, stack;
+
+    if( !nodes_.empty( ) )
+    {
+        stack.push_back( 0 );
+    }
+
+    while( !stack.empty( ) )
+    {
+        size_t iNode = stack.back( );
+
+        stack.pop_back( );
+
+        if( !overlaps( nodeBounds_.data( ) + 2 * numberOfDimensions_ * iNode ) )
+        {
+            continue;
+        }
+
+        const Node& node = nodes_[iNode];
+
+        if( node.right == 0 )
+        {
+            for( size_t i = node.begin; i < node.end; ++i )
+            {
+                if( overlaps( spanBounds_.data( ) + 2 * numberOfDimensions_ * order_[i] ) )
+                {
+                    result.push_back( order_[i] );
+                }
+            }
+        }
+        else
+        {
+            stack.push_back( node.right );
+            stack.push_back( iNode + 1 );
+        }
+    }
+
+    std::sort( result.begin( ), result.end( ) );
+
+    return result;
+}
+
+std::vector<size_t> SpanHierarchy::intersectRay( const std::vector<double>& origin,
+                                                 const std::vector<double>& direction,
+                                                 double maximumDistance ) const
+{
+    runtime_check( origin.size( ) == numberOfDimensions_ && direction.size( ) == numberOfDimensions_, "Inconsistent ray dimensions." );
+
+    // Slab test, returns the ray parameter at which the box is entered or a negative value
+    auto enter = [&]( const double* bounds )
+    {
+        double tMin = 0.0, tMax = maximumDistance;
+
+        for( size_t d = 0; d < numberOfDimensions_; ++d )
+        {
+            double lower = bounds[d], upper = bounds[numberOfDimensions_ + d];
+
+            if( direction[d] == 0.0 )
+            {
+                if( origin[d] < lower || origin[d] > upper )
+                {
+                    return -1.0;
+                }
+
+                continue;
+            }
+
+            double t1 = ( lower - origin[d] ) / direction[d];
+            double t2 = ( upper - origin[d] ) / direction[d];
+
+            tMin = std::max( tMin, std::min( t1, t2 ) );
+            tMax = std::min( tMax, std::max( t1, t2 ) );
+
+            if( tMin > tMax )
+            {
+                return -1.0;
+            }
+        }
+
+        return tMin;
+    };
+
+    std::vector<std::pair<double, size_t>> hits;
+    std::vector<size_t> stack;
+
+    if( !nodes_.empty( ) )
+    {
+        stack.push_back( 0 );
+    }
+
+    while( !stack.empty( ) )
+    {
+        size_t iNode = stack.back( );
+
+        stack.pop_back( );
+
+        if( enter( nodeBounds_.data( ) + 2 * numberOfDimensions_ * iNode ) < 0.0 )
+        {
+            continue;
+        }
+
+        const Node& node = nodes_[iNode];
+
+        if( node.right == 0 )
+        {
+            for( size_t i = node.begin; i < node.end; ++i )
+            {
+                double s = enter( spanBounds_.data( ) + 2 * numberOfDimensions_ * order_[i] );
+
+                if( s >= 0.0 )
+                {
+                    hits.emplace_back( s, order_[i] );
+                }
+            }
+        }
+        else
+        {
+            stack.push_back( node.right );
+            stack.push_back( iNode + 1 );
+        }
+    }
+
+    std::sort( hits.begin( ), hits.end( ) );
+
+    std::vector<size_t> result;
+
+    for( const auto& hit : hits )
+    {
+        result.push_back( hit.second );
+    }
+
+    return result;
+}
+
+std::vector<size_t> SpanHierarchy::nearestSpans( const std::vector<double>& point ) const
+{
+    runtime_check( point.size( ) == numberOfDimensions_, "Inconsistent point dimensions." );
+
+    auto nodeDistance = [&]( size_t iNode )
+    {
+        const double* bounds = nodeBounds_.data( ) + 2 * numberOfDimensions_ * iNode;
+
+        return boxDistance( bounds, bounds + numberOfDimensions_, point.data( ) );
+    };
+
+    using Entry = std::pair<double, size_t>;
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    std::vector<Entry> candidates;
+
+    double upperBound = std::numeric_limits<double>::infinity( );
+
+    if( !nodes_.empty( ) )
+    {
+        queue.emplace( nodeDistance( 0 ), 0 );
+    }
+
+    while( !queue.empty( ) && queue.top( ).first <= upperBound )
+    {
+        size_t iNode = queue.top( ).second;
+
+        queue.pop( );
+
+        const Node& node = nodes_[iNode];
+
+        if( node.right != 0 )
+        {
+            queue.emplace( nodeDistance( iNode + 1 ), iNode + 1 );
+            queue.emplace( nodeDistance( node.right ), node.right );
+
+            continue;
+        }
+
+        for( size_t i = node.begin; i < node.end; ++i )
+        {
+            size_t iSpan = order_[i];
+
+            const double* bounds = spanBounds_.data( ) + 2 * numberOfDimensions_ * iSpan;
+
+            double distance = boxDistance( bounds, bounds + numberOfDimensions_, point.data( ) );
+
+            if( distance > upperBound )
+            {
+                continue;
+            }
+
+            candidates.emplace_back( distance, iSpan );
+
+            // Both end points are on the curve
+            for( size_t iEnd = 0; iEnd < 2; ++iEnd )
+            {
+                const double* endPoint = endPoints_.data( ) + ( 2 * iSpan + iEnd ) * numberOfDimensions_;
+
+                upperBound = std::min( upperBound, boxDistance( endPoint, endPoint, point.data( ) ) );
+            }
+        }
+    }
+
+    std::sort( candidates.begin( ), candidates.end( ) );
+
+    std::vector<size_t> result;
+
+    for( const auto& candidate : candidates )
+    {
+        if( candidate.first <= upperBound )
+        {
+            result.push_back( candidate.second );
+        }
+    }
+
+    return result;
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -2,6 +2,7 @@
 #include "utilities.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 
 namespace cie
@@ -120,6 +121,11 @@ std::tuple<CompressedSparseRowMatrix::IndexType*, CompressedSparseRowMatrix::Ind
     return { indices_.data( ), indptr_.data( ), data_.data( ) };
 }
 
+std::tuple<const CompressedSparseRowMatrix::IndexType*, const CompressedSparseRowMatrix::IndexType*, const double*> CompressedSparseRowMatrix::dataStructure( ) const
+{
+    return { indices_.data( ), indptr_.data( ), data_.data( ) };
+}
+
 size_t CompressedSparseRowMatrix::size( ) const
 {
     return indptr_.size() - 1;
@@ -202,5 +208,125 @@ void CompressedSparseRowMatrix::scatter( const linalg::Matrix& elementMatrix, co
     }
 }
 
+BandedCholesky::BandedCholesky( const CompressedSparseRowMatrix& matrix ) :
+    size_( matrix.size( ) ), bandwidth_( 0 )
+{
+    auto data = matrix.dataStructure( );
+
+    const auto* indices = std::get<0>( data );
+    const auto* indptr = std::get<1>( data );
+    const double* values = std::get<2>( data );
+
+    for( size_t i = 0; i < size_; ++i )
+    {
+        for( auto k = indptr[i]; k < indptr[i + 1]; ++k )
+        {
+            size_t j = static_cast<size_t>( indices[k] );
+
+            bandwidth_ = std::max( bandwidth_, i > j ? i - j : j - i );
+        }
+    }
+
+    size_t b = bandwidth_;
+
+    band_.resize( size_ * ( b + 1 ), 0.0 );
+
+    // Copy the lower triangle, L(i, j) is at band_[i * (b + 1) + j + b - i]
+    for( size_t i = 0; i < size_; ++i )
+    {
+        for( auto k = indptr[i]; k < indptr[i + 1]; ++k )
+        {
+            size_t j = static_cast<size_t>( indices[k] );
+
+            if( j <= i )
+            {
+                band_[i * ( b + 1 ) + j + b - i] = values[k];
+            }
+        }
+    }
+
+    // Column by column, the dot products run over contiguous parts of two rows of the band
+    for( size_t j = 0; j < size_; ++j )
+    {
+        double* rowJ = band_.data( ) + j * ( b + 1 ) + b - j;
+
+        size_t begin = j > b ? j - b : 0;
+
+        double diagonal = rowJ[j];
+        double pivot = diagonal;
+
+        for( size_t k = begin; k < j; ++k )
+        {
+            pivot -= rowJ[k] * rowJ[k];
+        }
+
+        runtime_check( pivot > 1e-13 * std::abs( diagonal ) && pivot > 0.0, "Matrix is not positive definite." );
+
+        rowJ[j] = std::sqrt( pivot );
+
+        for( size_t i = j + 1; i < std::min( j + b + 1, size_ ); ++i )
+        {
+            double* rowI = band_.data( ) + i * ( b + 1 ) + b - i;
+
+            double value = rowI[j];
+
+            // The band of row i starts at column i - b (or 0)
+            for( size_t k = std::max( begin, i - std::min( i, b ) ); k < j; ++k )
+            {
+                value -= rowI[k] * rowJ[k];
+            }
+
+            rowI[j] = value / rowJ[j];
+        }
+    }
+}
+
+size_t BandedCholesky::size( ) const
+{
+    return size_;
+}
+
+size_t BandedCholesky::bandwidth( ) const
+{
+    return bandwidth_;
+}
+
+std::vector<double> BandedCholesky::solve( const std::vector<double>& rhs ) const
+{
+    runtime_check( rhs.size( ) == size_, "Invalid RHS size." );
+
+    size_t b = bandwidth_;
+
+    std::vector<double> x( rhs );
+
+    // Forward substitution L y = rhs
+    for( size_t i = 0; i < size_; ++i )
+    {
+        const double* rowI = band_.data( ) + i * ( b + 1 ) + b - i;
+
+        for( size_t k = i > b ? i - b : 0; k < i; ++k )
+        {
+            x[i] -= rowI[k] * x[k];
+        }
+
+        x[i] /= rowI[i];
+    }
+
+    // Backward substitution L^T x = y
+    for( size_t i = size_; i-- > 0; )
+    {
+        const double* rowI = band_.data( ) + i * ( b + 1 ) + b - i;
+
+        x[i] /= rowI[i];
+
+        for( size_t k = i > b ? i - b : 0; k < i; ++k )
+        {
+            x[k] -= rowI[k] * x[i];
+        }
+    }
+
+    return x;
+}
+
 } // splinekernel
 } // cie
\ No newline at end of file
@@ -1,54 +1,723 @@
 #include "surface.hpp"
 #include "basisfunctions.hpp"
+#include "knotvector.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
 
 namespace cie
 {
 namespace splinekernel
 {
     
-    VectorOfMatrices evaluateSurface( const std::array<std::vector<double>, 2>& knotVectors,
-                                      const VectorOfMatrices& controlPoints,
-                                      std::array<size_t, 2> numberOfSamplePoints )
+    template<typename ScalarType>
+    void evaluateSurfaceFields( const std::array<std::vector<double>, 2>& knotVectors,
+                                const std::vector<const ScalarType*>& controlPoints,
+                                std::array<size_t, 2> numberOfControlPoints,
+                                std::array<size_t, 2> numberOfSamplePoints,
+                                const std::vector<ScalarType*>& results,
+                                size_t numberOfThreads )
     {
-        size_t numberOfControlPointsR = controlPoints[0].size1();
-        size_t numberOfControlPointsS = controlPoints[0].size2();
+        runtime_check(results.size() == controlPoints.size(), "Inconsistent number of fields.");
+        runtime_check(knotVectors[0].size() > numberOfControlPoints[0] && knotVectors[1].size() > numberOfControlPoints[1],
+                      "Inconsistent number of knots and control points.");
+
+        size_t numberOfControlPointsS = numberOfControlPoints[1];
 
         size_t numberOfFields = controlPoints.size();
 
-        size_t pr = knotVectors[0].size() - numberOfControlPointsR - 1;   // p = m - n - 1
+        size_t pr = knotVectors[0].size() - numberOfControlPoints[0] - 1;   // p = m - n - 1
         size_t ps = knotVectors[1].size() - numberOfControlPointsS - 1;
 
+        // Active basis function values in r and s (only pr + 1 and ps + 1 are non-zero), evaluated
+        // for all sample lines at once since they are the same for all rows and columns
+        KnotVector knotsR(knotVectors[0], pr), knotsS(knotVectors[1], ps);
+
+        std::vector<ScalarType> r(numberOfSamplePoints[0]), s(numberOfSamplePoints[1]);
+
+        for (size_t iSampleCoordinate = 0; iSampleCoordinate < numberOfSamplePoints[0]; ++iSampleCoordinate)
+        {
+            r[iSampleCoordinate] = static_cast<ScalarType>(iSampleCoordinate / (numberOfSamplePoints[0] - 1.0));  // Normalization
+        }
+
+        for (size_t jSampleCoordinate = 0; jSampleCoordinate < numberOfSamplePoints[1]; ++jSampleCoordinate)
+        {
+            s[jSampleCoordinate] = static_cast<ScalarType>(jSampleCoordinate / (numberOfSamplePoints[1] - 1.0));
+        }
+
+        std::vector<size_t> spansR(r.size()), spansS(s.size());
+        std::vector<ScalarType> basisR(r.size() * (pr + 1)), basisS(s.size() * (ps + 1));
+
+        evaluateActiveBSplineBasisBatch(r.data(), r.size(), knotsR, spansR.data(), basisR.data());
+        evaluateActiveBSplineBasisBatch(s.data(), s.size(), knotsS, spansS.data(), basisS.data());
+
+        // The surface is Br * C * Bs^T with the banded sample matrices Br and Bs (row i holds the
+        // p + 1 active basis values starting at column span - p). The product is evaluated sample
+        // row by sample row: first the row of Br * C is accumulated from pr + 1 rows of control
+        // points, then it is multiplied with Bs^T. This needs (pr + 1) nS + (ps + 1) samplesS
+        // operations per sample row and field instead of (pr + 1) (ps + 1) samplesS. The sample
+        // rows are independent and distributed to the threads in contiguous blocks; every value is
+        // computed by the same operations in the same order, regardless of the number of threads.
+        parallelFor(numberOfSamplePoints[0], numberOfThreads, [&](size_t beginRow, size_t endRow)
+        {
+            std::vector<ScalarType> rows(numberOfFields * numberOfControlPointsS);
+
+            for (size_t iSampleCoordinate = beginRow; iSampleCoordinate < endRow; ++iSampleCoordinate)
+            {
+                size_t spanR = spansR[iSampleCoordinate];
+                const ScalarType* Nr = basisR.data() + iSampleCoordinate * (pr + 1);
+
+                // All fields are done in the same pass, sharing the basis values of the current row
+                for (size_t iField = 0; iField < numberOfFields; ++iField)
+                {
+                    ScalarType* row = rows.data() + iField * numberOfControlPointsS;
+
+                    std::fill(row, row + numberOfControlPointsS, ScalarType { 0 });
+
+                    for (size_t iBasisFunction = 0; iBasisFunction <= pr; ++iBasisFunction)
+                    {
+                        const ScalarType* controlPointRow = controlPoints[iField] + (spanR - pr + iBasisFunction) * numberOfControlPointsS;
+
+                        for (size_t jControlPoint = 0; jControlPoint < numberOfControlPointsS; ++jControlPoint)
+                        {
+                            row[jControlPoint] += Nr[iBasisFunction] * controlPointRow[jControlPoint];
+                        }
+                    }   // iBasisFunction
+
+                    ScalarType* result = results[iField] + iSampleCoordinate * numberOfSamplePoints[1];
+
+                    for (size_t jSampleCoordinate = 0; jSampleCoordinate < numberOfSamplePoints[1]; ++jSampleCoordinate)
+                    {
+                        const ScalarType* Ns = basisS.data() + jSampleCoordinate * (ps + 1);
+                        const ScalarType* activeRow = row + spansS[jSampleCoordinate] - ps;
+
+                        ScalarType value = 0;
+
+                        for (size_t jBasisFunction = 0; jBasisFunction <= ps; ++jBasisFunction)
+                        {
+                            value += Ns[jBasisFunction] * activeRow[jBasisFunction];
+                        }   // jBasisFunction
+
+                        result[jSampleCoordinate] = value;
+                    }   // jSampleCoordinate
+                }   // iField
+            }   // iSampleCoordinate
+        });
+    }
+
+    template void evaluateSurfaceFields<float>( const std::array<std::vector<double>, 2>&, const std::vector<const float*>&,
+                                                std::array<size_t, 2>, std::array<size_t, 2>, const std::vector<float*>&, size_t );
+    template void evaluateSurfaceFields<double>( const std::array<std::vector<double>, 2>&, const std::vector<const double*>&,
+                                                 std::array<size_t, 2>, std::array<size_t, 2>, const std::vector<double*>&, size_t );
+
+    VectorOfMatrices evaluateSurface( const std::array<std::vector<double>, 2>& knotVectors,
+                                      const VectorOfMatrices& controlPoints,
+                                      std::array<size_t, 2> numberOfSamplePoints,
+                                      size_t numberOfThreads )
+    {
+        size_t numberOfFields = controlPoints.size();
+
         VectorOfMatrices result(numberOfFields);
 
+        // linalg::Matrix stores its entries row by row in one contiguous block
+        std::vector<const double*> controlPointData(numberOfFields);
+        std::vector<double*> resultData(numberOfFields);
+
         for (size_t iField = 0; iField < numberOfFields; ++iField)
         {
             result[iField] = linalg::Matrix(numberOfSamplePoints[0], numberOfSamplePoints[1], 0.0);
 
-            for (size_t iSampleCoordinate = 0; iSampleCoordinate < numberOfSamplePoints[0]; ++iSampleCoordinate)
+            controlPointData[iField] = &const_cast<linalg::Matrix&>(controlPoints[iField])(0, 0);
+            resultData[iField] = &result[iField](0, 0);
+        }
+
+        evaluateSurfaceFields( knotVectors, controlPointData, { controlPoints[0].size1(), controlPoints[0].size2() },
+                               numberOfSamplePoints, resultData, numberOfThreads );
+
+        return result;
+    }
+
+    template<typename ScalarType>
+    void evaluateSurfaceFieldsAt( const std::array<std::vector<double>, 2>& knotVectors,
+                                  const std::vector<const ScalarType*>& controlPoints,
+                                  std::array<size_t, 2> numberOfControlPoints,
+                                  const ScalarType* rCoordinates,
+                                  const ScalarType* sCoordinates,
+                                  size_t numberOfPoints,
+                                  const std::vector<ScalarType*>& results,
+                                  size_t numberOfThreads )
+    {
+        runtime_check(results.size() == controlPoints.size(), "Inconsistent number of fields.");
+        runtime_check(knotVectors[0].size() > numberOfControlPoints[0] && knotVectors[1].size() > numberOfControlPoints[1],
+                      "Inconsistent number of knots and control points.");
+
+        size_t numberOfControlPointsS = numberOfControlPoints[1];
+        size_t numberOfFields = controlPoints.size();
+
+        size_t pr = knotVectors[0].size() - numberOfControlPoints[0] - 1;
+        size_t ps = knotVectors[1].size() - numberOfControlPointsS - 1;
+
+        KnotVector knotsR(knotVectors[0], pr), knotsS(knotVectors[1], ps);
+
+        size_t numberOfElementsS = knotsS.numberOfElements();
+        size_t numberOfCells = knotsR.numberOfElements() * numberOfElementsS;
+
+        // Counting sort of the points by knot span cell
+        std::vector<size_t> cells(numberOfPoints), cellOffsets(numberOfCells + 1, 0), order(numberOfPoints);
+
+        for (size_t iPoint = 0; iPoint < numberOfPoints; ++iPoint)
+        {
+            cells[iPoint] = knotsR.findElement(rCoordinates[iPoint]) * numberOfElementsS + knotsS.findElement(sCoordinates[iPoint]);
+            cellOffsets[cells[iPoint] + 1] += 1;
+        }
+
+        std::partial_sum(cellOffsets.begin(), cellOffsets.end(), cellOffsets.begin());
+
+        std::vector<size_t> fill(cellOffsets.begin(), cellOffsets.end() - 1);
+
+        for (size_t iPoint = 0; iPoint < numberOfPoints; ++iPoint)
+        {
+            order[fill[cells[iPoint]]++] = iPoint;
+        }
+
+        parallelFor(numberOfPoints, numberOfThreads, [&](size_t begin, size_t end)
+        {
+            std::vector<ScalarType> Nr(pr + 1), Ns(ps + 1);
+
+            for (size_t k = begin; k < end; ++k)
             {
-                for (size_t jSampleCoordinate = 0; jSampleCoordinate < numberOfSamplePoints[1]; ++jSampleCoordinate)
+                size_t iPoint = order[k];
+
+                size_t spanR = knotsR.spanIndex(cells[iPoint] / numberOfElementsS);
+                size_t spanS = knotsS.spanIndex(cells[iPoint] % numberOfElementsS);
+
+                evaluateActiveBSplineBasis(rCoordinates[iPoint], spanR, pr, knotsR.knots(), Nr.data());
+                evaluateActiveBSplineBasis(sCoordinates[iPoint], spanS, ps, knotsS.knots(), Ns.data());
+
+                for (size_t iField = 0; iField < numberOfFields; ++iField)
                 {
-                    double r = iSampleCoordinate / (numberOfSamplePoints[0] - 1.0);  // Normalization
-                    double s = jSampleCoordinate / (numberOfSamplePoints[1] - 1.0);
+                    ScalarType value = 0;
 
-                    for (size_t iBasisFunction = 0; iBasisFunction < numberOfControlPointsR; ++iBasisFunction)
+                    for (size_t iBasisFunction = 0; iBasisFunction <= pr; ++iBasisFunction)
                     {
-                        for (size_t jBasisFunction = 0; jBasisFunction < numberOfControlPointsS; ++jBasisFunction)
+                        const ScalarType* row = controlPoints[iField] + (spanR - pr + iBasisFunction) * numberOfControlPointsS + spanS - ps;
+
+                        ScalarType rowValue = 0;
+
+                        for (size_t jBasisFunction = 0; jBasisFunction <= ps; ++jBasisFunction)
                         {
-                            double Ni = evaluateBSplineBasis(r, iBasisFunction, pr, knotVectors[0]);
-                            double Nj = evaluateBSplineBasis(s, jBasisFunction, ps, knotVectors[1]);
+                            rowValue += Ns[jBasisFunction] * row[jBasisFunction];
+                        }
 
-                            double value = Ni * Nj * controlPoints[iField](iBasisFunction, jBasisFunction);
-                            
-                            result[iField](iSampleCoordinate, jSampleCoordinate) += value;
-                        }   // jBasisFunction
-                    }   // iBasisFunction
-                }   // jSampleCoordinate
-            }   // iSampleCoordinate
-        }   // iField
+                        value += Nr[iBasisFunction] * rowValue;
+                    }
+
+                    results[iField][iPoint] = value;
+                }
+            }
+        });
+    }
+
+    template void evaluateSurfaceFieldsAt<float>( const std::array<std::vector<double>, 2>&, const std::vector<const float*>&,
+                                                  std::array<size_t, 2>, const float*, const float*, size_t,
+                                                  const std::vector<float*>&, size_t );
+    template void evaluateSurfaceFieldsAt<double>( const std::array<std::vector<double>, 2>&, const std::vector<const double*>&,
+                                                   std::array<size_t, 2>, const double*, const double*, size_t,
+                                                   const std::vector<double*>&, size_t );
+
+    std::vector<std::vector<double>> evaluateSurfaceAt( const std::array<std::vector<double>, 2>& knotVectors,
+                                                        const VectorOfMatrices& controlPoints,
+                                                        const std::vector<double>& rCoordinates,
+                                                        const std::vector<double>& sCoordinates,
+                                                        size_t numberOfThreads )
+    {
+        runtime_check(!controlPoints.empty(), "No control points given.");
+        runtime_check(rCoordinates.size() == sCoordinates.size(), "Inconsistent number of r and s coordinates.");
+
+        size_t numberOfFields = controlPoints.size();
+
+        std::vector<std::vector<double>> result(numberOfFields, std::vector<double>(rCoordinates.size()));
+
+        std::vector<const double*> controlPointData(numberOfFields);
+        std::vector<double*> resultData(numberOfFields);
+
+        for (size_t iField = 0; iField < numberOfFields; ++iField)
+        {
+            runtime_check(controlPoints[iField].size1() == controlPoints[0].size1() && 
+                          controlPoints[iField].size2() == controlPoints[0].size2(), "Inconsistent control point matrices.");
+
+            controlPointData[iField] = &const_cast<linalg::Matrix&>(controlPoints[iField])(0, 0);
+            resultData[iField] = result[iField].data();
+        }
+
+        evaluateSurfaceFieldsAt( knotVectors, controlPointData, { controlPoints[0].size1(), controlPoints[0].size2() },
+                                 rCoordinates.data(), sCoordinates.data(), rCoordinates.size(), resultData, numberOfThreads );
+
+        return result;
+    }
+
+    SurfaceGridEvaluator::SurfaceGridEvaluator( const std::array<std::vector<double>, 2>& knotVectors,
+                                                const VectorOfMatrices& controlPoints,
+                                                std::array<size_t, 2> numberOfSamplePoints,
+                                                size_t numberOfThreads ) :
+        controlPoints_(controlPoints)
+    {
+        runtime_check(!controlPoints.empty(), "No control points given.");
+
+        for (const auto& field : controlPoints)
+        {
+            runtime_check(field.size1() == controlPoints[0].size1() && field.size2() == controlPoints[0].size2(),
+                          "Inconsistent control point matrices.");
+        }
+
+        samples_ = evaluateSurface(knotVectors, controlPoints, numberOfSamplePoints, numberOfThreads);
+
+        std::array<size_t, 2> numberOfControlPoints = { controlPoints[0].size1(), controlPoints[0].size2() };
+
+        // Same sample coordinates and basis kernel as in evaluateSurfaceFields
+        for (size_t axis = 0; axis < 2; ++axis)
+        {
+            size_t p = knotVectors[axis].size() - numberOfControlPoints[axis] - 1;
+
+            knotVectors_[axis] = KnotVector(knotVectors[axis], p);
+
+            std::vector<double> t(numberOfSamplePoints[axis]);
+
+            for (size_t iSample = 0; iSample < t.size(); ++iSample)
+            {
+                t[iSample] = iSample / (numberOfSamplePoints[axis] - 1.0);
+            }
+
+            spans_[axis].resize(t.size());
+            basis_[axis].resize(t.size() * (p + 1));
+
+            evaluateActiveBSplineBasisBatch(t.data(), t.size(), knotVectors_[axis], spans_[axis].data(), basis_[axis].data());
+        }
+    }
+
+    void SurfaceGridEvaluator::moveControlPoint( size_t i, size_t j, const std::vector<double>& delta )
+    {
+        runtime_check(delta.size() == controlPoints_.size(), "Inconsistent number of fields.");
+        runtime_check(i < controlPoints_[0].size1() && j < controlPoints_[0].size2(), "Control point index out of range.");
+
+        for (size_t iField = 0; iField < controlPoints_.size(); ++iField)
+        {
+            controlPoints_[iField](i, j) += delta[iField];
+        }
+
+        updateSamples(i, j);
+    }
+
+    void SurfaceGridEvaluator::setControlPoint( size_t i, size_t j, const std::vector<double>& values )
+    {
+        runtime_check(values.size() == controlPoints_.size(), "Inconsistent number of fields.");
+        runtime_check(i < controlPoints_[0].size1() && j < controlPoints_[0].size2(), "Control point index out of range.");
+
+        for (size_t iField = 0; iField < controlPoints_.size(); ++iField)
+        {
+            controlPoints_[iField](i, j) = values[iField];
+        }
+
+        updateSamples(i, j);
+    }
+
+    std::array<size_t, 4> SurfaceGridEvaluator::affectedSamples( size_t i, size_t j ) const
+    {
+        std::array<size_t, 4> range;
+
+        // Basis function i is active on the knot spans i, ..., i + p, the spans of the samples are sorted
+        for (size_t axis = 0; axis < 2; ++axis)
+        {
+            size_t index = axis == 0 ? i : j;
+
+            const auto& spans = spans_[axis];
+
+            range[2 * axis] = std::lower_bound(spans.begin(), spans.end(), index) - spans.begin();
+            range[2 * axis + 1] = std::upper_bound(spans.begin(), spans.end(), index + knotVectors_[axis].degree()) - spans.begin();
+        }
+
+        return range;
+    }
+
+    void SurfaceGridEvaluator::updateSamples( size_t i, size_t j )
+    {
+        auto range = affectedSamples(i, j);
+
+        if (range[0] == range[1] || range[2] == range[3])
+        {
+            return;
+        }
+
+        size_t pr = knotVectors_[0].degree();
+        size_t ps = knotVectors_[1].degree();
+
+        size_t numberOfControlPointsS = controlPoints_[0].size2();
+        size_t numberOfSamplePointsS = spans_[1].size();
+
+        // Columns of Br * C that are needed by the samples in [sBegin, sEnd)
+        size_t firstColumn = spans_[1][range[2]] - ps;
+        size_t lastColumn = spans_[1][range[3] - 1];
+
+        std::vector<double> row(lastColumn + 1 - firstColumn);
+
+        for (size_t iField = 0; iField < controlPoints_.size(); ++iField)
+        {
+            const double* controlPointData = &controlPoints_[iField](0, 0);
+            double* sampleData = &samples_[iField](0, 0);
+
+            // Same operations in the same order as evaluateSurfaceFields, restricted to the rectangle
+            for (size_t iSampleCoordinate = range[0]; iSampleCoordinate < range[1]; ++iSampleCoordinate)
+            {
+                size_t spanR = spans_[0][iSampleCoordinate];
+                const double* Nr = basis_[0].data() + iSampleCoordinate * (pr + 1);
+
+                std::fill(row.begin(), row.end(), 0.0);
+
+                for (size_t iBasisFunction = 0; iBasisFunction <= pr; ++iBasisFunction)
+                {
+                    const double* controlPointRow = controlPointData + (spanR - pr + iBasisFunction) * numberOfControlPointsS + firstColumn;
+
+                    for (size_t jColumn = 0; jColumn < row.size(); ++jColumn)
+                    {
+                        row[jColumn] += Nr[iBasisFunction] * controlPointRow[jColumn];
+                    }
+                }
+
+                for (size_t jSampleCoordinate = range[2]; jSampleCoordinate < range[3]; ++jSampleCoordinate)
+                {
+                    const double* Ns = basis_[1].data() + jSampleCoordinate * (ps + 1);
+                    const double* activeRow = row.data() + spans_[1][jSampleCoordinate] - ps - firstColumn;
+
+                    double value = 0;
+
+                    for (size_t jBasisFunction = 0; jBasisFunction <= ps; ++jBasisFunction)
+                    {
+                        value += Ns[jBasisFunction] * activeRow[jBasisFunction];
+                    }
+
+                    sampleData[iSampleCoordinate * numberOfSamplePointsS + jSampleCoordinate] = value;
+                }
+            }
+        }
+    }
+
+    std::array<size_t, 2> SurfaceGridEvaluator::numberOfSamplePoints( ) const
+    {
+        return { spans_[0].size(), spans_[1].size() };
+    }
+
+    const VectorOfMatrices& SurfaceGridEvaluator::controlPoints( ) const
+    {
+        return controlPoints_;
+    }
+
+    const VectorOfMatrices& SurfaceGridEvaluator::samples( ) const
+    {
+        return samples_;
+    }
+
+    namespace detail
+    {
+
+    // Active basis functions and their derivatives up to maxDiffOrder at equally spaced sample points in [0, 1]
+    void evaluateSampleLine( const KnotVector& knots,
+                             size_t numberOfSamples,
+                             size_t maxDiffOrder,
+                             std::vector<size_t>& spans,
+                             std::vector<double>& basis )
+    {
+        size_t p = knots.degree( );
+        size_t stride = (maxDiffOrder + 1) * (p + 1);
+
+        spans.resize(numberOfSamples);
+        basis.resize(numberOfSamples * stride);
+
+        size_t element = 0;
+
+        for (size_t iSample = 0; iSample < numberOfSamples; ++iSample)
+        {
+            double t = iSample / (numberOfSamples - 1.0);
+
+            element = knots.findElement(t, element);
+            spans[iSample] = knots.spanIndex(element);
+
+            evaluateActiveBSplineDerivatives(t, spans[iSample], p, knots.knots( ), maxDiffOrder, basis.data( ) + iSample * stride);
+        }
+    }
+
+    // Evaluates the rational patch (result[0]) and, if requested, its derivatives (result[1] and result[2])
+    std::array<VectorOfMatrices, 3> evaluateRationalSurface( const std::array<std::vector<double>, 2>& knotVectors,
+                                                             const VectorOfMatrices& controlPoints,
+                                                             const linalg::Matrix& weights,
+                                                             std::array<size_t, 2> numberOfSamplePoints,
+                                                             bool computeDerivatives )
+    {
+        runtime_check(!controlPoints.empty(), "No control points given.");
+
+        size_t numberOfControlPointsR = controlPoints[0].size1();
+        size_t numberOfControlPointsS = controlPoints[0].size2();
+
+        runtime_check(weights.size1() == numberOfControlPointsR && weights.size2() == numberOfControlPointsS,
+                      "Inconsistent number of weights.");
+
+        size_t numberOfFields = controlPoints.size();
+
+        size_t pr = knotVectors[0].size() - numberOfControlPointsR - 1;
+        size_t ps = knotVectors[1].size() - numberOfControlPointsS - 1;
+
+        KnotVector knotsR(knotVectors[0], pr), knotsS(knotVectors[1], ps);
+
+        std::vector<size_t> spansR, spansS;
+        std::vector<double> basisR, basisS;
+
+        evaluateSampleLine(knotsR, numberOfSamplePoints[0], 1, spansR, basisR);
+        evaluateSampleLine(knotsS, numberOfSamplePoints[1], 1, spansS, basisS);
+
+        size_t numberOfResults = computeDerivatives ? 3 : 1;
+
+        std::array<VectorOfMatrices, 3> result;
+
+        for (size_t iResult = 0; iResult < numberOfResults; ++iResult)
+        {
+            for (size_t iField = 0; iField < numberOfFields; ++iField)
+            {
+                result[iResult].push_back(linalg::Matrix(numberOfSamplePoints[0], numberOfSamplePoints[1], 0.0));
+            }
+        }
+
+        // Weighted sums for value, d/dr and d/ds; index 0 is the weight, 1 + iField the fields
+        std::vector<double> sums(3 * (numberOfFields + 1));
+
+        for (size_t iSampleCoordinate = 0; iSampleCoordinate < numberOfSamplePoints[0]; ++iSampleCoordinate)
+        {
+            size_t spanR = spansR[iSampleCoordinate];
+            const double* Nr = basisR.data() + iSampleCoordinate * 2 * (pr + 1);
+            const double* dNr = Nr + pr + 1;
+
+            for (size_t jSampleCoordinate = 0; jSampleCoordinate < numberOfSamplePoints[1]; ++jSampleCoordinate)
+            {
+                size_t spanS = spansS[jSampleCoordinate];
+                const double* Ns = basisS.data() + jSampleCoordinate * 2 * (ps + 1);
+                const double* dNs = Ns + ps + 1;
+
+                std::fill(sums.begin(), sums.end(), 0.0);
+
+                for (size_t iBasisFunction = 0; iBasisFunction <= pr; ++iBasisFunction)
+                {
+                    for (size_t jBasisFunction = 0; jBasisFunction <= ps; ++jBasisFunction)
+                    {
+                        size_t i = spanR - pr + iBasisFunction;
+                        size_t j = spanS - ps + jBasisFunction;
+
+                        double w = weights(i, j);
+
+                        // Weighted tensor product basis, shared by all fields
+                        std::array<double, 3> weightedBasis = { Nr[iBasisFunction] * Ns[jBasisFunction] * w,
+                                                                dNr[iBasisFunction] * Ns[jBasisFunction] * w,
+                                                                Nr[iBasisFunction] * dNs[jBasisFunction] * w };
+
+                        for (size_t iResult = 0; iResult < numberOfResults; ++iResult)
+                        {
+                            double* target = sums.data() + iResult * (numberOfFields + 1);
+
+                            target[0] += weightedBasis[iResult];
+
+                            for (size_t iField = 0; iField < numberOfFields; ++iField)
+                            {
+                                target[iField + 1] += weightedBasis[iResult] * controlPoints[iField](i, j);
+                            }
+                        }
+                    }   // jBasisFunction
+                }   // iBasisFunction
+
+                double W = sums[0];
+
+                runtime_check(W != 0.0, "Rational basis is undefined for zero weight sum.");
+
+                for (size_t iField = 0; iField < numberOfFields; ++iField)
+                {
+                    double value = sums[iField + 1] / W;
+
+                    result[0][iField](iSampleCoordinate, jSampleCoordinate) = value;
+
+                    // Quotient rule: (A' - W' * value) / W
+                    for (size_t iResult = 1; iResult < numberOfResults; ++iResult)
+                    {
+                        const double* derivativeSums = sums.data() + iResult * (numberOfFields + 1);
+
+                        result[iResult][iField](iSampleCoordinate, jSampleCoordinate) =
+                            (derivativeSums[iField + 1] - derivativeSums[0] * value) / W;
+                    }
+                }   // iField
+            }   // jSampleCoordinate
+        }   // iSampleCoordinate
 
         return result;
     }
 
+    } // namespace detail
+
+    VectorOfMatrices evaluateRationalSurface( const std::array<std::vector<double>, 2>& knotVectors,
+                                              const VectorOfMatrices& controlPoints,
+                                              const linalg::Matrix& weights,
+                                              std::array<size_t, 2> numberOfSamplePoints )
+    {
+        return detail::evaluateRationalSurface(knotVectors, controlPoints, weights, numberOfSamplePoints, false)[0];
+    }
+
+    std::array<VectorOfMatrices, 2> evaluateRationalSurfaceDerivatives( const std::array<std::vector<double>, 2>& knotVectors,
+                                                                        const VectorOfMatrices& controlPoints,
+                                                                        const linalg::Matrix& weights,
+                                                                        std::array<size_t, 2> numberOfSamplePoints )
+    {
+        auto result = detail::evaluateRationalSurface(knotVectors, controlPoints, weights, numberOfSamplePoints, true);
+
+        return { result[1], result[2] };
+    }
+
+    SurfaceGeometry evaluateSurfaceGeometry( const std::array<std::vector<double>, 2>& knotVectors,
+                                             const VectorOfMatrices& controlPoints,
+                                             std::array<size_t, 2> numberOfSamplePoints )
+    {
+        runtime_check(controlPoints.size() == 3, "Surface geometry needs x, y and z coordinates.");
+
+        size_t numberOfControlPointsR = controlPoints[0].size1();
+        size_t numberOfControlPointsS = controlPoints[0].size2();
+
+        for (const auto& field : controlPoints)
+        {
+            runtime_check(field.size1() == numberOfControlPointsR && field.size2() == numberOfControlPointsS,
+                          "Inconsistent control point matrices.");
+        }
+
+        runtime_check(knotVectors[0].size() > numberOfControlPointsR && knotVectors[1].size() > numberOfControlPointsS,
+                      "Inconsistent number of knots and control points.");
+
+        size_t pr = knotVectors[0].size() - numberOfControlPointsR - 1;
+        size_t ps = knotVectors[1].size() - numberOfControlPointsS - 1;
+
+        KnotVector knotsR(knotVectors[0], pr), knotsS(knotVectors[1], ps);
+
+        // Values, first and second derivatives of the active basis, once per sample line
+        std::vector<size_t> spansR, spansS;
+        std::vector<double> basisR, basisS;
+
+        detail::evaluateSampleLine(knotsR, numberOfSamplePoints[0], 2, spansR, basisR);
+        detail::evaluateSampleLine(knotsS, numberOfSamplePoints[1], 2, spansS, basisS);
+
+        SurfaceGeometry geometry;
+
+        linalg::Matrix zero(numberOfSamplePoints[0], numberOfSamplePoints[1], 0.0);
+
+        for (auto* fields : { &geometry.position, &geometry.derivativeR, &geometry.derivativeS, &geometry.derivativeRR,
+                              &geometry.derivativeRS, &geometry.derivativeSS, &geometry.normal })
+        {
+            fields->resize(3, zero);
+        }
+
+        geometry.gaussianCurvature = zero;
+        geometry.meanCurvature = zero;
+
+        const double undefined = std::numeric_limits<double>::quiet_NaN();
+
+        for (size_t iSampleCoordinate = 0; iSampleCoordinate < numberOfSamplePoints[0]; ++iSampleCoordinate)
+        {
+            size_t spanR = spansR[iSampleCoordinate];
+            const double* Nr = basisR.data() + iSampleCoordinate * 3 * (pr + 1);
+
+            for (size_t jSampleCoordinate = 0; jSampleCoordinate < numberOfSamplePoints[1]; ++jSampleCoordinate)
+            {
+                size_t spanS = spansS[jSampleCoordinate];
+                const double* Ns = basisS.data() + jSampleCoordinate * 3 * (ps + 1);
+
+                // S, S_r, S_s, S_rr, S_rs and S_ss for x, y and z
+                std::array<std::array<double, 3>, 6> D = { };
+
+                for (size_t iBasisFunction = 0; iBasisFunction <= pr; ++iBasisFunction)
+                {
+                    for (size_t jBasisFunction = 0; jBasisFunction <= ps; ++jBasisFunction)
+                    {
+                        size_t i = spanR - pr + iBasisFunction;
+                        size_t j = spanS - ps + jBasisFunction;
+
+                        double r0 = Nr[iBasisFunction], r1 = Nr[pr + 1 + iBasisFunction], r2 = Nr[2 * (pr + 1) + iBasisFunction];
+                        double s0 = Ns[jBasisFunction], s1 = Ns[ps + 1 + jBasisFunction], s2 = Ns[2 * (ps + 1) + jBasisFunction];
+
+                        std::array<double, 6> products = { r0 * s0, r1 * s0, r0 * s1, r2 * s0, r1 * s1, r0 * s2 };
+
+                        for (size_t d = 0; d < 3; ++d)
+                        {
+                            double controlPoint = controlPoints[d](i, j);
+
+                            for (size_t k = 0; k < 6; ++k)
+                            {
+                                D[k][d] += products[k] * controlPoint;
+                            }
+                        }
+                    }   // jBasisFunction
+                }   // iBasisFunction
+
+                std::array<VectorOfMatrices*, 6> targets = { &geometry.position, &geometry.derivativeR, &geometry.derivativeS,
+                                                              &geometry.derivativeRR, &geometry.derivativeRS, &geometry.derivativeSS };
+
+                for (size_t k = 0; k < 6; ++k)
+                {
+                    for (size_t d = 0; d < 3; ++d)
+                    {
+                        (*targets[k])[d](iSampleCoordinate, jSampleCoordinate) = D[k][d];
+                    }
+                }
+
+                const auto& Sr = D[1];
+                const auto& Ss = D[2];
+
+                std::array<double, 3> n = { Sr[1] * Ss[2] - Sr[2] * Ss[1],
+                                            Sr[2] * Ss[0] - Sr[0] * Ss[2],
+                                            Sr[0] * Ss[1] - Sr[1] * Ss[0] };
+
+                double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                if (length == 0.0)
+                {
+                    for (size_t d = 0; d < 3; ++d)
+                    {
+                        geometry.normal[d](iSampleCoordinate, jSampleCoordinate) = undefined;
+                    }
+
+                    geometry.gaussianCurvature(iSampleCoordinate, jSampleCoordinate) = undefined;
+                    geometry.meanCurvature(iSampleCoordinate, jSampleCoordinate) = undefined;
+
+                    continue;
+                }
+
+                auto dot = [](const std::array<double, 3>& a, const std::array<double, 3>& b)
+                {
+                    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+                };
+
+                for (size_t d = 0; d < 3; ++d)
+                {
+                    n[d] /= length;
+
+                    geometry.normal[d](iSampleCoordinate, jSampleCoordinate) = n[d];
+                }
+
+                // First (E, F, G) and second (L, M, N) fundamental forms
+                double E = dot(Sr, Sr), F = dot(Sr, Ss), G = dot(Ss, Ss);
+                double L = dot(D[3], n), M = dot(D[4], n), N = dot(D[5], n);
+
+                double determinant = E * G - F * F;
+
+                geometry.gaussianCurvature(iSampleCoordinate, jSampleCoordinate) = (L * N - M * M) / determinant;
+                geometry.meanCurvature(iSampleCoordinate, jSampleCoordinate) = (E * N - 2.0 * F * M + G * L) / (2.0 * determinant);
+            }   // jSampleCoordinate
+        }   // iSampleCoordinate
+
+        return geometry;
+    }
+
 } // namespace splinekernel
 } // namespace cie
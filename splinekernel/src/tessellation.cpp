@@ -0,0 +1,620 @@
+#include "tessellation.hpp"
+#include "basisfunctions.hpp"
+#include "utilities.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace cie
+{
+namespace splinekernel
+{
+namespace detail
+{
+
+// Distance of point x from the line segment [a, b]
+double distanceToSegment( const double* a, const double* b, const double* x, size_t numberOfDimensions )
+{
+    double ab = 0.0, ax = 0.0, abab = 0.0;
+
+    for( size_t d = 0; d < numberOfDimensions; ++d )
+    {
+        ab += ( b[d] - a[d] ) * ( x[d] - a[d] );
+        abab += ( b[d] - a[d] ) * ( b[d] - a[d] );
+    }
+
+    double s = abab > 0.0 ? std::min( std::max( ab / abab, 0.0 ), 1.0 ) : 0.0;
+
+    for( size_t d = 0; d < numberOfDimensions; ++d )
+    {
+        double difference = x[d] - a[d] - s * ( b[d] - a[d] );
+
+        ax += difference * difference;
+    }
+
+    return std::sqrt( ax );
+}
+
+// Angle between the segments [a, m] and [m, b], zero if one of them is degenerated
+double turningAngle( const double* a, const double* m, const double* b, size_t numberOfDimensions )
+{
+    double dot = 0.0, first = 0.0, second = 0.0;
+
+    for( size_t d = 0; d < numberOfDimensions; ++d )
+    {
+        dot += ( m[d] - a[d] ) * ( b[d] - m[d] );
+        first += ( m[d] - a[d] ) * ( m[d] - a[d] );
+        second += ( b[d] - m[d] ) * ( b[d] - m[d] );
+    }
+
+    if( first == 0.0 || second == 0.0 )
+    {
+        return 0.0;
+    }
+
+    return std::acos( std::min( std::max( dot / std::sqrt( first * second ), -1.0 ), 1.0 ) );
+}
+
+struct CurveTessellator
+{
+    const CurveEvaluator& curve;
+
+    double chordTolerance, angleTolerance;
+    size_t maximumDepth;
+
+    size_t numberOfDimensions;
+
+    std::vector<double> parameters, points;
+
+    // Appends the vertices in (t0, t1], the point at t0 was appended already. Points are passed
+    // by value since the output vector may reallocate while recursing.
+    void subdivide( double t0, double t1, std::vector<double> P0, std::vector<double> Pm,
+                    std::vector<double> P1, size_t depth )
+    {
+        double tm = 0.5 * ( t0 + t1 );
+
+        std::vector<double> Pl( numberOfDimensions ), Pr( numberOfDimensions );
+
+        curve.evaluate( 0.5 * ( t0 + tm ), Pl.data( ) );
+        curve.evaluate( 0.5 * ( tm + t1 ), Pr.data( ) );
+
+        bool accept = depth >= maximumDepth;
+
+        if( !accept )
+        {
+            accept = true;
+
+            if( chordTolerance > 0.0 )
+            {
+                for( const auto& P : { Pl, Pm, Pr } )
+                {
+                    accept = accept && distanceToSegment( P0.data( ), P1.data( ), P.data( ), numberOfDimensions ) <= chordTolerance;
+                }
+            }
+
+            if( angleTolerance > 0.0 )
+            {
+                accept = accept && turningAngle( P0.data( ), Pm.data( ), P1.data( ), numberOfDimensions ) <= angleTolerance;
+            }
+        }
+
+        if( accept )
+        {
+            parameters.push_back( t1 );
+            points.insert( points.end( ), P1.begin( ), P1.end( ) );
+        }
+        else
+        {
+            subdivide( t0, tm, P0, Pl, Pm, depth + 1 );
+            subdivide( tm, t1, Pm, Pr, P1, depth + 1 );
+        }
+    }
+};
+
+using SurfacePoint = std::array<double, 3>;
+
+// Vertex of a surface mesh, the index is assigned by the writer that outputs the vertex first
+struct SurfaceVertex
+{
+    SurfacePoint point;
+    std::int64_t index;
+};
+
+using SurfaceTriangle = std::array<SurfaceVertex*, 3>;
+
+// Leaf quad [r0, r1] x [s0, s1] of the subdivision with the surface point at its center
+struct ParameterQuad
+{
+    double r0, r1, s0, s1;
+
+    SurfaceVertex center;
+};
+
+class SurfaceTessellator
+{
+public:
+    SurfaceTessellator( const std::array<std::vector<double>, 2>& knotVectors,
+                        const VectorOfMatrices& controlPoints,
+                        double chordTolerance,
+                        size_t maximumDepth ) :
+        controlPoints_( controlPoints ),
+        chordTolerance_( chordTolerance ),
+        maximumDepth_( maximumDepth )
+    {
+        runtime_check( controlPoints.size( ) == 3, "Surface tessellation needs x, y and z coordinates." );
+        runtime_check( chordTolerance > 0.0, "Chord tolerance must be positive." );
+
+        for( const auto& field : controlPoints )
+        {
+            runtime_check( field.size1( ) == controlPoints[0].size1( ) && field.size2( ) == controlPoints[0].size2( ),
+                           "Inconsistent control point matrices." );
+        }
+
+        for( size_t axis = 0; axis < 2; ++axis )
+        {
+            size_t numberOfControlPoints = axis == 0 ? controlPoints[0].size1( ) : controlPoints[0].size2( );
+
+            runtime_check( knotVectors[axis].size( ) > numberOfControlPoints, "Inconsistent number of knots and control points." );
+
+            knotVectors_[axis] = KnotVector( knotVectors[axis], knotVectors[axis].size( ) - numberOfControlPoints - 1 );
+        }
+    }
+
+    /* The surface is polynomial within each knot span cell, so the cells are subdivided separately, *
+     * row by row in r. All vertices on the edges of a row are known once the next row is subdivided, *
+     * so the row is triangulated and passed to the callback at that point. Then the vertices that  *
+     * are not shared with the next row are released, only two rows of leaves are kept at a time.  */
+    template<typename Callback>
+    void tessellate( Callback&& callback )
+    {
+        std::vector<ParameterQuad> previousRow, currentRow;
+
+        for( size_t iElement = 0; iElement < knotVectors_[0].numberOfElements( ); ++iElement )
+        {
+            for( size_t jElement = 0; jElement < knotVectors_[1].numberOfElements( ); ++jElement )
+            {
+                double r0 = knotVectors_[0].elementBegin( iElement ), r1 = knotVectors_[0].elementEnd( iElement );
+                double s0 = knotVectors_[1].elementBegin( jElement ), s1 = knotVectors_[1].elementEnd( jElement );
+
+                subdivide( r0, r1, s0, s1, { point( r0, s0 ), point( r1, s0 ), point( r1, s1 ), point( r0, s1 ) }, 0, currentRow );
+            }
+
+            triangulate( previousRow, callback );
+            release( knotVectors_[0].elementBegin( iElement ) );
+
+            std::swap( previousRow, currentRow );
+
+            currentRow.clear( );
+        }
+
+        triangulate( previousRow, callback );
+    }
+
+    // Always evaluated from the knot spans found for (r, s), independent of the quad
+    SurfacePoint evaluate( double r, double s ) const
+    {
+        size_t pr = knotVectors_[0].degree( ), ps = knotVectors_[1].degree( );
+        size_t spanR = knotVectors_[0].findSpan( r ), spanS = knotVectors_[1].findSpan( s );
+
+        // On the stack for common degrees, since every vertex of the mesh is evaluated here
+        constexpr size_t maximumStackDegree = 8;
+
+        double NrStorage[maximumStackDegree + 1], NsStorage[maximumStackDegree + 1];
+
+        std::vector<double> NrHeap( pr > maximumStackDegree ? pr + 1 : 0 ), NsHeap( ps > maximumStackDegree ? ps + 1 : 0 );
+
+        double* Nr = pr > maximumStackDegree ? NrHeap.data( ) : NrStorage;
+        double* Ns = ps > maximumStackDegree ? NsHeap.data( ) : NsStorage;
+
+        evaluateActiveBSplineBasis( r, spanR, pr, knotVectors_[0].knots( ), Nr );
+        evaluateActiveBSplineBasis( s, spanS, ps, knotVectors_[1].knots( ), Ns );
+
+        SurfacePoint point = { };
+
+        for( size_t d = 0; d < 3; ++d )
+        {
+            for( size_t a = 0; a <= pr; ++a )
+            {
+                for( size_t b = 0; b <= ps; ++b )
+                {
+                    point[d] += Nr[a] * Ns[b] * controlPoints_[d]( spanR - pr + a, spanS - ps + b );
+                }
+            }
+        }
+
+        return point;
+    }
+
+private:
+    // Vertices that are already known are not evaluated again
+    SurfacePoint point( double r, double s ) const
+    {
+        auto vertex = verticesRS_.find( { r, s } );
+
+        return vertex != verticesRS_.end( ) ? vertex->second.point : evaluate( r, s );
+    }
+
+    void subdivide( double r0, double r1, double s0, double s1,
+                    const std::array<SurfacePoint, 4>& corners,
+                    size_t depth,
+                    std::vector<ParameterQuad>& leaves )
+    {
+        double rm = 0.5 * ( r0 + r1 );
+        double sm = 0.5 * ( s0 + s1 );
+
+        std::array<SurfacePoint, 4> edges = { point( rm, s0 ), point( r1, sm ), point( rm, s1 ), point( r0, sm ) };
+
+        SurfacePoint center = evaluate( rm, sm );
+
+        double error = 0.0, twist = 0.0;
+
+        for( size_t d = 0; d < 3; ++d )
+        {
+            twist += std::pow( 0.25 * ( corners[0][d] - corners[1][d] + corners[2][d] - corners[3][d] ), 2 );
+        }
+
+        auto deviation = [&]( const SurfacePoint& point, double predicted[3] )
+        {
+            double distance = 0.0;
+
+            for( size_t d = 0; d < 3; ++d )
+            {
+                distance += ( point[d] - predicted[d] ) * ( point[d] - predicted[d] );
+            }
+
+            return std::sqrt( distance );
+        };
+
+        for( size_t iEdge = 0; iEdge < 4; ++iEdge )
+        {
+            double predicted[3];
+
+            for( size_t d = 0; d < 3; ++d )
+            {
+                predicted[d] = 0.5 * ( corners[iEdge][d] + corners[( iEdge + 1 ) % 4][d] );
+            }
+
+            error = std::max( error, deviation( edges[iEdge], predicted ) );
+        }
+
+        double predicted[3];
+
+        for( size_t d = 0; d < 3; ++d )
+        {
+            predicted[d] = 0.25 * ( corners[0][d] + corners[1][d] + corners[2][d] + corners[3][d] );
+        }
+
+        error = std::max( error, deviation( center, predicted ) ) + std::sqrt( twist );
+
+        if( error <= chordTolerance_ || depth == maximumDepth_ )
+        {
+            leaves.push_back( { r0, r1, s0, s1, { center, -1 } } );
+
+            addVertex( r0, s0, corners[0] );
+            addVertex( r1, s0, corners[1] );
+            addVertex( r1, s1, corners[2] );
+            addVertex( r0, s1, corners[3] );
+
+            return;
+        }
+
+        subdivide( r0, rm, s0, sm, { corners[0], edges[0], center, edges[3] }, depth + 1, leaves );
+        subdivide( rm, r1, s0, sm, { edges[0], corners[1], edges[1], center }, depth + 1, leaves );
+        subdivide( rm, r1, sm, s1, { center, edges[1], corners[2], edges[2] }, depth + 1, leaves );
+        subdivide( r0, rm, sm, s1, { edges[3], center, edges[2], corners[3] }, depth + 1, leaves );
+    }
+
+    void addVertex( double r, double s, const SurfacePoint& point )
+    {
+        auto result = verticesRS_.emplace( std::array<double, 2> { r, s }, SurfaceVertex { point, -1 } );
+
+        if( result.second )
+        {
+            verticesSR_.emplace( std::array<double, 2> { s, r }, &result.first->second );
+        }
+    }
+
+    // Two triangles per quad, or a fan around the center if there are hanging vertices on its edges
+    template<typename Callback>
+    void triangulate( std::vector<ParameterQuad>& leaves, Callback&& callback )
+    {
+        std::vector<SurfaceVertex*> boundary;
+
+        for( auto& quad : leaves )
+        {
+            boundary.clear( );
+
+            // Corners of all leaves on the edges in counterclockwise order starting at (r0, s0),
+            // without the end of each edge
+            for( auto vertex = verticesSR_.lower_bound( { quad.s0, quad.r0 } ); vertex->first[1] < quad.r1; ++vertex )
+            {
+                boundary.push_back( vertex->second );
+            }
+
+            for( auto vertex = verticesRS_.lower_bound( { quad.r1, quad.s0 } ); vertex->first[1] < quad.s1; ++vertex )
+            {
+                boundary.push_back( &vertex->second );
+            }
+
+            for( auto vertex = std::map<std::array<double, 2>, SurfaceVertex*>::reverse_iterator(
+                     verticesSR_.upper_bound( { quad.s1, quad.r1 } ) ); vertex->first[1] > quad.r0; ++vertex )
+            {
+                boundary.push_back( vertex->second );
+            }
+
+            for( auto vertex = std::map<std::array<double, 2>, SurfaceVertex>::reverse_iterator(
+                     verticesRS_.upper_bound( { quad.r0, quad.s1 } ) ); vertex->first[1] > quad.s0; ++vertex )
+            {
+                boundary.push_back( &vertex->second );
+            }
+
+            size_t size = boundary.size( );
+
+            if( size == 4 )
+            {
+                callback( SurfaceTriangle { boundary[0], boundary[1], boundary[2] } );
+                callback( SurfaceTriangle { boundary[0], boundary[2], boundary[3] } );
+
+                continue;
+            }
+
+            for( size_t k = 0; k < size; ++k )
+            {
+                callback( SurfaceTriangle { &quad.center, boundary[k], boundary[( k + 1 ) % size] } );
+            }
+        }
+    }
+
+    // Remove all vertices with a parameter smaller than r
+    void release( double r )
+    {
+        auto end = verticesRS_.lower_bound( { r, -std::numeric_limits<double>::infinity( ) } );
+
+        for( auto vertex = verticesRS_.begin( ); vertex != end; ++vertex )
+        {
+            verticesSR_.erase( { vertex->first[1], vertex->first[0] } );
+        }
+
+        verticesRS_.erase( verticesRS_.begin( ), end );
+    }
+
+    std::array<KnotVector, 2> knotVectors_;
+
+    const VectorOfMatrices& controlPoints_;
+
+    double chordTolerance_;
+    size_t maximumDepth_;
+
+    // Corners of the leaves sorted by (r, s) and the same vertices sorted by (s, r)
+    std::map<std::array<double, 2>, SurfaceVertex> verticesRS_;
+    std::map<std::array<double, 2>, SurfaceVertex*> verticesSR_;
+};
+
+template<typename T>
+void writeBinary( std::ostream& output, T value )
+{
+    output.write( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+}
+
+} // namespace detail
+
+Polyline tessellateCurve( const CurveEvaluator& curve,
+                          double chordTolerance,
+                          double angleTolerance,
+                          size_t maximumDepth )
+{
+    runtime_check( chordTolerance > 0.0 || angleTolerance > 0.0, "No positive tolerance given." );
+
+    const KnotVector& knotVector = curve.knotVector( );
+
+    size_t numberOfDimensions = curve.numberOfDimensions( );
+
+    detail::CurveTessellator tessellator { curve, chordTolerance, angleTolerance, maximumDepth, numberOfDimensions, { }, { } };
+
+    std::vector<double> P0( numberOfDimensions ), Pm( numberOfDimensions ), P1( numberOfDimensions );
+
+    double t0 = knotVector.elementBegin( 0 );
+
+    curve.evaluate( t0, P0.data( ) );
+
+    tessellator.parameters.push_back( t0 );
+    tessellator.points.insert( tessellator.points.end( ), P0.begin( ), P0.end( ) );
+
+    // The curve is a polynomial within each knot span, so the spans are subdivided separately
+    for( size_t iElement = 0; iElement < knotVector.numberOfElements( ); ++iElement )
+    {
+        double t1 = knotVector.elementEnd( iElement );
+
+        curve.evaluate( 0.5 * ( t0 + t1 ), Pm.data( ) );
+        curve.evaluate( t1, P1.data( ) );
+
+        tessellator.subdivide( t0, t1, P0, Pm, P1, 0 );
+
+        t0 = t1;
+        P0 = P1;
+    }
+
+    Polyline polyline;
+
+    size_t numberOfPoints = tessellator.parameters.size( );
+
+    polyline.parameters = std::move( tessellator.parameters );
+    polyline.points.resize( numberOfDimensions, std::vector<double>( numberOfPoints ) );
+
+    for( size_t i = 0; i < numberOfPoints; ++i )
+    {
+        for( size_t d = 0; d < numberOfDimensions; ++d )
+        {
+            polyline.points[d][i] = tessellator.points[i * numberOfDimensions + d];
+        }
+    }
+
+    return polyline;
+}
+
+void tessellateSurface( const std::array<std::vector<double>, 2>& knotVectors,
+                        const VectorOfMatrices& controlPoints,
+                        double chordTolerance,
+                        const TriangleCallback& callback,
+                        size_t maximumDepth )
+{
+    detail::SurfaceTessellator tessellator( knotVectors, controlPoints, chordTolerance, maximumDepth );
+
+    tessellator.tessellate( [&]( const detail::SurfaceTriangle& triangle )
+    {
+        callback( { triangle[0]->point, triangle[1]->point, triangle[2]->point } );
+    } );
+}
+
+size_t writeSurfaceStl( const std::array<std::vector<double>, 2>& knotVectors,
+                        const VectorOfMatrices& controlPoints,
+                        double chordTolerance,
+                        std::ostream& output,
+                        size_t maximumDepth )
+{
+    detail::SurfaceTessellator tessellator( knotVectors, controlPoints, chordTolerance, maximumDepth );
+
+    std::string header( "Binary STL of a B-Spline surface" );
+
+    header.resize( 80, ' ' );
+
+    output.write( header.data( ), header.size( ) );
+
+    auto countPosition = output.tellp( );
+
+    detail::writeBinary<std::uint32_t>( output, 0 );
+
+    size_t numberOfTriangles = 0;
+
+    tessellator.tessellate( [&]( const detail::SurfaceTriangle& triangle )
+    {
+        std::array<double, 3> u, v, normal;
+
+        for( size_t d = 0; d < 3; ++d )
+        {
+            u[d] = triangle[1]->point[d] - triangle[0]->point[d];
+            v[d] = triangle[2]->point[d] - triangle[0]->point[d];
+        }
+
+        normal = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+
+        double length = std::sqrt( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] );
+
+        for( size_t d = 0; d < 3; ++d )
+        {
+            detail::writeBinary<float>( output, static_cast<float>( length > 0.0 ? normal[d] / length : 0.0 ) );
+        }
+
+        for( const auto* vertex : triangle )
+        {
+            for( size_t d = 0; d < 3; ++d )
+            {
+                detail::writeBinary<float>( output, static_cast<float>( vertex->point[d] ) );
+            }
+        }
+
+        detail::writeBinary<std::uint16_t>( output, 0 );
+
+        numberOfTriangles++;
+    } );
+
+    auto endPosition = output.tellp( );
+
+    output.seekp( countPosition );
+
+    detail::writeBinary<std::uint32_t>( output, static_cast<std::uint32_t>( numberOfTriangles ) );
+
+    output.seekp( endPosition );
+
+    runtime_check( output.good( ), "Writing STL file failed." );
+
+    return numberOfTriangles;
+}
+
+size_t writeSurfacePly( const std::array<std::vector<double>, 2>& knotVectors,
+                        const VectorOfMatrices& controlPoints,
+                        double chordTolerance,
+                        std::ostream& output,
+                        size_t maximumDepth )
+{
+    detail::SurfaceTessellator tessellator( knotVectors, controlPoints, chordTolerance, maximumDepth );
+
+    // Fixed width counts, such that the header can be rewritten once they are known
+    auto header = []( size_t numberOfVertices, size_t numberOfFaces )
+    {
+        std::ostringstream stream;
+
+        stream << "ply\nformat binary_little_endian 1.0\n"
+               << "element vertex " << std::setw( 10 ) << std::setfill( '0' ) << numberOfVertices << "\n"
+               << "property float x\nproperty float y\nproperty float z\n"
+               << "element face " << std::setw( 10 ) << std::setfill( '0' ) << numberOfFaces << "\n"
+               << "property list uchar int vertex_indices\nend_header\n";
+
+        return stream.str( );
+    };
+
+    auto headerPosition = output.tellp( );
+
+    output << header( 0, 0 );
+
+    std::int64_t numberOfVertices = 0;
+
+    // PLY stores all faces after the vertices, so only the indices of the faces are kept
+    std::vector<std::array<std::int32_t, 3>> faces;
+
+    tessellator.tessellate( [&]( const detail::SurfaceTriangle& triangle )
+    {
+        std::array<std::int32_t, 3> face;
+
+        for( size_t k = 0; k < 3; ++k )
+        {
+            detail::SurfaceVertex& vertex = *triangle[k];
+
+            if( vertex.index < 0 )
+            {
+                runtime_check( numberOfVertices < std::numeric_limits<std::int32_t>::max( ), "Too many vertices for PLY file." );
+
+                for( double value : vertex.point )
+                {
+                    detail::writeBinary<float>( output, static_cast<float>( value ) );
+                }
+
+                vertex.index = numberOfVertices++;
+            }
+
+            face[k] = static_cast<std::int32_t>( vertex.index );
+        }
+
+        faces.push_back( face );
+    } );
+
+    for( const auto& face : faces )
+    {
+        detail::writeBinary<std::uint8_t>( output, 3 );
+
+        for( std::int32_t index : face )
+        {
+            detail::writeBinary<std::int32_t>( output, index );
+        }
+    }
+
+    auto endPosition = output.tellp( );
+
+    output.seekp( headerPosition );
+    output << header( static_cast<size_t>( numberOfVertices ), faces.size( ) );
+    output.seekp( endPosition );
+
+    runtime_check( output.good( ), "Writing PLY file failed." );
+
+    return faces.size( );
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -1,5 +1,9 @@
 #include "utilities.hpp"
 #include <stdexcept>
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
 
 namespace cie
 {
@@ -14,5 +18,80 @@ void runtime_check(bool result, const char message[])
     }
 }
 
+size_t defaultNumberOfThreads( )
+{
+    return std::max( static_cast<size_t>( std::thread::hardware_concurrency( ) ), size_t { 1 } );
+}
+
+void parallelFor( size_t size,
+                  size_t numberOfThreads,
+                  const std::function<void( size_t begin, size_t end )>& body )
+{
+    if( numberOfThreads == 0 )
+    {
+        numberOfThreads = defaultNumberOfThreads( );
+    }
+
+    numberOfThreads = std::max( std::min( numberOfThreads, size ), size_t { 1 } );
+
+    if( numberOfThreads == 1 )
+    {
+        body( 0, size );
+
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> exceptions( numberOfThreads );
+
+    // The calling thread does the first chunk itself
+    auto chunk = [&]( size_t iThread )
+    {
+        try
+        {
+            body( iThread * size / numberOfThreads, ( iThread + 1 ) * size / numberOfThreads );
+        }
+        catch( ... )
+        {
+            exceptions[iThread] = std::current_exception( );
+        }
+    };
+
+    auto joinAll = [&]( )
+    {
+        for( auto& thread : threads )
+        {
+            thread.join( );
+        }
+    };
+
+    // Destroying a joinable thread terminates, so the started ones are joined if spawning fails
+    try
+    {
+        for( size_t iThread = 1; iThread < numberOfThreads; ++iThread )
+        {
+            threads.emplace_back( chunk, iThread );
+        }
+    }
+    catch( ... )
+    {
+        joinAll( );
+
+        throw;
+    }
+
+    chunk( 0 );
+
+    joinAll( );
+
+    for( const auto& exception : exceptions )
+    {
+        if( exception )
+        {
+            std::rethrow_exception( exception );
+        }
+    }
+}
+
 } // namespace splinekernel
-} // namespace cie
\ No newline at end of file
+} // namespace cie
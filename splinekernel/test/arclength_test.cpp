@@ -0,0 +1,115 @@
+#include "catch.hpp"
+#include "arclength.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+TEST_CASE( "ArcLengthTable_straight_test" )
+{
+    // Collinear but unevenly spaced control points: the parametrization is not uniform in length
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.5, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 0.5, 2.0, 2.5, 3.0, 4.0 };
+    std::vector<double> y{ 0.0, 1.0, 4.0, 5.0, 6.0, 8.0 };
+
+    CurveEvaluator curve( knotVector, { x, y } );
+
+    ArcLengthTable table( curve );
+
+    double length = std::sqrt( 80.0 );
+
+    CHECK( table.length( ) == Approx( length ).epsilon( 1e-12 ) );
+    CHECK( table.breakpoints( ).size( ) == 3 * 4 + 1 );
+    CHECK( table.arcLengths( ).size( ) == table.breakpoints( ).size( ) );
+
+    std::vector<double> parameters;
+
+    REQUIRE_NOTHROW( parameters = table.uniformParameters( 11 ) );
+
+    REQUIRE( parameters.size( ) == 11 );
+
+    auto points = curve.evaluate( parameters );
+
+    for( size_t i = 0; i < parameters.size( ); ++i )
+    {
+        double distance = std::sqrt( points[0][i] * points[0][i] + points[1][i] * points[1][i] );
+
+        CHECK( distance == Approx( i * length / 10.0 ).margin( 1e-10 ) );
+    }
+
+    CHECK( parameters.front( ) == 0.0 );
+    CHECK( parameters.back( ) == 1.0 );
+
+    CHECK_THROWS( table.parameter( -1.0 ) );
+    CHECK_THROWS( table.parameter( 2.0 * length ) );
+    CHECK_THROWS( table.arcLength( 1.5 ) );
+    CHECK_THROWS( table.uniformParameters( 1 ) );
+    CHECK_THROWS( ArcLengthTable( curve, 0 ) );
+}
+
+TEST_CASE( "ArcLengthTable_curved_test" )
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.2, 0.3, 0.5, 0.7, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.5, 3.0, 2.0, 1.5, 0.5, -1.0 };
+    std::vector<double> y{ 0.0, 2.0, 1.0, -1.0, 0.5, 3.0, 2.0, 0.0 };
+    std::vector<double> z{ 0.0, 0.5, 1.0, 1.0, 0.0, -0.5, 0.0, 1.0 };
+
+    CurveEvaluator curve( knotVector, { x, y, z } );
+
+    ArcLengthTable table( curve, 4, 8 );
+
+    // Reference length from a fine polyline
+    size_t numberOfSamples = 100001;
+
+    std::vector<double> t( numberOfSamples );
+
+    for( size_t i = 0; i < numberOfSamples; ++i )
+    {
+        t[i] = i / ( numberOfSamples - 1.0 );
+    }
+
+    auto points = curve.evaluate( t );
+
+    double polylineLength = 0.0;
+
+    for( size_t i = 0; i + 1 < numberOfSamples; ++i )
+    {
+        double dx = points[0][i + 1] - points[0][i];
+        double dy = points[1][i + 1] - points[1][i];
+        double dz = points[2][i + 1] - points[2][i];
+
+        polylineLength += std::sqrt( dx * dx + dy * dy + dz * dz );
+    }
+
+    CHECK( table.length( ) == Approx( polylineLength ).epsilon( 1e-7 ) );
+
+    // Forward and inverse lookups are consistent
+    std::vector<double> arcLengths;
+
+    for( double s = 0.0; s <= table.length( ); s += 0.137 )
+    {
+        arcLengths.push_back( s );
+    }
+
+    auto parameters = table.parameters( arcLengths );
+
+    REQUIRE( parameters.size( ) == arcLengths.size( ) );
+
+    for( size_t i = 0; i < arcLengths.size( ); ++i )
+    {
+        CHECK( table.arcLength( parameters[i] ) == Approx( arcLengths[i] ).margin( 1e-10 ) );
+        CHECK( table.parameter( arcLengths[i] ) == parameters[i] );
+    }
+
+    for( double tValue : { 0.0, 0.1, 0.2, 0.45, 0.99, 1.0 } )
+    {
+        CHECK( table.parameter( table.arcLength( tValue ) ) == Approx( tValue ).margin( 1e-10 ) );
+    }
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -1,6 +1,8 @@
 #include "catch.hpp"
 #include "basisfunctions.hpp" 
 #include <vector>
+#include <algorithm>
+#include <cmath>
 
 namespace cie
 {
@@ -84,5 +86,257 @@ TEST_CASE("Quadratic C1 interpolation")
   CHECK(evaluateBSplineBasis(1.00, 3, p, knotVector) == Approx(1.0));
 }
 
+TEST_CASE("Knot span index")
+{
+  std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.5, 0.5, 0.75, 1.0, 1.0, 1.0 };
+
+  const size_t p = 2;
+
+  CHECK(findKnotSpanIndex(0.00, p, knotVector) == 2);
+  CHECK(findKnotSpanIndex(0.25, p, knotVector) == 2);
+  CHECK(findKnotSpanIndex(0.50, p, knotVector) == 4);
+  CHECK(findKnotSpanIndex(0.60, p, knotVector) == 4);
+  CHECK(findKnotSpanIndex(0.75, p, knotVector) == 5);
+  CHECK(findKnotSpanIndex(1.00, p, knotVector) == 5);
+
+  CHECK_THROWS(findKnotSpanIndex(0.5, 4, knotVector));
+}
+
+TEST_CASE("Active basis functions")
+{
+  std::vector<std::vector<double>> knotVectors
+  {
+    { 0.0, 0.0, 0.5, 1.0, 1.0 },
+    { 0.0, 0.0, 0.0, 0.5, 1.0, 1.0, 1.0 },
+    { 0.0, 0.0, 0.0, 0.0, 0.2, 0.2, 0.7, 1.0, 1.0, 1.0, 1.0 },
+    { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.1, 0.3, 0.6, 0.6, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 }
+  };
+
+  std::vector<size_t> degrees{ 1, 2, 3, 5 };
+
+  for (size_t iCase = 0; iCase < knotVectors.size(); ++iCase)
+  {
+    const auto& knotVector = knotVectors[iCase];
+
+    size_t p = degrees[iCase];
+    size_t n = knotVector.size() - p - 1;
+
+    std::vector<double> N(p + 1);
+
+    for (double t = 0.0; t <= 1.0 + 1e-10; t += 0.05)
+    {
+      size_t span = findKnotSpanIndex(t, p, knotVector);
+
+      REQUIRE(span >= p);
+      REQUIRE(span < n);
+
+      REQUIRE_NOTHROW(evaluateActiveBSplineBasis(t, span, p, knotVector, N.data()));
+
+      double sum = 0.0;
+
+      for (size_t i = 0; i < n; ++i)
+      {
+        double expected = evaluateBSplineBasis(std::min(t, 1.0), i, p, knotVector);
+
+        if (i + p >= span && i <= span)
+        {
+          CHECK(N[i + p - span] == Approx(expected).margin(1e-12));
+
+          sum += N[i + p - span];
+        }
+        else
+        {
+          CHECK(expected == Approx(0.0).margin(1e-12));
+        }
+      }
+
+      CHECK(sum == Approx(1.0));
+    }
+  }
+}
+
+TEST_CASE("Active basis function derivatives")
+{
+  // Bernstein polynomials of degree 2 and 3
+  std::vector<double> knotVector2{ 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 };
+  std::vector<double> knotVector3{ 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0 };
+
+  std::vector<double> D2(4 * 3), D3(4 * 4);
+
+  for (double t : { 0.0, 0.3, 0.8, 1.0 })
+  {
+    REQUIRE_NOTHROW(evaluateActiveBSplineDerivatives(t, 2, 2, knotVector2, 3, D2.data()));
+    REQUIRE_NOTHROW(evaluateActiveBSplineDerivatives(t, 3, 3, knotVector3, 3, D3.data()));
+
+    double s = 1.0 - t;
+
+    std::vector<double> expected2
+    {
+      s * s, 2.0 * t * s, t * t,
+      -2.0 * s, 2.0 - 4.0 * t, 2.0 * t,
+      2.0, -4.0, 2.0,
+      0.0, 0.0, 0.0
+    };
+
+    std::vector<double> expected3
+    {
+      s * s * s, 3.0 * t * s * s, 3.0 * t * t * s, t * t * t,
+      -3.0 * s * s, 3.0 * s * s - 6.0 * t * s, 6.0 * t * s - 3.0 * t * t, 3.0 * t * t,
+      6.0 * s, 18.0 * t - 12.0, 6.0 - 18.0 * t, 6.0 * t,
+      -6.0, 18.0, -18.0, 6.0
+    };
+
+    for (size_t i = 0; i < expected2.size(); ++i)
+    {
+      CHECK(D2[i] == Approx(expected2[i]).margin(1e-12));
+    }
+
+    for (size_t i = 0; i < expected3.size(); ++i)
+    {
+      CHECK(D3[i] == Approx(expected3[i]).margin(1e-12));
+    }
+  }
+
+  // Non-uniform knot vector: compare to finite differences of the previous order
+  std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.2, 0.2, 0.7, 1.0, 1.0, 1.0, 1.0 };
+
+  const size_t p = 3;
+  const double h = 1e-6;
+
+  std::vector<double> D(3 * (p + 1)), Dleft(3 * (p + 1)), Dright(3 * (p + 1));
+
+  for (double t : { 0.1, 0.35, 0.5, 0.85 })
+  {
+    size_t span = findKnotSpanIndex(t, p, knotVector);
+
+    evaluateActiveBSplineDerivatives(t, span, p, knotVector, 2, D.data());
+    evaluateActiveBSplineDerivatives(t - h, span, p, knotVector, 2, Dleft.data());
+    evaluateActiveBSplineDerivatives(t + h, span, p, knotVector, 2, Dright.data());
+
+    for (size_t k = 1; k <= 2; ++k)
+    {
+      for (size_t i = 0; i <= p; ++i)
+      {
+        double finiteDifference = (Dright[(k - 1) * (p + 1) + i] - Dleft[(k - 1) * (p + 1) + i]) / (2.0 * h);
+
+        CHECK(D[k * (p + 1) + i] == Approx(finiteDifference).epsilon(1e-6).margin(1e-6));
+      }
+    }
+
+    for (size_t i = 0; i <= p; ++i)
+    {
+      CHECK(D[(p + 1) + i] == Approx(evaluateBSplineDerivative(t, span - p + i, p, knotVector, 1)));
+      CHECK(D[2 * (p + 1) + i] == Approx(evaluateBSplineDerivative(t, span - p + i, p, knotVector, 2)));
+    }
+  }
+
+  CHECK(evaluateBSplineDerivative(0.5, 0, p, knotVector, 2) == 0.0);
+  CHECK_THROWS(evaluateBSplineDerivative(0.5, 0, 0, knotVector, 1));
+}
+
+TEST_CASE("Derivatives on non-open knot vector")
+{
+  // Uniform quadratic B-Splines with the parameter range [t_p, t_n] = [2, 3]
+  std::vector<double> knotVector{ 0.0, 1.0, 2.0, 3.0, 4.0, 5.0 };
+
+  const size_t p = 2;
+  const double h = 1e-6;
+
+  CHECK(evaluateBSplineDerivative(0.5, 0, p, knotVector, 1) == Approx(0.5));
+  CHECK(evaluateBSplineDerivative(1.5, 0, p, knotVector, 1) == Approx(0.0).margin(1e-12));
+  CHECK(evaluateBSplineDerivative(1.5, 1, p, knotVector, 1) == Approx(0.5));
+  CHECK(evaluateBSplineDerivative(4.5, 0, p, knotVector, 1) == Approx(0.0).margin(1e-12));
+  CHECK(evaluateBSplineDerivative(4.5, 2, p, knotVector, 1) == Approx(-0.5));
+
+  for (double t : { 0.3, 0.5, 1.2, 1.5, 2.5, 2.8, 3.5, 4.1, 4.5 })
+  {
+    for (size_t i = 0; i < 3; ++i)
+    {
+      double finiteDifference1 = (evaluateBSplineBasis(t + h, i, p, knotVector) - 
+                                  evaluateBSplineBasis(t - h, i, p, knotVector)) / (2.0 * h);
+
+      double finiteDifference2 = (evaluateBSplineDerivative(t + h, i, p, knotVector, 1) - 
+                                  evaluateBSplineDerivative(t - h, i, p, knotVector, 1)) / (2.0 * h);
+
+      CHECK(evaluateBSplineDerivative(t, i, p, knotVector, 1) == Approx(finiteDifference1).epsilon(1e-6).margin(1e-6));
+      CHECK(evaluateBSplineDerivative(t, i, p, knotVector, 2) == Approx(finiteDifference2).epsilon(1e-6).margin(1e-6));
+      CHECK(evaluateBSplineDerivative(t, i, p, knotVector, 3) == 0.0);
+    }
+  }
+}
+
+TEST_CASE("Batched active basis functions")
+{
+  KnotVector knotVector({ 0.0, 0.0, 0.0, 0.0, 0.1, 0.3, 0.3, 0.6, 1.0, 1.0, 1.0, 1.0 }, 3);
+
+  const size_t p = 3;
+
+  // Unsorted points with more than batchLaneWidth points in some spans
+  std::vector<double> t;
+
+  for (size_t i = 0; i < 57; ++i)
+  {
+    t.push_back(std::fmod(i * 0.377, 1.0));
+  }
+
+  t.push_back(0.0);
+  t.push_back(1.0);
+  t.push_back(0.3);
+
+  std::vector<size_t> spans(t.size());
+  std::vector<double> N(t.size() * (p + 1)), expected(p + 1);
+
+  REQUIRE_NOTHROW(evaluateActiveBSplineBasisBatch(t.data(), t.size(), knotVector, spans.data(), N.data()));
+
+  for (size_t i = 0; i < t.size(); ++i)
+  {
+    REQUIRE(spans[i] == findKnotSpanIndex(t[i], p, knotVector.knots()));
+
+    evaluateActiveBSplineBasis(t[i], spans[i], p, knotVector.knots(), expected.data());
+
+    for (size_t a = 0; a <= p; ++a)
+    {
+      CHECK(N[i * (p + 1) + a] == Approx(expected[a]).margin(1e-14));
+    }
+  }
+
+  // Empty input
+  CHECK_NOTHROW(evaluateActiveBSplineBasisBatch(t.data(), 0, knotVector, spans.data(), N.data()));
+}
+
+TEST_CASE("Single precision active basis functions")
+{
+  KnotVector knotVector({ 0.0, 0.0, 0.0, 0.0, 0.1, 0.3, 0.3, 0.6, 1.0, 1.0, 1.0, 1.0 }, 3);
+
+  const size_t p = 3;
+
+  std::vector<float> t;
+
+  for (size_t i = 0; i < 41; ++i)
+  {
+    t.push_back(static_cast<float>(std::fmod(i * 0.377, 1.0)));
+  }
+
+  std::vector<size_t> spans(t.size());
+  std::vector<float> N(t.size() * (p + 1)), derivatives(2 * (p + 1));
+  std::vector<double> expected(2 * (p + 1));
+
+  REQUIRE_NOTHROW(evaluateActiveBSplineBasisBatch(t.data(), t.size(), knotVector, spans.data(), N.data()));
+
+  for (size_t i = 0; i < t.size(); ++i)
+  {
+    // Reference in double precision at the same (rounded) parameter
+    evaluateActiveBSplineDerivatives(static_cast<double>(t[i]), spans[i], p, knotVector.knots(), 1, expected.data());
+    evaluateActiveBSplineDerivatives(t[i], spans[i], p, knotVector.knots(), 1, derivatives.data());
+
+    for (size_t a = 0; a <= p; ++a)
+    {
+      CHECK(N[i * (p + 1) + a] == Approx(expected[a]).margin(1e-6));
+      CHECK(derivatives[a] == Approx(expected[a]).margin(1e-6));
+      CHECK(derivatives[p + 1 + a] == Approx(expected[p + 1 + a]).epsilon(1e-5).margin(1e-4));
+    }
+  }
+}
+
 } // splinekernel
 } // cie
@@ -0,0 +1,96 @@
+#include "catch.hpp"
+#include "bezierextraction.hpp"
+#include "basisfunctions.hpp"
+
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+TEST_CASE( "evaluateBernsteinBasis_test" )
+{
+    std::vector<double> B( 3 * 3 );
+
+    REQUIRE_NOTHROW( evaluateBernsteinBasis( 0.5, 2, 2, B.data( ) ) );
+
+    // B_0 = (1 - xi)^2 / 4, B_1 = (1 - xi^2) / 2, B_2 = (1 + xi)^2 / 4
+    CHECK( B[0] == Approx( 0.0625 ) );
+    CHECK( B[1] == Approx( 0.375 ) );
+    CHECK( B[2] == Approx( 0.5625 ) );
+
+    CHECK( B[3] == Approx( -0.25 ) );
+    CHECK( B[4] == Approx( -0.5 ) );
+    CHECK( B[5] == Approx( 0.75 ) );
+
+    CHECK( B[6] == Approx( 0.5 ) );
+    CHECK( B[7] == Approx( -1.0 ) );
+    CHECK( B[8] == Approx( 0.5 ) );
+}
+
+TEST_CASE( "bezierExtractionOperators_test" )
+{
+    // Uniform quadratic: C_0 = [1 0 0; 0 1 1/2; 0 0 1/2], middle elements [1/2 1/2 0; 1/2 1 1/2; 0 0 1/2]
+    KnotVector uniform( { 0.0, 0.0, 0.0, 1.0, 2.0, 3.0, 3.0, 3.0 }, 2 );
+
+    std::vector<linalg::Matrix> operators;
+
+    REQUIRE_NOTHROW( operators = bezierExtractionOperators( uniform ) );
+
+    REQUIRE( operators.size( ) == 3 );
+
+    std::vector<std::vector<double>> expectedFirst { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.5 }, { 0.0, 0.0, 0.5 } };
+    std::vector<std::vector<double>> expectedSecond { { 0.5, 0.0, 0.0 }, { 0.5, 1.0, 0.5 }, { 0.0, 0.0, 0.5 } };
+
+    for( size_t a = 0; a < 3; ++a )
+    {
+        for( size_t b = 0; b < 3; ++b )
+        {
+            CHECK( operators[0]( a, b ) == Approx( expectedFirst[a][b] ).margin( 1e-12 ) );
+            CHECK( operators[1]( a, b ) == Approx( expectedSecond[a][b] ).margin( 1e-12 ) );
+            CHECK( operators[2]( 2 - a, 2 - b ) == Approx( expectedFirst[a][b] ).margin( 1e-12 ) );
+        }
+    }
+
+    // Non-uniform cubic with a repeated knot: extraction reproduces the recursive evaluation
+    KnotVector knotVector( { 0.0, 0.0, 0.0, 0.0, 0.2, 0.5, 0.5, 0.9, 1.0, 1.0, 1.0, 1.0 }, 3 );
+
+    operators = bezierExtractionOperators( knotVector );
+
+    REQUIRE( operators.size( ) == knotVector.numberOfElements( ) );
+
+    std::vector<double> bernstein( 2 * 4 ), extracted( 2 * 4 ), expected( 2 * 4 );
+
+    for( size_t iElement = 0; iElement < knotVector.numberOfElements( ); ++iElement )
+    {
+        double begin = knotVector.elementBegin( iElement );
+        double end = knotVector.elementEnd( iElement );
+
+        for( double xi : { -1.0, -0.3, 0.4, 1.0 } )
+        {
+            double t = begin + ( xi + 1.0 ) / 2.0 * ( end - begin );
+
+            evaluateBernsteinBasis( xi, 3, 1, bernstein.data( ) );
+
+            for( size_t a = 4; a < 8; ++a )
+            {
+                bernstein[a] *= 2.0 / ( end - begin );
+            }
+
+            applyExtractionOperator( operators[iElement], bernstein.data( ), 2, extracted.data( ) );
+
+            evaluateActiveBSplineDerivatives( t, knotVector.spanIndex( iElement ), 3, knotVector.knots( ), 1, expected.data( ) );
+
+            for( size_t a = 0; a < 8; ++a )
+            {
+                CHECK( extracted[a] == Approx( expected[a] ).margin( 1e-12 ) );
+            }
+        }
+    }
+
+    CHECK_THROWS( bezierExtractionOperators( KnotVector( { 0.0, 0.0, 1.0, 2.0, 3.0, 3.0 }, 2 ) ) );
+}
+
+} // namespace splinekernel
+} // namespace cie
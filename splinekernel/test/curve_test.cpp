@@ -1,7 +1,9 @@
 #include "catch.hpp"
 #include "curve.hpp"
+#include "basisfunctions.hpp"
 
 #include <array>
+#include <cmath>
 #include <vector>
 
 namespace cie
@@ -49,5 +51,335 @@ TEST_CASE("Linear interpolation curve")
     CHECK( C[1][10] == Approx( 3.0 ) );
 }
 
+TEST_CASE("Curve outside of knot vector")
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.5, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.0, 3.0 };
+    std::vector<double> y{ 0.0, 1.0, -1.0, 1.0 };
+    std::vector<double> t{ -0.1, 0.0, 1.0, 1.1 };
+
+    std::array<std::vector<double>, 2> C;
+
+    REQUIRE_NOTHROW( C = evaluate2DCurve( t, x, y, knotVector ) );
+
+    // All basis functions vanish outside of [0, 1], the end points interpolate the control points
+    CHECK( C[0][0] == 0.0 );
+    CHECK( C[1][0] == 0.0 );
+    CHECK( C[0][1] == Approx( 0.0 ) );
+    CHECK( C[1][1] == Approx( 0.0 ) );
+    CHECK( C[0][2] == Approx( 3.0 ) );
+    CHECK( C[1][2] == Approx( 1.0 ) );
+    CHECK( C[0][3] == 0.0 );
+    CHECK( C[1][3] == 0.0 );
+}
+
+TEST_CASE("Curve on knot vector that is not open")
+{
+    std::vector<double> knotVector{ 0.0, 1.0, 2.0, 3.0, 4.0, 5.0 };
+    std::vector<double> x{ 1.0, 2.0, 3.0 };
+    std::vector<double> y{ 0.0, 1.0, 0.0 };
+    std::vector<double> t{ -0.5, 0.5, 1.5, 2.5, 3.5, 4.5, 5.5 };
+
+    std::array<std::vector<double>, 2> C;
+
+    REQUIRE_NOTHROW( C = evaluate2DCurve( t, x, y, knotVector ) );
+
+    // Sum of all basis functions times control points, also outside of [t_p, t_n] = [2, 3]
+    for( size_t j = 0; j < t.size( ); ++j )
+    {
+        double expectedX = 0.0, expectedY = 0.0;
+
+        for( size_t i = 0; i < x.size( ); ++i )
+        {
+            expectedX += evaluateBSplineBasis( t[j], i, 2, knotVector ) * x[i];
+            expectedY += evaluateBSplineBasis( t[j], i, 2, knotVector ) * y[i];
+        }
+
+        CHECK( C[0][j] == Approx( expectedX ).margin( 1e-14 ) );
+        CHECK( C[1][j] == Approx( expectedY ).margin( 1e-14 ) );
+    }
+
+    CHECK( C[0][1] == Approx( 0.125 ) );
+    CHECK( C[0][5] == Approx( 0.375 ) );
+    CHECK( C[0][0] == 0.0 );
+    CHECK( C[0][6] == 0.0 );
+}
+
+TEST_CASE("Single precision curve")
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.5, 0.5, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.5, 3.0, 2.0, 1.5, 0.0 };
+    std::vector<double> y{ 0.0, 2.0, 1.0, -1.0, 0.5, 3.0, 2.0 };
+
+    std::vector<double> t;
+
+    for( size_t i = 0; i <= 40; ++i )
+    {
+        t.push_back( i / 40.0 );
+    }
+
+    std::vector<float> tFloat( t.begin( ), t.end( ) );
+    std::vector<float> xFloat( x.begin( ), x.end( ) );
+    std::vector<float> yFloat( y.begin( ), y.end( ) );
+
+    std::array<std::vector<float>, 2> C;
+
+    REQUIRE_NOTHROW( C = evaluate2DCurve( tFloat, xFloat, yFloat, knotVector ) );
+
+    auto expected = evaluate2DCurve( t, x, y, knotVector );
+
+    REQUIRE( C[0].size( ) == t.size( ) );
+
+    for( size_t i = 0; i < t.size( ); ++i )
+    {
+        CHECK( C[0][i] == Approx( expected[0][i] ).margin( 1e-5 ) );
+        CHECK( C[1][i] == Approx( expected[1][i] ).margin( 1e-5 ) );
+    }
+}
+
+TEST_CASE("CurveEvaluator")
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.5, 0.5, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.5, 3.0, 2.0, 1.5, 0.0 };
+    std::vector<double> y{ 0.0, 2.0, 1.0, -1.0, 0.5, 3.0, 2.0 };
+    std::vector<double> z{ 1.0, 1.0, 0.0, 0.5, 2.0, 2.0, 4.0 };
+
+    CurveEvaluator curve( knotVector, { x, y, z } );
+
+    REQUIRE( curve.degree( ) == 3 );
+    REQUIRE( curve.numberOfDimensions( ) == 3 );
+    REQUIRE( curve.numberOfControlPoints( ) == 7 );
+    REQUIRE( curve.controlPoints( ).size( ) == 21 );
+
+    CHECK( curve.controlPoints( )[3 * 2 + 0] == 2.5 );
+    CHECK( curve.controlPoints( )[3 * 4 + 2] == 2.0 );
+
+    std::vector<double> t;
+
+    for( size_t i = 0; i <= 40; ++i )
+    {
+        t.push_back( i / 40.0 );
+    }
+
+    auto expectedXY = evaluate2DCurve( t, x, y, knotVector );
+    auto expectedZ = evaluate2DCurve( t, z, z, knotVector );
+
+    std::vector<std::vector<double>> C;
+
+    REQUIRE_NOTHROW( C = curve.evaluate( t ) );
+
+    REQUIRE( C.size( ) == 3 );
+    REQUIRE( C[0].size( ) == t.size( ) );
+
+    double point[3];
+
+    for( size_t i = 0; i < t.size( ); ++i )
+    {
+        CHECK( C[0][i] == Approx( expectedXY[0][i] ) );
+        CHECK( C[1][i] == Approx( expectedXY[1][i] ) );
+        CHECK( C[2][i] == Approx( expectedZ[0][i] ) );
+
+        curve.evaluate( t[i], point );
+
+        CHECK( point[0] == Approx( C[0][i] ) );
+        CHECK( point[1] == Approx( C[1][i] ) );
+        CHECK( point[2] == Approx( C[2][i] ) );
+    }
+
+    // End derivatives of a clamped curve: p / (t_{p+1} - t_1) * (P_1 - P_0)
+    auto derivatives = curve.evaluateDerivatives( 0.0, 2 );
+
+    REQUIRE( derivatives.size( ) == 3 );
+
+    CHECK( derivatives[0][0] == Approx( 0.0 ) );
+    CHECK( derivatives[1][0] == Approx( 10.0 ) );
+    CHECK( derivatives[1][1] == Approx( 20.0 ) );
+    CHECK( derivatives[1][2] == Approx( 0.0 ).margin( 1e-12 ) );
+
+    // Interior derivatives compared to central differences
+    double h = 1e-6;
+
+    for( double s : { 0.1, 0.42, 0.77 } )
+    {
+        auto d = curve.evaluateDerivatives( s, 1 );
+
+        double plus[3], minus[3];
+
+        curve.evaluate( s + h, plus );
+        curve.evaluate( s - h, minus );
+
+        for( size_t iDimension = 0; iDimension < 3; ++iDimension )
+        {
+            CHECK( d[1][iDimension] == Approx( ( plus[iDimension] - minus[iDimension] ) / ( 2.0 * h ) ).epsilon( 1e-6 ) );
+        }
+    }
+
+    CHECK_THROWS( CurveEvaluator( knotVector, { x, { 1.0, 2.0 } } ) );
+    CHECK_THROWS( CurveEvaluator( knotVector, { } ) );
+    CHECK_THROWS( CurveEvaluator( { 0.0, 1.0 }, { x } ) );
+}
+
+TEST_CASE("CurveSweep")
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.5, 0.5, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.5, 3.0, 2.0, 1.5, 0.0 };
+    std::vector<double> y{ 0.0, 2.0, 1.0, -1.0, 0.5, 3.0, 2.0 };
+
+    CurveEvaluator curve( knotVector, { x, y } );
+    CurveSweep sweep( curve );
+
+    std::vector<double> t;
+
+    for( size_t i = 0; i <= 100; ++i )
+    {
+        t.push_back( i / 100.0 );
+    }
+
+    auto expected = evaluate2DCurve( t, x, y, knotVector );
+
+    // Evaluate in chunks of different sizes into one output buffer
+    std::vector<double> result( 2 * t.size( ) );
+
+    size_t offset = 0;
+
+    for( size_t chunkSize : { 1, 7, 30, 0, 63 } )
+    {
+        REQUIRE_NOTHROW( sweep.evaluate( t.data( ) + offset, chunkSize, result.data( ) + 2 * offset ) );
+
+        offset += chunkSize;
+    }
+
+    REQUIRE( offset == t.size( ) );
+
+    for( size_t i = 0; i < t.size( ); ++i )
+    {
+        CHECK( result[2 * i] == Approx( expected[0][i] ) );
+        CHECK( result[2 * i + 1] == Approx( expected[1][i] ) );
+    }
+
+    CHECK( sweep.span( ) == 6 );
+
+    // Going backwards requires a reset
+    double point[2];
+
+    CHECK_THROWS( sweep.evaluate( t.data( ), 1, point ) );
+
+    sweep.reset( );
+
+    CHECK( sweep.span( ) == 3 );
+
+    REQUIRE_NOTHROW( sweep.evaluate( t.data( ) + 60, 1, point ) );
+
+    CHECK( sweep.span( ) == 6 );
+    CHECK( point[0] == Approx( expected[0][60] ) );
+    CHECK( point[1] == Approx( expected[1][60] ) );
+}
+
+TEST_CASE("Rational quarter circle curve")
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 1.0, 1.0, 0.0 };
+    std::vector<double> y{ 0.0, 1.0, 1.0 };
+    std::vector<double> weights{ 1.0, std::sqrt( 0.5 ), 1.0 };
+    std::vector<double> t{ 0.0, 0.1, 0.25, 0.5, 0.7, 0.9, 1.0 };
+
+    std::array<std::vector<double>, 2> C, dC;
+
+    REQUIRE_NOTHROW( C = evaluate2DRationalCurve( t, x, y, weights, knotVector ) );
+    REQUIRE_NOTHROW( dC = evaluate2DRationalCurveDerivative( t, x, y, weights, knotVector ) );
+
+    REQUIRE( C[0].size( ) == t.size( ) );
+    REQUIRE( dC[1].size( ) == t.size( ) );
+
+    for( size_t i = 0; i < t.size( ); ++i )
+    {
+        // Points lie on the unit circle and the tangent is perpendicular to the radius
+        CHECK( C[0][i] * C[0][i] + C[1][i] * C[1][i] == Approx( 1.0 ) );
+        CHECK( C[0][i] * dC[0][i] + C[1][i] * dC[1][i] == Approx( 0.0 ).margin( 1e-12 ) );
+    }
+
+    CHECK( C[0][3] == Approx( std::sqrt( 0.5 ) ) );
+    CHECK( C[1][3] == Approx( std::sqrt( 0.5 ) ) );
+
+    // End tangents are p / ( t_{p+1} - t_1 ) * w_1 / w_0 * ( P_1 - P_0 )
+    CHECK( dC[0][0] == Approx( 0.0 ).margin( 1e-12 ) );
+    CHECK( dC[1][0] == Approx( std::sqrt( 2.0 ) ) );
+    CHECK( dC[0][6] == Approx( -std::sqrt( 2.0 ) ) );
+    CHECK( dC[1][6] == Approx( 0.0 ).margin( 1e-12 ) );
+
+    // Unit weights reproduce the polynomial curve
+    std::vector<double> unitWeights( 3, 1.0 );
+
+    auto rationalC = evaluate2DRationalCurve( t, x, y, unitWeights, knotVector );
+    auto polynomialC = evaluate2DCurve( t, x, y, knotVector );
+
+    for( size_t i = 0; i < t.size( ); ++i )
+    {
+        CHECK( rationalC[0][i] == Approx( polynomialC[0][i] ) );
+        CHECK( rationalC[1][i] == Approx( polynomialC[1][i] ) );
+    }
+
+    CHECK_THROWS( evaluate2DRationalCurve( t, x, y, { 1.0, 1.0 }, knotVector ) );
+
+    // Outside of the knot vector the curve and its derivative are (0, 0), as for evaluate2DCurve
+    std::vector<double> outside{ -0.5, 1.5 };
+
+    C = evaluate2DRationalCurve( outside, x, y, weights, knotVector );
+    dC = evaluate2DRationalCurveDerivative( outside, x, y, weights, knotVector );
+
+    for( size_t i = 0; i < outside.size( ); ++i )
+    {
+        CHECK( C[0][i] == 0.0 );
+        CHECK( C[1][i] == 0.0 );
+        CHECK( dC[0][i] == 0.0 );
+        CHECK( dC[1][i] == 0.0 );
+    }
+}
+
+TEST_CASE("Rational curve on knot vector that is not open")
+{
+    std::vector<double> knotVector{ 0.0, 1.0, 2.0, 3.0, 4.0, 5.0 };
+    std::vector<double> x{ 1.0, 2.0, 3.0 };
+    std::vector<double> y{ 0.0, 1.0, 0.0 };
+    std::vector<double> weights{ 1.0, 2.0, 0.5 };
+    std::vector<double> t{ -0.5, 0.0, 0.5, 1.5, 2.5, 3.5, 4.5, 5.0, 5.5 };
+
+    std::array<std::vector<double>, 2> C, dC;
+
+    REQUIRE_NOTHROW( C = evaluate2DRationalCurve( t, x, y, weights, knotVector ) );
+    REQUIRE_NOTHROW( dC = evaluate2DRationalCurveDerivative( t, x, y, weights, knotVector ) );
+
+    // Quotient of the weighted sums over all basis functions, (0, 0) where all of them vanish
+    for( size_t j = 0; j < t.size( ); ++j )
+    {
+        double W = 0.0, X = 0.0, Y = 0.0, dW = 0.0, dX = 0.0, dY = 0.0;
+
+        for( size_t i = 0; i < x.size( ); ++i )
+        {
+            double N = evaluateBSplineBasis( t[j], i, 2, knotVector ) * weights[i];
+            double dN = evaluateBSplineDerivative( t[j], i, 2, knotVector, 1 ) * weights[i];
+
+            W += N;
+            X += N * x[i];
+            Y += N * y[i];
+            dW += dN;
+            dX += dN * x[i];
+            dY += dN * y[i];
+        }
+
+        double expectedX = W != 0.0 ? X / W : 0.0;
+        double expectedY = W != 0.0 ? Y / W : 0.0;
+
+        CHECK( C[0][j] == Approx( expectedX ).margin( 1e-12 ) );
+        CHECK( C[1][j] == Approx( expectedY ).margin( 1e-12 ) );
+        CHECK( dC[0][j] == Approx( W != 0.0 ? ( dX - dW * expectedX ) / W : 0.0 ).margin( 1e-12 ) );
+        CHECK( dC[1][j] == Approx( W != 0.0 ? ( dY - dW * expectedY ) / W : 0.0 ).margin( 1e-12 ) );
+    }
+
+    // Only the first control point is active on [0, 1]
+    CHECK( C[0][2] == Approx( 1.0 ) );
+    CHECK( C[0][6] == Approx( 3.0 ) );
+}
+
 } // namespace splinekernel
 } // namespace cie
@@ -0,0 +1,96 @@
+#include "catch.hpp"
+#include "curvefleet.hpp"
+#include "curve.hpp"
+
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+TEST_CASE( "CurveFleet_test" )
+{
+    std::vector<std::vector<double>> knotVectors
+    {
+        { 0.0, 0.0, 0.0, 0.0, 0.3, 0.5, 1.0, 1.0, 1.0, 1.0 },
+        { -1.0, -1.0, 2.0, 2.0 },
+        { 0.0, 0.0, 0.0, 1.0, 1.0, 2.0, 3.0, 3.0, 3.0 }
+    };
+
+    std::vector<std::vector<std::vector<double>>> controlPoints
+    {
+        { { 0.0, 0.5, 2.0, 2.5, 3.0, 4.0 }, { 0.0, 1.0, 4.0, 5.0, 6.0, 8.0 }, { 1.0, 0.0, 1.0, 0.0, 1.0, 0.0 } },
+        { { 1.0, 2.0 }, { 3.0, -3.0 }, { 0.0, 1.0 } },
+        { { 0.0, 1.0, 2.0, 1.0, 0.0, -1.0 }, { 0.0, 0.5, 2.0, 3.0, 2.0, 1.0 }, { 0.0, 0.0, 1.0, 1.0, 2.0, 2.0 } }
+    };
+
+    CurveFleet fleet( 3 );
+
+    for( size_t iCurve = 0; iCurve < knotVectors.size( ); ++iCurve )
+    {
+        REQUIRE( fleet.addCurve( knotVectors[iCurve], controlPoints[iCurve] ) == iCurve );
+    }
+
+    REQUIRE( fleet.numberOfCurves( ) == 3 );
+
+    CHECK( fleet.numberOfDimensions( ) == 3 );
+    CHECK( fleet.degree( 0 ) == 3 );
+    CHECK( fleet.degree( 1 ) == 1 );
+    CHECK( fleet.degree( 2 ) == 2 );
+    CHECK( fleet.lowerBound( 1 ) == -1.0 );
+    CHECK( fleet.upperBound( 2 ) == 3.0 );
+
+    CHECK( fleet.knotOffsets( ) == std::vector<size_t>{ 0, 10, 14, 23 } );
+    CHECK( fleet.controlPointOffsets( ) == std::vector<size_t>{ 0, 6, 8, 14 } );
+    CHECK( fleet.controlPoints( ).size( ) == 14 * 3 );
+
+    // Different numbers of samples per curve, including none
+    std::vector<double> tCoordinates{ 0.0, 0.1, 0.3, 0.75, 1.0, 0.0, 1.0, 2.0, 2.5, 3.0 };
+    std::vector<size_t> sampleOffsets{ 0, 5, 5, 10 };
+
+    std::vector<double> result;
+
+    REQUIRE_NOTHROW( result = fleet.evaluate( tCoordinates, sampleOffsets, 2 ) );
+
+    REQUIRE( result.size( ) == tCoordinates.size( ) * 3 );
+
+    for( size_t iCurve = 0; iCurve < 3; ++iCurve )
+    {
+        CurveEvaluator curve( knotVectors[iCurve], controlPoints[iCurve] );
+
+        for( size_t k = sampleOffsets[iCurve]; k < sampleOffsets[iCurve + 1]; ++k )
+        {
+            auto expected = curve.evaluateDerivatives( tCoordinates[k], 0 )[0];
+
+            for( size_t d = 0; d < 3; ++d )
+            {
+                CHECK( result[k * 3 + d] == Approx( expected[d] ) );
+            }
+        }
+    }
+
+    // Uniform sampling and the packed constructor, independent of the number of threads
+    auto uniform = fleet.evaluateUniform( 7, 1 );
+
+    CurveFleet packed( 3, fleet.knots( ), fleet.knotOffsets( ), fleet.controlPoints( ), fleet.controlPointOffsets( ) );
+
+    CHECK( packed.evaluateUniform( 7, 3 ) == uniform );
+
+    REQUIRE( uniform.size( ) == 3 * 7 * 3 );
+
+    CHECK( uniform[( 7 + 0 ) * 3 + 1] == Approx( 3.0 ) );
+    CHECK( uniform[( 7 + 6 ) * 3 + 1] == Approx( -3.0 ) );
+    CHECK( uniform[( 7 + 3 ) * 3 + 0] == Approx( 1.5 ) );
+
+    CHECK_THROWS( fleet.addCurve( knotVectors[1], { { 1.0, 2.0 }, { 3.0, -3.0 } } ) );
+    CHECK_THROWS( fleet.addCurve( knotVectors[1], { { 1.0, 2.0, 3.0, 4.0 }, { 0.0, 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0, 0.0 } } ) );
+    CHECK_THROWS( fleet.evaluate( tCoordinates, { 0, 5, 10 } ) );
+    CHECK_THROWS( fleet.evaluate( tCoordinates, { 0, 5, 4, 10 } ) );
+    CHECK_THROWS( CurveFleet( 3, fleet.knots( ), { 0, 10, 23 }, fleet.controlPoints( ), fleet.controlPointOffsets( ) ) );
+    CHECK_THROWS( CurveFleet( 3, fleet.knots( ), { 0, 10, 12, 23 }, fleet.controlPoints( ), fleet.controlPointOffsets( ) ) );
+    CHECK_THROWS( CurveFleet( 0 ) );
+}
+
+} // namespace splinekernel
+} // namespace cie
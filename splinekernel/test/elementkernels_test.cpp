@@ -0,0 +1,100 @@
+#include "catch.hpp"
+#include "elementkernels.hpp"
+#include "finiteelements.hpp"
+
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+TEST_CASE( "ElementKernels_basisTable_test" )
+{
+    for( size_t p = 1; p <= maximumFixedDegree + 1; ++p )
+    {
+        auto knots = detail::constructOpenKnotVectors( { 4, 4 }, { p, p }, { p - 1, 0 }, { 2.0, 2.0 }, { -1.0, 0.5 } );
+
+        for( size_t axis = 0; axis < 2; ++axis )
+        {
+            KnotVector knotVector( knots[axis], p );
+
+            size_t element = 2;
+            double begin = knotVector.elementBegin( element );
+            double end = knotVector.elementEnd( element );
+
+            std::vector<double> coordinates { begin, 0.7 * begin + 0.3 * end, 0.5 * ( begin + end ), end };
+
+            BasisFunctionTable expected, computed;
+
+            REQUIRE_NOTHROW( evaluateGenericBasisTable( coordinates, knotVector.spanIndex( element ), knotVector, expected ) );
+            REQUIRE_NOTHROW( selectBasisTableKernel( p )( coordinates, knotVector.spanIndex( element ), knotVector, computed ) );
+
+            REQUIRE( computed.degree == p );
+            REQUIRE( computed.numberOfPoints == coordinates.size( ) );
+            REQUIRE( computed.values.size( ) == expected.values.size( ) );
+            REQUIRE( computed.derivatives.size( ) == expected.derivatives.size( ) );
+
+            for( size_t i = 0; i < expected.values.size( ); ++i )
+            {
+                CHECK( computed.values[i] == Approx( expected.values[i] ).margin( 1e-12 ) );
+                CHECK( computed.derivatives[i] == Approx( expected.derivatives[i] ).margin( 1e-12 ) );
+            }
+        }
+    }
+
+    CHECK( selectBasisTableKernel( maximumFixedDegree + 1 ) == &evaluateGenericBasisTable );
+}
+
+TEST_CASE( "ElementKernels_integrateElement_test" )
+{
+    std::vector<std::array<size_t, 2>> degrees { { 1, 1 }, { 2, 3 }, { 4, 2 }, { 6, 6 }, { 7, 2 } };
+
+    for( auto p : degrees )
+    {
+        auto knots = detail::constructOpenKnotVectors( { 3, 3 }, p, { p[0] - 1, p[1] - 1 }, { 1.0, 2.0 }, { 0.0, 0.0 } );
+
+        KnotVector knotVectorX( knots[0], p[0] ), knotVectorY( knots[1], p[1] );
+
+        std::vector<double> coordinatesX { 0.35, 0.4, 0.6 }, coordinatesY { 0.8, 1.0, 1.2, 1.3 };
+        std::vector<double> weights( 12 ), sourceValues( 12 );
+
+        for( size_t i = 0; i < weights.size( ); ++i )
+        {
+            weights[i] = 0.1 + 0.05 * i;
+            sourceValues[i] = 1.0 - 0.2 * i;
+        }
+
+        BasisFunctionTable tableX, tableY;
+
+        evaluateGenericBasisTable( coordinatesX, knotVectorX.spanIndex( 1 ), knotVectorX, tableX );
+        evaluateGenericBasisTable( coordinatesY, knotVectorY.spanIndex( 1 ), knotVectorY, tableY );
+
+        size_t numberOfElementDofs = ( p[0] + 1 ) * ( p[1] + 1 );
+
+        linalg::Matrix expectedKe( numberOfElementDofs, numberOfElementDofs, 0.0 );
+        linalg::Matrix computedKe( numberOfElementDofs, numberOfElementDofs, 0.0 );
+
+        std::vector<double> expectedFe( numberOfElementDofs, 0.0 ), computedFe( numberOfElementDofs, 0.0 );
+
+        integrateGenericElement( tableX, tableY, weights, sourceValues, expectedKe, expectedFe );
+        selectElementKernel( p )( tableX, tableY, weights, sourceValues, computedKe, computedFe );
+
+        for( size_t i = 0; i < numberOfElementDofs; ++i )
+        {
+            for( size_t j = 0; j < numberOfElementDofs; ++j )
+            {
+                CHECK( computedKe( i, j ) == Approx( expectedKe( i, j ) ).margin( 1e-12 ) );
+            }
+
+            CHECK( computedFe[i] == Approx( expectedFe[i] ).margin( 1e-12 ) );
+        }
+    }
+
+    CHECK( selectElementKernel( { 7, 2 } ) == &integrateGenericElement );
+    CHECK( selectElementKernel( { 2, 7 } ) == &integrateGenericElement );
+    CHECK( selectElementKernel( { 3, 3 } ) != &integrateGenericElement );
+}
+
+} // namespace splinekernel
+} // namespace cie
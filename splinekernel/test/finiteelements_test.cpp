@@ -1,5 +1,6 @@
 #include "catch.hpp"
 #include "finiteelements.hpp"
+#include "basisfunctions.hpp"
 #include "sparse.hpp"
 
 #include <vector>
@@ -94,6 +95,31 @@ TEST_CASE("findKnotSpan_test")
     CHECK_THROWS(detail::findKnotSpan(-2.0, 4.0, 0, -2.0));
 }
 
+TEST_CASE("findElementClasses_test")
+{
+    auto knotVectors = detail::constructOpenKnotVectors({ 7, 8 }, { 2, 3 }, { 1, 1 }, { 3.0, 5.0 }, { -2.0, 4.0 });
+
+    std::vector<size_t> classes0, classes1;
+
+    REQUIRE_NOTHROW(classes0 = detail::findElementClasses(KnotVector(knotVectors[0], 2)));
+    REQUIRE_NOTHROW(classes1 = detail::findElementClasses(KnotVector(knotVectors[1], 3)));
+
+    // C1 quadratic: only the first and the last element differ from the interior ones
+    CHECK(classes0 == std::vector<size_t>{ 0, 1, 1, 1, 1, 1, 2 });
+
+    // C1 cubic: the knots are repeated twice, so again only one element on each side is special
+    CHECK(classes1 == std::vector<size_t>{ 0, 1, 1, 1, 1, 1, 1, 2 });
+
+    // Graded knot vector: all elements are different
+    CHECK(detail::findElementClasses(KnotVector({ 0.0, 0.0, 0.1, 0.3, 0.6, 1.0, 1.0 }, 1)) == std::vector<size_t>{ 0, 1, 2, 3 });
+
+    // Linear: only the element lengths matter
+    CHECK(detail::findElementClasses(KnotVector({ 0.0, 0.0, 0.5, 1.0, 2.0, 3.0, 4.0, 4.0 }, 1)) == std::vector<size_t>{ 0, 0, 1, 1, 1 });
+
+    // Quadratic: the neighbouring element lengths matter as well
+    CHECK(detail::findElementClasses(KnotVector({ 0.0, 0.0, 0.0, 0.5, 1.0, 2.0, 3.0, 4.0, 4.0, 4.0 }, 2)) == std::vector<size_t>{ 0, 1, 2, 3, 4 });
+}
+
 TEST_CASE("BSplineFiniteElementPatch_constructor_test")
 {
     auto dummy_integrator = [](size_t)
@@ -191,6 +217,102 @@ TEST_CASE("BSplineFiniteElementPatch_evaluateActiveBasisAt_test")
 
 } // BSplineFiniteElementPatch_evaluateActiveBasisAt_test
 
+TEST_CASE("BSplineFiniteElementPatch_evaluateActiveBasisDerivativesAt_test")
+{
+    auto dummy_integrator = [](size_t) { return IntegrationPoints{ }; };
+
+    BSplineFiniteElementPatch mesh({ 5, 7 }, { 2, 3 }, { 1, 2 }, { 3.0, 5.0 }, { -2.0, 4.0 }, dummy_integrator);
+
+    for (std::array<double, 2> xy : { std::array<double, 2>{ 0.0, 5.0 }, 
+                                      std::array<double, 2>{ -2.0, 7.0 }, 
+                                      std::array<double, 2>{ -1.0, 9.0 } })
+    {
+        std::vector<std::vector<double>> derivatives;
+
+        REQUIRE_NOTHROW(derivatives = mesh.evaluateActiveBasisDerivativesAt(xy, 2));
+        REQUIRE(derivatives.size() == 9);
+
+        for (size_t kx = 0; kx <= 2; ++kx)
+        {
+            for (size_t ky = 0; ky <= 2; ++ky)
+            {
+                auto expected = mesh.evaluateActiveBasisAt(xy, { kx, ky });
+
+                REQUIRE(derivatives[kx * 3 + ky].size() == expected.size());
+
+                for (size_t iFunction = 0; iFunction < expected.size(); ++iFunction)
+                {
+                    CHECK(derivatives[kx * 3 + ky][iFunction] == Approx(expected[iFunction]).margin(1e-12));
+                }
+            }
+        }
+    }
+
+    // The basis is quadratic in x, so all third derivatives in x vanish
+    auto derivatives = mesh.evaluateActiveBasisDerivativesAt({ 0.1, 5.1 }, 3);
+
+    for (double value : derivatives[3 * 4 + 0])
+    {
+        CHECK(value == 0.0);
+    }
+}
+
+TEST_CASE("BSplineFiniteElementPatch_extractionOperators_test")
+{
+    auto dummy_integrator = [](size_t) { return IntegrationPoints{ }; };
+
+    BSplineFiniteElementPatch mesh({ 5, 7 }, { 2, 3 }, { 1, 2 }, { 3.0, 5.0 }, { -2.0, 4.0 }, dummy_integrator);
+
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        const auto& operators = mesh.extractionOperators(axis);
+        const KnotVector& knotVector = mesh.knotVector(axis);
+
+        size_t p = knotVector.degree();
+
+        REQUIRE(operators.size() == knotVector.numberOfElements());
+
+        // Both bases are a partition of unity, so the columns sum up to one
+        for (const auto& extractionOperator : operators)
+        {
+            REQUIRE(extractionOperator.size1() == p + 1);
+            REQUIRE(extractionOperator.size2() == p + 1);
+
+            for (size_t b = 0; b <= p; ++b)
+            {
+                double sum = 0.0;
+
+                for (size_t a = 0; a <= p; ++a)
+                {
+                    sum += extractionOperator(a, b);
+                }
+
+                CHECK(sum == Approx(1.0));
+            }
+        }
+    }
+
+    // Extracted basis is the same as the recursively evaluated one
+    std::array<double, 2> xy = { 0.3, 6.1 };
+
+    std::vector<double> Nx(2 * 3), Ny(2 * 4);
+
+    evaluateActiveBSplineDerivatives(xy[0], mesh.knotVector(0).findSpan(xy[0]), 2, mesh.knotVector(0).knots(), 1, Nx.data());
+    evaluateActiveBSplineDerivatives(xy[1], mesh.knotVector(1).findSpan(xy[1]), 3, mesh.knotVector(1).knots(), 1, Ny.data());
+
+    auto dNdx = mesh.evaluateActiveBasisAt(xy, { 1, 0 });
+
+    REQUIRE(dNdx.size() == 12);
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            CHECK(dNdx[i * 4 + j] == Approx(Nx[3 + i] * Ny[j]).margin(1e-12));
+        }
+    }
+}
+
 TEST_CASE("BSplineFiniteElementPatch_integrateElementSystem_test")
 {
     auto gaussIntegrator = [](size_t size) -> IntegrationPoints
@@ -254,6 +376,10 @@ TEST_CASE("BSplineFiniteElementPatch_integrateElementSystem_test")
 
     auto computedElementSystem = mesh.integrateElementSystem({ 1, 1 }, testSourceFunction);
 
+    // Elements 1 in x and 1 in y are interior elements sharing their basis tables with others
+    CHECK(mesh.elementClasses(0) == std::vector<size_t>{ 0, 1, 1, 1, 2 });
+    CHECK(mesh.elementClasses(1) == std::vector<size_t>{ 0, 1, 2, 2, 2, 3, 4 });
+
     // Check the element matrix
     const auto& computedElementMatrix = std::get<0>(computedElementSystem);
 
@@ -277,6 +403,32 @@ TEST_CASE("BSplineFiniteElementPatch_integrateElementSystem_test")
     {
         CHECK(computedElementRhs[i] == Approx(expectedElementVector[i]));
     }
+
+    // The integration points and basis tables are evaluated once per patch, not per element
+    size_t numberOfProviderCalls = 0;
+
+    auto countingIntegrator = [&](size_t size)
+    {
+        numberOfProviderCalls++;
+
+        return gaussIntegrator(size);
+    };
+
+    auto countedMesh = BSplineFiniteElementPatch({ 5, 7 }, { 2, 3 }, { 1, 2 }, { 3.0, 5.0 }, { -2.0, 4.0 }, countingIntegrator);
+
+    CHECK(numberOfProviderCalls == 0);
+
+    for (size_t iElement = 0; iElement < 5; ++iElement)
+    {
+        countedMesh.integrateElementSystem({ iElement, 1 }, testSourceFunction);
+    }
+
+    CHECK_NOTHROW(countedMesh.assembleGlobalSystem(testSourceFunction));
+
+    auto repeatedElementSystem = countedMesh.integrateElementSystem({ 1, 1 }, testSourceFunction);
+
+    CHECK(numberOfProviderCalls == 2);
+    CHECK(std::get<1>(repeatedElementSystem) == computedElementRhs);
 }
 
 TEST_CASE("BSplineFiniteElementPatch_constructLocationMaps_test1")
@@ -0,0 +1,152 @@
+#include "catch.hpp"
+#include "fitting.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+namespace fittingtesthelper
+{
+
+// Deterministic scattered parameters in [rMin, rMax] x [0, 1]
+void scatteredParameters( size_t numberOfPoints, double rMin, double rMax,
+                          std::vector<double>& r, std::vector<double>& s )
+{
+    r.resize( numberOfPoints );
+    s.resize( numberOfPoints );
+
+    for( size_t k = 0; k < numberOfPoints; ++k )
+    {
+        r[k] = rMin + ( rMax - rMin ) * std::fmod( 0.6180339887 * k, 1.0 );
+        s[k] = std::fmod( 0.7548776662 * k + 0.1, 1.0 );
+    }
+}
+
+} // namespace fittingtesthelper
+
+TEST_CASE( "fitSurface_reproduction_test" )
+{
+    std::array<std::vector<double>, 2> knotVectors{ std::vector<double>{ 0.0, 0.0, 0.0, 0.2, 0.5, 0.5, 0.8, 1.0, 1.0, 1.0 },
+                                                    std::vector<double>{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.6, 1.0, 1.0, 1.0, 1.0 } };
+
+    size_t nR = 7, nS = 6;
+
+    VectorOfMatrices controlPoints( 2, linalg::Matrix( nR, nS, 0.0 ) );
+
+    for( size_t i = 0; i < nR; ++i )
+    {
+        for( size_t j = 0; j < nS; ++j )
+        {
+            controlPoints[0]( i, j ) = i + 0.1 * j;
+            controlPoints[1]( i, j ) = std::sin( 1.3 * i ) * std::cos( 0.7 * j );
+        }
+    }
+
+    std::vector<double> r, s;
+
+    fittingtesthelper::scatteredParameters( 2000, 0.0, 1.0, r, s );
+
+    // Data on the surface itself is reproduced exactly
+    auto points = evaluateSurfaceAt( knotVectors, controlPoints, r, s );
+
+    VectorOfMatrices fitted;
+
+    REQUIRE_NOTHROW( fitted = fitSurface( knotVectors, { 2, 3 }, points, r, s ) );
+
+    REQUIRE( fitted.size( ) == 2 );
+    REQUIRE( fitted[0].size1( ) == nR );
+    REQUIRE( fitted[0].size2( ) == nS );
+
+    for( size_t iField = 0; iField < 2; ++iField )
+    {
+        for( size_t i = 0; i < nR; ++i )
+        {
+            for( size_t j = 0; j < nS; ++j )
+            {
+                CHECK( fitted[iField]( i, j ) == Approx( controlPoints[iField]( i, j ) ).margin( 1e-9 ) );
+            }
+        }
+    }
+
+    // Same result for any number of threads
+    for( size_t numberOfThreads : { 1, 2, 3, 0 } )
+    {
+        VectorOfMatrices parallel = fitSurface( knotVectors, { 2, 3 }, points, r, s, 0.0, numberOfThreads );
+
+        for( size_t i = 0; i < nR; ++i )
+        {
+            for( size_t j = 0; j < nS; ++j )
+            {
+                CHECK( parallel[1]( i, j ) == fitted[1]( i, j ) );
+            }
+        }
+    }
+
+    // Noisy data: the least squares solution is closer to the data than the original surface
+    std::vector<std::vector<double>> noisy = points;
+
+    for( size_t k = 0; k < r.size( ); ++k )
+    {
+        noisy[1][k] += 0.05 * std::sin( 37.0 * k );
+    }
+
+    VectorOfMatrices noisyFit = fitSurface( knotVectors, { 2, 3 }, noisy, r, s );
+
+    auto fittedPoints = evaluateSurfaceAt( knotVectors, noisyFit, r, s );
+
+    double fittedError = 0.0, originalError = 0.0;
+
+    for( size_t k = 0; k < r.size( ); ++k )
+    {
+        fittedError += std::pow( fittedPoints[1][k] - noisy[1][k], 2 );
+        originalError += std::pow( points[1][k] - noisy[1][k], 2 );
+    }
+
+    CHECK( fittedError < originalError );
+}
+
+TEST_CASE( "fitSurface_smoothing_test" )
+{
+    std::array<std::vector<double>, 2> knotVectors{ std::vector<double>{ 0.0, 0.0, 0.0, 0.0, 0.25, 0.5, 0.75, 1.0, 1.0, 1.0, 1.0 },
+                                                    std::vector<double>{ 0.0, 0.0, 0.0, 0.0, 0.5, 1.0, 1.0, 1.0, 1.0 } };
+
+    // Data only on the left half, so some control points are not determined by the data alone
+    std::vector<double> r, s;
+
+    fittingtesthelper::scatteredParameters( 500, 0.0, 0.45, r, s );
+
+    std::vector<std::vector<double>> points( 1, std::vector<double>( r.size( ) ) );
+
+    for( size_t k = 0; k < r.size( ); ++k )
+    {
+        points[0][k] = 1.0 + 2.0 * r[k] - 3.0 * s[k];
+    }
+
+    CHECK_THROWS( fitSurface( knotVectors, { 3, 3 }, points, r, s ) );
+
+    // The thin plate energy vanishes for linear fields, which are therefore extended exactly
+    VectorOfMatrices fitted;
+
+    REQUIRE_NOTHROW( fitted = fitSurface( knotVectors, { 3, 3 }, points, r, s, 1e-3 ) );
+
+    std::vector<double> rTest { 0.1, 0.6, 0.9, 1.0 }, sTest { 0.2, 0.5, 0.8, 1.0 };
+
+    auto values = evaluateSurfaceAt( knotVectors, fitted, rTest, sTest );
+
+    for( size_t k = 0; k < rTest.size( ); ++k )
+    {
+        CHECK( values[0][k] == Approx( 1.0 + 2.0 * rTest[k] - 3.0 * sTest[k] ).margin( 1e-8 ) );
+    }
+
+    // Invalid input
+    CHECK_THROWS( fitSurface( knotVectors, { 3, 3 }, points, r, s, -1.0 ) );
+    CHECK_THROWS( fitSurface( knotVectors, { 3, 3 }, points, r, { 0.5 } ) );
+    CHECK_THROWS( fitSurface( knotVectors, { 3, 3 }, { }, r, s ) );
+}
+
+} // namespace splinekernel
+} // namespace cie
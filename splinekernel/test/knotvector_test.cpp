@@ -0,0 +1,58 @@
+#include "catch.hpp"
+#include "knotvector.hpp"
+
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+TEST_CASE( "KnotVector_construct_test" )
+{
+    KnotVector knotVector( { 0.0, 0.0, 0.0, 0.2, 0.2, 0.7, 1.0, 1.0, 1.0 }, 2 );
+
+    CHECK( knotVector.degree( ) == 2 );
+    CHECK( knotVector.size( ) == 9 );
+    CHECK( knotVector.numberOfBasisFunctions( ) == 6 );
+    CHECK( knotVector.numberOfElements( ) == 3 );
+
+    CHECK( knotVector.uniqueKnots( ) == std::vector<double>{ 0.0, 0.2, 0.7, 1.0 } );
+    CHECK( knotVector.multiplicities( ) == std::vector<size_t>{ 3, 2, 1, 3 } );
+
+    CHECK( knotVector.spanIndex( 0 ) == 2 );
+    CHECK( knotVector.spanIndex( 1 ) == 4 );
+    CHECK( knotVector.spanIndex( 2 ) == 5 );
+
+    CHECK( knotVector.elementBegin( 1 ) == 0.2 );
+    CHECK( knotVector.elementEnd( 1 ) == 0.7 );
+
+    // Too short, unsorted, or without non-empty span
+    CHECK_THROWS( KnotVector( { 0.0, 0.0, 1.0, 1.0 }, 2 ) );
+    CHECK_THROWS( KnotVector( { 0.0, 0.0, 0.5, 0.3, 1.0, 1.0 }, 1 ) );
+    CHECK_THROWS( KnotVector( { 0.0, 0.0, 0.0, 0.0 }, 1 ) );
+}
+
+TEST_CASE( "KnotVector_findElement_test" )
+{
+    // Graded knot vector
+    KnotVector knotVector( { -1.0, -1.0, -1.0, -1.0, -0.9, -0.7, -0.3, 0.5, 2.0, 2.0, 2.0, 2.0 }, 3 );
+
+    std::vector<double> t { -1.5, -1.0, -0.95, -0.9, -0.8, -0.3, 0.0, 0.5, 1.9, 2.0, 3.0 };
+    std::vector<size_t> expectedElements { 0, 0, 0, 1, 1, 3, 3, 4, 4, 4, 4 };
+
+    for( size_t i = 0; i < t.size( ); ++i )
+    {
+        CHECK( knotVector.findElement( t[i] ) == expectedElements[i] );
+        CHECK( knotVector.findSpan( t[i] ) == expectedElements[i] + 3 );
+
+        // Hints: correct, previous, unrelated and invalid element index
+        CHECK( knotVector.findElement( t[i], expectedElements[i] ) == expectedElements[i] );
+        CHECK( knotVector.findElement( t[i], expectedElements[i] > 0 ? expectedElements[i] - 1 : 0 ) == expectedElements[i] );
+        CHECK( knotVector.findElement( t[i], 2 ) == expectedElements[i] );
+        CHECK( knotVector.findElement( t[i], 100 ) == expectedElements[i] );
+    }
+}
+
+} // namespace splinekernel
+} // namespace cie
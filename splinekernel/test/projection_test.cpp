@@ -0,0 +1,134 @@
+#include "catch.hpp"
+#include "projection.hpp"
+#include "utilities.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+TEST_CASE( "parallelFor_test" )
+{
+    for( size_t numberOfThreads : { 0, 1, 3, 7, 40 } )
+    {
+        std::vector<int> visited( 29, 0 );
+
+        parallelFor( visited.size( ), numberOfThreads, [&]( size_t begin, size_t end )
+        {
+            for( size_t i = begin; i < end; ++i )
+            {
+                visited[i] += 1;
+            }
+        } );
+
+        for( int count : visited )
+        {
+            CHECK( count == 1 );
+        }
+    }
+
+    REQUIRE_NOTHROW( parallelFor( 0, 4, [ ]( size_t begin, size_t end ) { } ) );
+
+    CHECK_THROWS( parallelFor( 10, 4, [ ]( size_t begin, size_t end )
+    {
+        runtime_check( begin != 5, "Test exception." );
+    } ) );
+}
+
+TEST_CASE( "projectOntoCurve_test" )
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.2, 0.3, 0.5, 0.7, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.5, 3.0, 2.0, 1.5, 0.5, -1.0 };
+    std::vector<double> y{ 0.0, 2.0, 1.0, -1.0, 0.5, 3.0, 2.0, 0.0 };
+
+    CurveEvaluator curve( knotVector, { x, y } );
+
+    size_t numberOfQueries = 41;
+
+    std::vector<double> t( numberOfQueries );
+
+    for( size_t i = 0; i < numberOfQueries; ++i )
+    {
+        t[i] = i / ( numberOfQueries - 1.0 );
+    }
+
+    // Points on the curve are projected onto themselves
+    auto points = curve.evaluate( t );
+
+    CurveProjection projection;
+
+    REQUIRE_NOTHROW( projection = projectOntoCurve( curve, points, 3 ) );
+
+    REQUIRE( projection.parameters.size( ) == numberOfQueries );
+    REQUIRE( projection.distances.size( ) == numberOfQueries );
+    REQUIRE( projection.points.size( ) == 2 );
+    REQUIRE( projection.points[0].size( ) == numberOfQueries );
+
+    for( size_t i = 0; i < numberOfQueries; ++i )
+    {
+        CHECK( projection.parameters[i] == Approx( t[i] ).margin( 1e-8 ) );
+        CHECK( projection.distances[i] == Approx( 0.0 ).margin( 1e-10 ) );
+        CHECK( projection.points[0][i] == Approx( points[0][i] ).margin( 1e-10 ) );
+        CHECK( projection.points[1][i] == Approx( points[1][i] ).margin( 1e-10 ) );
+    }
+
+    // Offset points along the normal are projected back to the foot point
+    double offset = 0.02;
+
+    std::vector<std::vector<double>> queries( 2, std::vector<double>( numberOfQueries ) );
+
+    for( size_t i = 0; i < numberOfQueries; ++i )
+    {
+        auto derivatives = curve.evaluateDerivatives( t[i], 1 );
+
+        double length = std::sqrt( derivatives[1][0] * derivatives[1][0] + derivatives[1][1] * derivatives[1][1] );
+
+        queries[0][i] = derivatives[0][0] - offset * derivatives[1][1] / length;
+        queries[1][i] = derivatives[0][1] + offset * derivatives[1][0] / length;
+    }
+
+    REQUIRE_NOTHROW( projection = projectOntoCurve( curve, queries, 1 ) );
+
+    for( size_t i = 1; i + 1 < numberOfQueries; ++i )
+    {
+        CHECK( projection.parameters[i] == Approx( t[i] ).margin( 1e-8 ) );
+        CHECK( projection.distances[i] == Approx( offset ).epsilon( 1e-8 ) );
+    }
+
+    // The result does not depend on the number of threads
+    auto reference = projectOntoCurve( curve, queries, 1 );
+    auto threaded = projectOntoCurve( curve, queries, 4 );
+
+    CHECK( threaded.parameters == reference.parameters );
+    CHECK( threaded.distances == reference.distances );
+    CHECK( threaded.points == reference.points );
+
+    CHECK_THROWS( projectOntoCurve( curve, { x } ) );
+    CHECK_THROWS( projectOntoCurve( curve, { x, { 1.0 } } ) );
+    CHECK_THROWS( projectOntoCurve( curve, points, 1, 1 ) );
+}
+
+TEST_CASE( "projectOntoCurve_far_test" )
+{
+    // Quadratic arc approximation, a point far outside projects onto the end point
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 1.0, 2.0, 2.0, 2.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.0, 3.0 };
+    std::vector<double> y{ 0.0, 1.0, 1.0, 0.0 };
+
+    CurveEvaluator curve( knotVector, { x, y } );
+
+    auto projection = projectOntoCurve( curve, { { 10.0, -5.0, 1.5 }, { -1.0, -1.0, 10.0 } } );
+
+    CHECK( projection.parameters[0] == Approx( 2.0 ) );
+    CHECK( projection.parameters[1] == Approx( 0.0 ) );
+    CHECK( projection.parameters[2] == Approx( 1.0 ) );
+
+    CHECK( projection.distances[0] == Approx( std::sqrt( 50.0 ) ) );
+    CHECK( projection.distances[1] == Approx( std::sqrt( 26.0 ) ) );
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -0,0 +1,45 @@
+#include "catch.hpp"
+#include "quadrature.hpp"
+
+#include <cmath>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+TEST_CASE( "gaussLegendrePoints_test" )
+{
+    for( size_t n = 1; n <= 12; ++n )
+    {
+        IntegrationPoints points;
+
+        REQUIRE_NOTHROW( points = gaussLegendrePoints( n ) );
+
+        REQUIRE( points[0].size( ) == n );
+        REQUIRE( points[1].size( ) == n );
+
+        // Exact for polynomials up to degree 2n - 1
+        for( size_t degree = 0; degree < 2 * n; ++degree )
+        {
+            double integral = 0.0;
+
+            for( size_t i = 0; i < n; ++i )
+            {
+                integral += points[1][i] * std::pow( points[0][i], degree );
+            }
+
+            CHECK( integral == Approx( degree % 2 == 0 ? 2.0 / ( degree + 1.0 ) : 0.0 ).margin( 1e-13 ) );
+        }
+
+        for( size_t i = 0; i + 1 < n; ++i )
+        {
+            CHECK( points[0][i] < points[0][i + 1] );
+        }
+    }
+
+    CHECK_THROWS( gaussLegendrePoints( 0 ) );
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -0,0 +1,362 @@
+#include "catch.hpp"
+#include "refinement.hpp"
+#include "curve.hpp"
+#include "surface.hpp"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+TEST_CASE( "insertKnot_test" )
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 };
+
+    KnotRefinement refinement;
+
+    REQUIRE_NOTHROW( refinement = insertKnot( knotVector, 2, 0.5 ) );
+
+    std::vector<double> expectedKnots{ 0.0, 0.0, 0.0, 0.5, 1.0, 1.0, 1.0 };
+
+    REQUIRE( refinement.knotVector.size( ) == expectedKnots.size( ) );
+
+    for( size_t i = 0; i < expectedKnots.size( ); ++i )
+    {
+        CHECK( refinement.knotVector[i] == Approx( expectedKnots[i] ) );
+    }
+
+    const auto& P = refinement.prolongation;
+
+    REQUIRE( P.size1( ) == 4 );
+    REQUIRE( P.size2( ) == 3 );
+
+    CHECK( P.nnz( ) == 6 );
+
+    std::vector<std::vector<double>> expectedP
+    {
+        { 1.0, 0.0, 0.0 },
+        { 0.5, 0.5, 0.0 },
+        { 0.0, 0.5, 0.5 },
+        { 0.0, 0.0, 1.0 }
+    };
+
+    for( size_t i = 0; i < 4; ++i )
+    {
+        for( size_t j = 0; j < 3; ++j )
+        {
+            CHECK( P( i, j ) == Approx( expectedP[i][j] ) );
+        }
+    }
+
+    CHECK_THROWS( insertKnot( knotVector, 2, 0.0 ) );
+    CHECK_THROWS( insertKnot( knotVector, 2, 1.5 ) );
+    CHECK_THROWS( insertKnot( { 0.0, 0.0, 0.5, 0.5, 1.0, 1.0 }, 1, 0.5 ) );
+}
+
+TEST_CASE( "refineKnotVector_curve_test" )
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.5, 0.5, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.5, 3.0, 2.0, 1.5, 0.0 };
+    std::vector<double> y{ 0.0, 2.0, 1.0, -1.0, 0.5, 3.0, 2.0 };
+
+    std::vector<double> newKnots{ 0.7, 0.1, 0.5, 0.3, 0.9, 0.9 };
+
+    KnotRefinement refinement;
+
+    REQUIRE_NOTHROW( refinement = refineKnotVector( knotVector, 3, newKnots ) );
+
+    REQUIRE( refinement.knotVector.size( ) == knotVector.size( ) + newKnots.size( ) );
+    REQUIRE( refinement.prolongation.size1( ) == x.size( ) + newKnots.size( ) );
+    REQUIRE( refinement.prolongation.size2( ) == x.size( ) );
+
+    // Each row is a partition of unity
+    std::vector<double> ones = refinement.prolongation * std::vector<double>( x.size( ), 1.0 );
+
+    for( double value : ones )
+    {
+        CHECK( value == Approx( 1.0 ) );
+    }
+
+    // The curve does not change
+    std::vector<double> refinedX = refinement.prolongation * x;
+    std::vector<double> refinedY = refinement.prolongation * y;
+
+    std::vector<double> t;
+
+    for( size_t i = 0; i <= 50; ++i )
+    {
+        t.push_back( i / 50.0 );
+    }
+
+    auto coarseCurve = evaluate2DCurve( t, x, y, knotVector );
+    auto fineCurve = evaluate2DCurve( t, refinedX, refinedY, refinement.knotVector );
+
+    for( size_t i = 0; i < t.size( ); ++i )
+    {
+        CHECK( fineCurve[0][i] == Approx( coarseCurve[0][i] ) );
+        CHECK( fineCurve[1][i] == Approx( coarseCurve[1][i] ) );
+    }
+
+    // Single knot refinement coincides with Boehm's algorithm
+    KnotRefinement oslo = refineKnotVector( knotVector, 3, { 0.5 } );
+    KnotRefinement boehm = insertKnot( knotVector, 3, 0.5 );
+
+    REQUIRE( oslo.prolongation.size1( ) == boehm.prolongation.size1( ) );
+
+    for( size_t i = 0; i < oslo.prolongation.size1( ); ++i )
+    {
+        for( size_t j = 0; j < oslo.prolongation.size2( ); ++j )
+        {
+            CHECK( oslo.prolongation( i, j ) == Approx( boehm.prolongation( i, j ) ).margin( 1e-12 ) );
+        }
+    }
+
+    CHECK_THROWS( refineKnotVector( knotVector, 3, { 0.5, 0.5, 0.5 } ) );
+    CHECK_THROWS( refineKnotVector( knotVector, 3, { 1.0 } ) );
+}
+
+TEST_CASE( "refineControlGrid_test" )
+{
+    std::array<std::vector<double>, 2> knotVectors{ std::vector<double>{ 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0 },
+                                                    std::vector<double>{ 0.0, 0.0, 0.5, 1.0, 1.0 } };
+
+    linalg::Matrix zGrid( {  1.0,  1.0,  1.0,
+                             1.0, 49.0,  1.0,
+                             1.0, 49.0,  1.0,
+                             1.0,  1.0,  1.0 }, 4 );
+
+    KnotRefinement refinementR = refineKnotVector( knotVectors[0], 3, { 0.25, 0.5, 0.5 } );
+    KnotRefinement refinementS = refineKnotVector( knotVectors[1], 1, { 0.2, 0.75 } );
+
+    linalg::Matrix refinedGrid;
+
+    REQUIRE_NOTHROW( refinedGrid = refineControlGrid( refinementR.prolongation, refinementS.prolongation, zGrid ) );
+
+    REQUIRE( refinedGrid.size1( ) == 7 );
+    REQUIRE( refinedGrid.size2( ) == 5 );
+
+    auto coarseSurface = evaluateSurface( knotVectors, { zGrid }, { 9, 11 } );
+    auto fineSurface = evaluateSurface( { refinementR.knotVector, refinementS.knotVector }, { refinedGrid }, { 9, 11 } );
+
+    for( size_t i = 0; i < 9; ++i )
+    {
+        for( size_t j = 0; j < 11; ++j )
+        {
+            CHECK( fineSurface[0]( i, j ) == Approx( coarseSurface[0]( i, j ) ) );
+        }
+    }
+
+    // The tensor product operator gives the same result on the flattened grid
+    ProlongationOperator P = tensorProduct( refinementR.prolongation, refinementS.prolongation );
+
+    REQUIRE( P.size1( ) == 35 );
+    REQUIRE( P.size2( ) == 12 );
+
+    std::vector<double> coarseDofs;
+
+    for( size_t i = 0; i < 4; ++i )
+    {
+        for( size_t j = 0; j < 3; ++j )
+        {
+            coarseDofs.push_back( zGrid( i, j ) );
+        }
+    }
+
+    std::vector<double> fineDofs = P * coarseDofs;
+
+    for( size_t i = 0; i < 7; ++i )
+    {
+        for( size_t j = 0; j < 5; ++j )
+        {
+            CHECK( fineDofs[i * 5 + j] == Approx( refinedGrid( i, j ) ) );
+        }
+    }
+
+    CHECK_THROWS( refineControlGrid( refinementS.prolongation, refinementR.prolongation, zGrid ) );
+}
+
+TEST_CASE( "patchProlongation_test" )
+{
+    IntegrationPointProvider provider = []( size_t ) { return IntegrationPoints{ }; };
+
+    BSplineFiniteElementPatch coarse( { 3, 2 }, { 2, 4 }, { 1, 2 }, { 2.5, 3.5 }, { -1.5, 0.5 }, provider );
+    BSplineFiniteElementPatch fine( { 6, 4 }, { 2, 4 }, { 1, 1 }, { 2.5, 3.5 }, { -1.5, 0.5 }, provider );
+
+    ProlongationOperator P;
+
+    REQUIRE_NOTHROW( P = patchProlongation( coarse, fine ) );
+
+    REQUIRE( P.size2( ) == 5 * 7 );
+    REQUIRE( P.size1( ) == 8 * 14 );
+
+    std::vector<double> coarseSolution( P.size2( ) );
+
+    for( size_t i = 0; i < coarseSolution.size( ); ++i )
+    {
+        coarseSolution[i] = 0.1 * ( ( 7 * i ) % 11 ) - 0.3;
+    }
+
+    auto coarseEvaluator = coarse.solutionEvaluator( coarseSolution );
+    auto fineEvaluator = fine.solutionEvaluator( P * coarseSolution );
+
+    for( double x : { -1.4, -0.6, -0.7, 0.15, 0.2, 0.9 } )
+    {
+        for( double y : { 0.6, 2.2, 2.3, 3.7 } )
+        {
+            CHECK( fineEvaluator( x, y ) == Approx( coarseEvaluator( x, y ) ) );
+        }
+    }
+
+    // Raising the continuity is not a refinement
+    BSplineFiniteElementPatch smooth( { 6, 4 }, { 2, 4 }, { 1, 3 }, { 2.5, 3.5 }, { -1.5, 0.5 }, provider );
+    BSplineFiniteElementPatch shifted( { 6, 4 }, { 2, 4 }, { 1, 1 }, { 2.5, 3.5 }, { -1.0, 0.5 }, provider );
+
+    CHECK_THROWS( patchProlongation( coarse, smooth ) );
+    CHECK_THROWS( patchProlongation( coarse, shifted ) );
+}
+
+TEST_CASE( "removeKnots_test" )
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.4, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.5, 3.0, 2.0 };
+    std::vector<double> y{ 0.0, 2.0, 1.0, -1.0, 0.5 };
+
+    // Refine and remove the new knots again
+    auto refinement = refineKnotVector( knotVector, 3, { 0.1, 0.4, 0.7, 0.7, 0.9 } );
+
+    std::vector<std::vector<double>> refinedPoints{ refinement.prolongation * x, refinement.prolongation * y };
+
+    CurveReduction reduction;
+
+    REQUIRE_NOTHROW( reduction = removeKnots( refinement.knotVector, 3, refinedPoints, 1e-10 ) );
+
+    CHECK( reduction.degree == 3 );
+    CHECK( reduction.errorBound < 1e-10 );
+
+    REQUIRE( reduction.knotVector.size( ) == knotVector.size( ) );
+    REQUIRE( reduction.controlPoints.size( ) == 2 );
+    REQUIRE( reduction.controlPoints[0].size( ) == x.size( ) );
+
+    for( size_t i = 0; i < knotVector.size( ); ++i )
+    {
+        CHECK( reduction.knotVector[i] == knotVector[i] );
+    }
+
+    for( size_t i = 0; i < x.size( ); ++i )
+    {
+        CHECK( reduction.controlPoints[0][i] == Approx( x[i] ).margin( 1e-10 ) );
+        CHECK( reduction.controlPoints[1][i] == Approx( y[i] ).margin( 1e-10 ) );
+    }
+
+    // The original knot can't be removed exactly, but within a large tolerance
+    auto exact = removeKnots( knotVector, 3, { x, y }, 1e-10 );
+
+    CHECK( exact.knotVector.size( ) == knotVector.size( ) );
+    CHECK( exact.errorBound == 0.0 );
+
+    auto coarse = removeKnots( knotVector, 3, { x, y }, 10.0 );
+
+    REQUIRE( coarse.knotVector.size( ) == knotVector.size( ) - 1 );
+    CHECK( coarse.errorBound > 0.0 );
+    CHECK( coarse.errorBound <= 10.0 );
+
+    CHECK_THROWS( removeKnots( knotVector, 3, { x, { 1.0 } }, 1.0 ) );
+    CHECK_THROWS( removeKnots( knotVector, 3, { }, 1.0 ) );
+}
+
+TEST_CASE( "reduceDegree_test" )
+{
+    // Parabola y = x^2 on [0, 1] as C2 cubic spline: elevated Bezier points, then refined
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0 / 3.0, 2.0 / 3.0, 1.0 };
+    std::vector<double> y{ 0.0, 0.0, 1.0 / 3.0, 1.0 };
+
+    auto refinement = refineKnotVector( knotVector, 3, { 0.25, 0.5, 0.6 } );
+
+    std::vector<std::vector<double>> points{ refinement.prolongation * x, refinement.prolongation * y };
+
+    CurveReduction reduction;
+
+    REQUIRE_NOTHROW( reduction = reduceDegree( refinement.knotVector, 3, points ) );
+
+    CHECK( reduction.degree == 2 );
+    CHECK( reduction.errorBound < 1e-12 );
+
+    std::vector<double> expectedKnots{ 0.0, 0.0, 0.0, 0.25, 0.25, 0.5, 0.5, 0.6, 0.6, 1.0, 1.0, 1.0 };
+
+    REQUIRE( reduction.knotVector.size( ) == expectedKnots.size( ) );
+
+    for( size_t i = 0; i < expectedKnots.size( ); ++i )
+    {
+        CHECK( reduction.knotVector[i] == expectedKnots[i] );
+    }
+
+    CurveEvaluator reduced( reduction.knotVector, reduction.controlPoints );
+
+    for( double t = 0.0; t <= 1.0; t += 0.05 )
+    {
+        auto point = reduced.evaluateDerivatives( t, 0 )[0];
+
+        CHECK( point[1] == Approx( point[0] * point[0] ).margin( 1e-12 ) );
+    }
+
+    // Compression goes back to a single quadratic Bezier segment, linear is too far off
+    auto compressed = compressCurve( refinement.knotVector, 3, points, 1e-8, true );
+
+    CHECK( compressed.degree == 2 );
+    CHECK( compressed.errorBound < 1e-8 );
+    CHECK( compressed.knotVector == std::vector<double>{ 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 } );
+
+    REQUIRE( compressed.controlPoints[0].size( ) == 3 );
+
+    CHECK( compressed.controlPoints[0][1] == Approx( 0.5 ) );
+    CHECK( compressed.controlPoints[1][1] == Approx( 0.0 ).margin( 1e-10 ) );
+
+    CHECK_THROWS( reduceDegree( { 0.0, 0.0, 1.0, 1.0 }, 1, { { 0.0, 1.0 } } ) );
+    CHECK_THROWS( reduceDegree( { 0.0, 0.0, 0.0, 0.5, 1.0, 1.0 }, 2, { { 0.0, 1.0, 2.0 } } ) );
+}
+
+TEST_CASE( "compressCurve_errorBound_test" )
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.2, 0.3, 0.5, 0.7, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.5, 3.0, 3.5, 4.5, 5.5, 7.0 };
+    std::vector<double> y{ 0.0, 0.4, 0.5, 0.4, 0.5, 0.6, 0.5, 0.4 };
+
+    CurveEvaluator original( knotVector, { x, y } );
+
+    for( double tolerance : { 1e-3, 0.05, 0.3 } )
+    {
+        for( bool reduceDegrees : { false, true } )
+        {
+            auto compressed = compressCurve( knotVector, 3, { x, y }, tolerance, reduceDegrees );
+
+            CHECK( compressed.errorBound <= tolerance );
+            CHECK( compressed.knotVector.size( ) - compressed.degree - 1 == compressed.controlPoints[0].size( ) );
+
+            CurveEvaluator reduced( compressed.knotVector, compressed.controlPoints );
+
+            // The bound holds for points at the same parameter
+            for( double t = 0.0; t <= 1.0; t += 0.01 )
+            {
+                auto point1 = original.evaluateDerivatives( t, 0 )[0];
+                auto point2 = reduced.evaluateDerivatives( t, 0 )[0];
+
+                double distance = std::sqrt( ( point1[0] - point2[0] ) * ( point1[0] - point2[0] ) +
+                                             ( point1[1] - point2[1] ) * ( point1[1] - point2[1] ) );
+
+                CHECK( distance <= compressed.errorBound + 1e-12 );
+            }
+        }
+    }
+
+    auto compressed = compressCurve( knotVector, 3, { x, y }, 0.3, true );
+
+    CHECK( compressed.controlPoints[0].size( ) < x.size( ) );
+}
+
+} // namespace splinekernel
+} // namespace cie
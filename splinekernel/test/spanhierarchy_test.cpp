@@ -0,0 +1,272 @@
+#include "catch.hpp"
+#include "spanhierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+namespace
+{
+
+// Wavy curves stacked in y direction, every second one with a knot vector that is not open
+CurveFleet createFleet( size_t numberOfCurves, double shift = 0.0 )
+{
+    CurveFleet fleet( 2 );
+
+    for( size_t iCurve = 0; iCurve < numberOfCurves; ++iCurve )
+    {
+        std::vector<double> knotVector = iCurve % 2 == 0 ?
+            std::vector<double>{ 0.0, 0.0, 0.0, 0.0, 0.2, 0.4, 0.6, 0.8, 1.0, 1.0, 1.0, 1.0 } :
+            std::vector<double>{ 0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0 };
+
+        size_t numberOfControlPoints = iCurve % 2 == 0 ? 8 : 6;
+
+        std::vector<double> x( numberOfControlPoints ), y( numberOfControlPoints );
+
+        for( size_t i = 0; i < numberOfControlPoints; ++i )
+        {
+            x[i] = i + 0.3 * iCurve + shift;
+            y[i] = 2.0 * iCurve + std::sin( 1.7 * i + iCurve );
+        }
+
+        fleet.addCurve( knotVector, { x, y } );
+    }
+
+    return fleet;
+}
+
+} // namespace
+
+TEST_CASE( "SpanHierarchy_bounds_test" )
+{
+    CurveFleet fleet = createFleet( 6 );
+
+    SpanHierarchy hierarchy( fleet );
+
+    REQUIRE( hierarchy.numberOfSpans( ) == 3 * 5 + 3 * 3 );
+
+    CHECK( hierarchy.numberOfNodes( ) >= hierarchy.numberOfSpans( ) / 2 );
+
+    // Curve points of each span are inside its box, which is inside the box of all spans
+    auto lower = hierarchy.lowerBounds( );
+    auto upper = hierarchy.upperBounds( );
+
+    for( size_t iSpan = 0; iSpan < hierarchy.numberOfSpans( ); ++iSpan )
+    {
+        const CurveSpan& span = hierarchy.span( iSpan );
+
+        auto spanLower = hierarchy.lowerBounds( iSpan );
+        auto spanUpper = hierarchy.upperBounds( iSpan );
+
+        std::vector<double> t;
+
+        for( size_t i = 0; i <= 10; ++i )
+        {
+            t.push_back( span.lowerParameter + i * ( span.upperParameter - span.lowerParameter ) / 10.0 );
+        }
+
+        std::vector<size_t> offsets( fleet.numberOfCurves( ) + 1, 0 );
+
+        for( size_t iCurve = span.curveIndex + 1; iCurve < offsets.size( ); ++iCurve )
+        {
+            offsets[iCurve] = t.size( );
+        }
+
+        auto points = fleet.evaluate( t, offsets, 1 );
+
+        for( size_t i = 0; i < t.size( ); ++i )
+        {
+            for( size_t d = 0; d < 2; ++d )
+            {
+                CHECK( points[2 * i + d] >= spanLower[d] - 1e-12 );
+                CHECK( points[2 * i + d] <= spanUpper[d] + 1e-12 );
+            }
+        }
+
+        for( size_t d = 0; d < 2; ++d )
+        {
+            CHECK( spanLower[d] >= lower[d] );
+            CHECK( spanUpper[d] <= upper[d] );
+        }
+    }
+
+    // Bezier points of an interior span of an open cubic are tighter than the B-Spline points
+    const CurveSpan& span = hierarchy.span( 2 );
+
+    REQUIRE( span.curveIndex == 0 );
+    REQUIRE( span.elementIndex == 2 );
+
+    CHECK( hierarchy.upperBounds( 2 )[0] - hierarchy.lowerBounds( 2 )[0] < 3.0 );
+
+    CHECK_THROWS( hierarchy.span( hierarchy.numberOfSpans( ) ) );
+    CHECK_THROWS( SpanHierarchy( fleet, 0 ) );
+}
+
+TEST_CASE( "SpanHierarchy_queries_test" )
+{
+    CurveFleet fleet = createFleet( 8 );
+
+    SpanHierarchy hierarchy( fleet, 1 );
+
+    size_t numberOfSpans = hierarchy.numberOfSpans( );
+
+    auto overlaps = [&]( size_t iSpan, const std::vector<double>& lower, const std::vector<double>& upper )
+    {
+        auto spanLower = hierarchy.lowerBounds( iSpan );
+        auto spanUpper = hierarchy.upperBounds( iSpan );
+
+        return spanLower[0] <= upper[0] && spanUpper[0] >= lower[0] && spanLower[1] <= upper[1] && spanUpper[1] >= lower[1];
+    };
+
+    // Box queries against brute force
+    for( double x = -1.0; x < 9.0; x += 1.3 )
+    {
+        for( double y = -2.0; y < 16.0; y += 2.1 )
+        {
+            std::vector<double> lower{ x, y }, upper{ x + 0.7, y + 0.9 };
+
+            std::vector<size_t> expected;
+
+            for( size_t iSpan = 0; iSpan < numberOfSpans; ++iSpan )
+            {
+                if( overlaps( iSpan, lower, upper ) )
+                {
+                    expected.push_back( iSpan );
+                }
+            }
+
+            CHECK( hierarchy.intersectBox( lower, upper ) == expected );
+        }
+    }
+
+    // A vertical ray upwards hits the spans in order of their lower bound
+    auto hits = hierarchy.intersectRay( { 4.2, -10.0 }, { 0.0, 1.0 } );
+
+    REQUIRE( !hits.empty( ) );
+
+    for( size_t i = 0; i < numberOfSpans; ++i )
+    {
+        bool hit = hierarchy.lowerBounds( i )[0] <= 4.2 && hierarchy.upperBounds( i )[0] >= 4.2;
+
+        CHECK( hit == ( std::find( hits.begin( ), hits.end( ), i ) != hits.end( ) ) );
+    }
+
+    for( size_t i = 0; i + 1 < hits.size( ); ++i )
+    {
+        CHECK( hierarchy.lowerBounds( hits[i] )[1] <= hierarchy.lowerBounds( hits[i + 1] )[1] );
+    }
+
+    CHECK( hierarchy.intersectRay( { 4.2, -10.0 }, { 0.0, 1.0 }, 1.0 ).empty( ) );
+    CHECK( hierarchy.intersectRay( { 4.2, -10.0 }, { 0.0, -1.0 } ).empty( ) );
+
+    // The span with the closest of many samples is always one of the candidates
+    std::vector<double> t;
+    std::vector<size_t> offsets( 1, 0 ), sampleSpans;
+
+    for( size_t iSpan = 0; iSpan < numberOfSpans; ++iSpan )
+    {
+        const CurveSpan& span = hierarchy.span( iSpan );
+
+        for( size_t i = 0; i < 50; ++i )
+        {
+            t.push_back( span.lowerParameter + ( i + 0.5 ) * ( span.upperParameter - span.lowerParameter ) / 50.0 );
+            sampleSpans.push_back( iSpan );
+        }
+
+        if( iSpan + 1 == numberOfSpans || hierarchy.span( iSpan + 1 ).curveIndex != span.curveIndex )
+        {
+            offsets.push_back( t.size( ) );
+        }
+    }
+
+    auto samples = fleet.evaluate( t, offsets );
+
+    for( double x = -2.0; x < 10.0; x += 1.7 )
+    {
+        for( double y = -3.0; y < 18.0; y += 1.9 )
+        {
+            auto candidates = hierarchy.nearestSpans( { x, y } );
+
+            REQUIRE( !candidates.empty( ) );
+
+            CHECK( candidates.size( ) < numberOfSpans );
+
+            size_t closest = 0;
+
+            for( size_t i = 1; i < t.size( ); ++i )
+            {
+                if( std::hypot( samples[2 * i] - x, samples[2 * i + 1] - y ) < 
+                    std::hypot( samples[2 * closest] - x, samples[2 * closest + 1] - y ) )
+                {
+                    closest = i;
+                }
+            }
+
+            CHECK( std::find( candidates.begin( ), candidates.end( ), sampleSpans[closest] ) != candidates.end( ) );
+        }
+    }
+}
+
+TEST_CASE( "SpanHierarchy_update_test" )
+{
+    CurveFleet fleet = createFleet( 5 );
+    CurveFleet moved = createFleet( 5, 3.0 );
+
+    SpanHierarchy hierarchy( fleet );
+    SpanHierarchy reference( moved );
+
+    // Control points of a moved curve with one vector per coordinate
+    auto controlPoints = [&]( size_t curveIndex )
+    {
+        std::vector<std::vector<double>> points( 2 );
+
+        for( size_t i = moved.controlPointOffsets( )[curveIndex]; i < moved.controlPointOffsets( )[curveIndex + 1]; ++i )
+        {
+            points[0].push_back( moved.controlPoints( )[2 * i] );
+            points[1].push_back( moved.controlPoints( )[2 * i + 1] );
+        }
+
+        return points;
+    };
+
+    std::vector<double> lower{ 7.5, -5.0 }, upper{ 8.5, 20.0 };
+
+    auto before = hierarchy.intersectBox( lower, upper );
+
+    fleet.setControlPoints( 3, controlPoints( 3 ) );
+
+    REQUIRE_NOTHROW( hierarchy.update( 3 ) );
+
+    for( size_t iSpan = 0; iSpan < hierarchy.numberOfSpans( ); ++iSpan )
+    {
+        bool isMoved = hierarchy.span( iSpan ).curveIndex == 3;
+
+        CHECK( ( hierarchy.lowerBounds( iSpan ) == reference.lowerBounds( iSpan ) ) == isMoved );
+    }
+
+    auto after = hierarchy.intersectBox( lower, upper );
+
+    CHECK( after.size( ) > before.size( ) );
+
+    for( size_t iCurve : { 0, 1, 2, 4 } )
+    {
+        fleet.setControlPoints( iCurve, controlPoints( iCurve ) );
+    }
+
+    REQUIRE_NOTHROW( hierarchy.update( ) );
+
+    CHECK( hierarchy.lowerBounds( ) == reference.lowerBounds( ) );
+    CHECK( hierarchy.upperBounds( ) == reference.upperBounds( ) );
+    CHECK( hierarchy.intersectBox( lower, upper ) == reference.intersectBox( lower, upper ) );
+    CHECK( hierarchy.nearestSpans( { 6.0, 3.0 } ) == reference.nearestSpans( { 6.0, 3.0 } ) );
+
+    CHECK_THROWS( fleet.setControlPoints( 0, { { 1.0 }, { 2.0 } } ) );
+    CHECK_THROWS( hierarchy.update( 5 ) );
+}
+
+} // namespace splinekernel
+} // namespace cie
@@ -490,5 +490,48 @@ TEST_CASE( "SparseMatrix_combined_test2" )
 
 } // SparseMatrix_combined_test2
 
+TEST_CASE( "SparseMatrix_bandedCholesky_test" )
+{
+    auto matrix = simpleTestMatrix( );
+
+    // Singular before anything is scattered
+    CHECK_THROWS( BandedCholesky{ matrix } );
+
+    linalg::Matrix elementMatrix( 2, 2, 0.0 );
+
+    elementMatrix( 0, 0 ) = 2.0;
+    elementMatrix( 0, 1 ) = -1.0;
+    elementMatrix( 1, 0 ) = -1.0;
+    elementMatrix( 1, 1 ) = 3.0;
+
+    std::vector<LocationMap> locationMaps { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 1, 4 } };
+
+    for( const auto& locationMap : locationMaps )
+    {
+        matrix.scatter( elementMatrix, locationMap );
+    }
+
+    BandedCholesky factorization( matrix );
+
+    REQUIRE( factorization.size( ) == 5 );
+    REQUIRE( factorization.bandwidth( ) == 3 );
+
+    std::vector<double> expectedSolution { 1.0, -2.0, 0.5, 4.0, -3.5 };
+    std::vector<double> rhs = matrix * expectedSolution;
+
+    std::vector<double> solution;
+
+    REQUIRE_NOTHROW( solution = factorization.solve( rhs ) );
+
+    REQUIRE( solution.size( ) == 5 );
+
+    for( size_t i = 0; i < 5; ++i )
+    {
+        CHECK( solution[i] == Approx( expectedSolution[i] ) );
+    }
+
+    CHECK_THROWS( factorization.solve( { 1.0, 2.0 } ) );
+}
+
 } // namespace cie
 } // namespace splinekernel
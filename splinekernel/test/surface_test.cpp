@@ -1,7 +1,10 @@
 #include "catch.hpp"
 #include "surface.hpp"
+#include "basisfunctions.hpp"
+#include "refinement.hpp"
 
 #include <array>
+#include <cmath>
 #include <vector>
 
 namespace cie
@@ -67,6 +70,48 @@ TEST_CASE( "Linear interpolation surface" )
 
 } // Linear interpolation surface
 
+TEST_CASE( "Surface on knot vectors that are not open" )
+{
+    // The samples in [0, 1] reach outside of [t_p, t_n] = [0.25, 0.75] in r and [0.2, 0.8] in s
+    std::vector<double> knotVectorR{ 0.0, 0.25, 0.5, 0.75, 1.0 };
+    std::vector<double> knotVectorS{ 0.0, 0.1, 0.2, 0.8, 0.9, 1.0 };
+
+    std::array<std::vector<double>, 2> knotVectors{ knotVectorR, knotVectorS };
+
+    linalg::Matrix zGrid( { 1.0, 2.0, 0.5,
+                            3.0, 1.0, 2.0,
+                           -1.0, 4.0, 1.5 }, 3 );
+
+    size_t numberOfSamplesR = 13;
+    size_t numberOfSamplesS = 11;
+
+    VectorOfMatrices C;
+
+    REQUIRE_NOTHROW( C = evaluateSurface( knotVectors, { zGrid }, { numberOfSamplesR, numberOfSamplesS } ) );
+
+    for( size_t iSample = 0; iSample < numberOfSamplesR; ++iSample )
+    {
+        for( size_t jSample = 0; jSample < numberOfSamplesS; ++jSample )
+        {
+            double r = iSample / ( numberOfSamplesR - 1.0 );
+            double s = jSample / ( numberOfSamplesS - 1.0 );
+
+            double expected = 0.0;
+
+            for( size_t i = 0; i < 3; ++i )
+            {
+                for( size_t j = 0; j < 3; ++j )
+                {
+                    expected += evaluateBSplineBasis( r, i, 1, knotVectorR ) *
+                                evaluateBSplineBasis( s, j, 2, knotVectorS ) * zGrid( i, j );
+                }
+            }
+
+            CHECK( C[0]( iSample, jSample ) == Approx( expected ).margin( 1e-12 ) );
+        }
+    }
+}
+
 TEST_CASE( "Cubic-linear interpolation surface" ) 
 {
     std::vector<double> knotVectorR{ 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0 };
@@ -133,5 +178,453 @@ TEST_CASE( "Cubic-linear interpolation surface" )
 
 } // TEST_CASE("Cubic-linear interpolation surface")
 
+TEST_CASE( "Single precision surface" )
+{
+    std::array<std::vector<double>, 2> knotVectors{ std::vector<double>{ 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 1.0 },
+                                                    std::vector<double>{ 0.0, 0.0, 0.5, 1.0, 1.0 } };
+
+    linalg::Matrix zGrid( {  1.0,  1.0,  1.0,
+                             1.0, 49.0,  1.0,
+                             1.0, 49.0,  1.0,
+                             1.0,  1.0,  1.0 }, 4 );
+
+    std::vector<float> zFloat{ 1.0f,  1.0f, 1.0f,
+                               1.0f, 49.0f, 1.0f,
+                               1.0f, 49.0f, 1.0f,
+                               1.0f,  1.0f, 1.0f };
+
+    std::vector<float> result( 7 * 5 );
+
+    REQUIRE_NOTHROW( evaluateSurfaceFields<float>( knotVectors, { zFloat.data( ) }, { 4, 3 }, { 7, 5 }, { result.data( ) } ) );
+
+    VectorOfMatrices expected = evaluateSurface( knotVectors, { zGrid }, { 7, 5 } );
+
+    for( size_t i = 0; i < 7; ++i )
+    {
+        for( size_t j = 0; j < 5; ++j )
+        {
+            CHECK( result[i * 5 + j] == Approx( expected[0]( i, j ) ).epsilon( 1e-5 ) );
+        }
+    }
+
+    CHECK_THROWS( evaluateSurfaceFields<float>( knotVectors, { zFloat.data( ) }, { 4, 3 }, { 7, 5 }, { } ) );
+
+} // Single precision surface
+
+TEST_CASE( "Separable multi-field surface" )
+{
+    std::array<std::vector<double>, 2> knotVectors{ std::vector<double>{ 0.0, 0.0, 0.0, 0.2, 0.5, 0.5, 0.8, 1.0, 1.0, 1.0 },
+                                                    std::vector<double>{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.6, 1.0, 1.0, 1.0, 1.0 } };
+
+    size_t nR = 7, nS = 6;
+
+    VectorOfMatrices controlPoints( 3, linalg::Matrix( nR, nS, 0.0 ) );
+
+    for( size_t i = 0; i < nR; ++i )
+    {
+        for( size_t j = 0; j < nS; ++j )
+        {
+            controlPoints[0]( i, j ) = i + 0.1 * j;
+            controlPoints[1]( i, j ) = std::sin( 1.3 * i ) * std::cos( 0.7 * j );
+            controlPoints[2]( i, j ) = ( i * j ) % 5 - 2.0;
+        }
+    }
+
+    std::array<size_t, 2> numberOfSamples{ 13, 9 };
+
+    VectorOfMatrices result;
+
+    REQUIRE_NOTHROW( result = evaluateSurface( knotVectors, controlPoints, numberOfSamples ) );
+
+    REQUIRE( result.size( ) == 3 );
+
+    // Compare with the direct sum over all basis function products
+    for( size_t iSample = 0; iSample < numberOfSamples[0]; ++iSample )
+    {
+        double r = iSample / ( numberOfSamples[0] - 1.0 );
+
+        for( size_t jSample = 0; jSample < numberOfSamples[1]; ++jSample )
+        {
+            double s = jSample / ( numberOfSamples[1] - 1.0 );
+
+            for( size_t iField = 0; iField < 3; ++iField )
+            {
+                double expected = 0.0;
+
+                for( size_t i = 0; i < nR; ++i )
+                {
+                    for( size_t j = 0; j < nS; ++j )
+                    {
+                        expected += evaluateBSplineBasis( r, i, 2, knotVectors[0] ) * 
+                                    evaluateBSplineBasis( s, j, 3, knotVectors[1] ) * controlPoints[iField]( i, j );
+                    }
+                }
+
+                CHECK( result[iField]( iSample, jSample ) == Approx( expected ).margin( 1e-12 ) );
+            }
+        }
+    }
+
+    // Multithreaded evaluation gives exactly the same values
+    VectorOfMatrices serial = evaluateSurface( knotVectors, controlPoints, numberOfSamples, 1 );
+
+    for( size_t numberOfThreads : { 0, 2, 5, 13, 40 } )
+    {
+        VectorOfMatrices parallel = evaluateSurface( knotVectors, controlPoints, numberOfSamples, numberOfThreads );
+
+        for( size_t iField = 0; iField < 3; ++iField )
+        {
+            for( size_t iSample = 0; iSample < numberOfSamples[0]; ++iSample )
+            {
+                for( size_t jSample = 0; jSample < numberOfSamples[1]; ++jSample )
+                {
+                    CHECK( parallel[iField]( iSample, jSample ) == serial[iField]( iSample, jSample ) );
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE( "Scattered point surface evaluation" )
+{
+    std::array<std::vector<double>, 2> knotVectors{ std::vector<double>{ 0.0, 0.0, 0.0, 0.2, 0.5, 0.5, 0.8, 1.0, 1.0, 1.0 },
+                                                    std::vector<double>{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.6, 1.0, 1.0, 1.0, 1.0 } };
+
+    size_t nR = 7, nS = 6;
+
+    VectorOfMatrices controlPoints( 2, linalg::Matrix( nR, nS, 0.0 ) );
+
+    for( size_t i = 0; i < nR; ++i )
+    {
+        for( size_t j = 0; j < nS; ++j )
+        {
+            controlPoints[0]( i, j ) = std::sin( 1.3 * i ) * std::cos( 0.7 * j );
+            controlPoints[1]( i, j ) = ( i * j ) % 5 - 2.0;
+        }
+    }
+
+    std::array<size_t, 2> numberOfSamples{ 11, 9 };
+
+    VectorOfMatrices expected = evaluateSurface( knotVectors, controlPoints, numberOfSamples );
+
+    // Grid points in scrambled order
+    size_t numberOfPoints = numberOfSamples[0] * numberOfSamples[1];
+
+    std::vector<double> r( numberOfPoints ), s( numberOfPoints );
+    std::vector<size_t> indices( numberOfPoints );
+
+    for( size_t k = 0; k < numberOfPoints; ++k )
+    {
+        indices[k] = ( 37 * k ) % numberOfPoints;
+
+        r[k] = ( indices[k] / numberOfSamples[1] ) / ( numberOfSamples[0] - 1.0 );
+        s[k] = ( indices[k] % numberOfSamples[1] ) / ( numberOfSamples[1] - 1.0 );
+    }
+
+    std::vector<std::vector<double>> result;
+
+    REQUIRE_NOTHROW( result = evaluateSurfaceAt( knotVectors, controlPoints, r, s, 1 ) );
+
+    REQUIRE( result.size( ) == 2 );
+    REQUIRE( result[0].size( ) == numberOfPoints );
+
+    for( size_t k = 0; k < numberOfPoints; ++k )
+    {
+        for( size_t iField = 0; iField < 2; ++iField )
+        {
+            CHECK( result[iField][k] == Approx( expected[iField]( indices[k] / numberOfSamples[1], 
+                                                                  indices[k] % numberOfSamples[1] ) ).margin( 1e-12 ) );
+        }
+    }
+
+    CHECK( evaluateSurfaceAt( knotVectors, controlPoints, r, s, 4 ) == result );
+
+    // Single precision kernel
+    std::vector<float> rFloat( r.begin( ), r.end( ) ), sFloat( s.begin( ), s.end( ) );
+    std::vector<float> fieldFloat( nR * nS ), resultFloat( numberOfPoints );
+
+    for( size_t i = 0; i < nR * nS; ++i )
+    {
+        fieldFloat[i] = static_cast<float>( controlPoints[1]( i / nS, i % nS ) );
+    }
+
+    REQUIRE_NOTHROW( evaluateSurfaceFieldsAt<float>( knotVectors, { fieldFloat.data( ) }, { nR, nS }, rFloat.data( ), 
+                                                     sFloat.data( ), numberOfPoints, { resultFloat.data( ) }, 2 ) );
+
+    for( size_t k = 0; k < numberOfPoints; ++k )
+    {
+        CHECK( resultFloat[k] == Approx( result[1][k] ).margin( 1e-5 ) );
+    }
+
+    CHECK( evaluateSurfaceAt( knotVectors, controlPoints, { }, { } )[0].empty( ) );
+
+    CHECK_THROWS( evaluateSurfaceAt( knotVectors, controlPoints, r, { 0.5 } ) );
+    CHECK_THROWS( evaluateSurfaceAt( knotVectors, { }, r, s ) );
+    CHECK_THROWS( evaluateSurfaceAt( knotVectors, { controlPoints[0], linalg::Matrix( nR, nS - 1, 0.0 ) }, r, s ) );
+}
+
+TEST_CASE( "Incremental surface grid evaluation" )
+{
+    std::array<std::vector<double>, 2> knotVectors{ std::vector<double>{ 0.0, 0.0, 0.0, 0.2, 0.5, 0.5, 0.8, 1.0, 1.0, 1.0 },
+                                                    std::vector<double>{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.6, 1.0, 1.0, 1.0, 1.0 } };
+
+    size_t nR = 7, nS = 6;
+
+    VectorOfMatrices controlPoints( 2, linalg::Matrix( nR, nS, 0.0 ) );
+
+    for( size_t i = 0; i < nR; ++i )
+    {
+        for( size_t j = 0; j < nS; ++j )
+        {
+            controlPoints[0]( i, j ) = i + 0.1 * j;
+            controlPoints[1]( i, j ) = std::sin( 1.3 * i ) * std::cos( 0.7 * j );
+        }
+    }
+
+    std::array<size_t, 2> numberOfSamples{ 41, 27 };
+
+    SurfaceGridEvaluator grid( knotVectors, controlPoints, numberOfSamples );
+
+    REQUIRE( grid.numberOfSamplePoints( )[0] == 41 );
+    REQUIRE( grid.numberOfSamplePoints( )[1] == 27 );
+
+    // Corner control points only influence the samples on the first or last knot spans
+    auto range = grid.affectedSamples( 0, 0 );
+
+    CHECK( range[0] == 0 );
+    CHECK( range[1] == 8 );   // r < 0.2
+    CHECK( range[2] == 0 );
+    CHECK( range[3] == 8 );   // s < 0.3
+
+    range = grid.affectedSamples( nR - 1, nS - 1 );
+
+    CHECK( range[0] == 32 );  // r >= 0.8
+    CHECK( range[1] == 41 );
+    CHECK( range[2] == 16 );  // s >= 0.6
+    CHECK( range[3] == 27 );
+
+    std::vector<std::array<size_t, 2>> edits { { 0, 0 }, { 3, 2 }, { 6, 5 }, { 4, 0 }, { 3, 2 } };
+
+    for( size_t iEdit = 0; iEdit < edits.size( ); ++iEdit )
+    {
+        size_t i = edits[iEdit][0], j = edits[iEdit][1];
+
+        VectorOfMatrices before = grid.samples( );
+
+        REQUIRE_NOTHROW( grid.moveControlPoint( i, j, { 0.5, -1.0 - iEdit } ) );
+
+        controlPoints[0]( i, j ) += 0.5;
+        controlPoints[1]( i, j ) += -1.0 - iEdit;
+
+        VectorOfMatrices expected = evaluateSurface( knotVectors, controlPoints, numberOfSamples );
+
+        range = grid.affectedSamples( i, j );
+
+        for( size_t iField = 0; iField < 2; ++iField )
+        {
+            for( size_t iSample = 0; iSample < numberOfSamples[0]; ++iSample )
+            {
+                for( size_t jSample = 0; jSample < numberOfSamples[1]; ++jSample )
+                {
+                    double value = grid.samples( )[iField]( iSample, jSample );
+
+                    CHECK( value == Approx( expected[iField]( iSample, jSample ) ).margin( 1e-12 ) );
+
+                    bool inside = iSample >= range[0] && iSample < range[1] && jSample >= range[2] && jSample < range[3];
+
+                    // Samples outside of the rectangle are not touched
+                    if( !inside )
+                    {
+                        CHECK( value == before[iField]( iSample, jSample ) );
+                    }
+                }
+            }
+        }
+    }
+
+    REQUIRE_NOTHROW( grid.setControlPoint( 2, 3, { 1.0, 2.0 } ) );
+
+    CHECK( grid.controlPoints( )[0]( 2, 3 ) == 1.0 );
+    CHECK( grid.controlPoints( )[1]( 2, 3 ) == 2.0 );
+
+    controlPoints[0]( 2, 3 ) = 1.0;
+    controlPoints[1]( 2, 3 ) = 2.0;
+
+    VectorOfMatrices expected = evaluateSurface( knotVectors, controlPoints, numberOfSamples );
+
+    for( size_t iSample = 0; iSample < numberOfSamples[0]; ++iSample )
+    {
+        for( size_t jSample = 0; jSample < numberOfSamples[1]; ++jSample )
+        {
+            CHECK( grid.samples( )[1]( iSample, jSample ) == Approx( expected[1]( iSample, jSample ) ).margin( 1e-12 ) );
+        }
+    }
+
+    CHECK_THROWS( grid.moveControlPoint( nR, 0, { 0.0, 0.0 } ) );
+    CHECK_THROWS( grid.moveControlPoint( 0, 0, { 0.0 } ) );
+    CHECK_THROWS( grid.setControlPoint( 0, nS, { 0.0, 0.0 } ) );
+}
+
+TEST_CASE( "Surface geometry of paraboloid" )
+{
+    // z = x^2 + y^2 over [0, 1]^2 as biquadratic patch, refined to have several knot spans
+    std::vector<double> bezierKnots{ 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 };
+
+    linalg::Matrix x( { 0.0, 0.0, 0.0, 0.5, 0.5, 0.5, 1.0, 1.0, 1.0 }, 3 );
+    linalg::Matrix y( { 0.0, 0.5, 1.0, 0.0, 0.5, 1.0, 0.0, 0.5, 1.0 }, 3 );
+    linalg::Matrix z( { 0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0, 2.0 }, 3 );
+
+    auto refinementR = refineKnotVector( bezierKnots, 2, { 0.3, 0.6 } );
+    auto refinementS = refineKnotVector( bezierKnots, 2, { 0.5 } );
+
+    VectorOfMatrices controlPoints;
+
+    for( const auto& field : { x, y, z } )
+    {
+        controlPoints.push_back( refineControlGrid( refinementR.prolongation, refinementS.prolongation, field ) );
+    }
+
+    std::array<std::vector<double>, 2> knotVectors{ refinementR.knotVector, refinementS.knotVector };
+
+    std::array<size_t, 2> numberOfSamples{ 6, 5 };
+
+    SurfaceGeometry geometry;
+
+    REQUIRE_NOTHROW( geometry = evaluateSurfaceGeometry( knotVectors, controlPoints, numberOfSamples ) );
+
+    REQUIRE( geometry.position.size( ) == 3 );
+    REQUIRE( geometry.normal.size( ) == 3 );
+    REQUIRE( geometry.gaussianCurvature.size1( ) == 6 );
+    REQUIRE( geometry.meanCurvature.size2( ) == 5 );
+
+    VectorOfMatrices positions = evaluateSurface( knotVectors, controlPoints, numberOfSamples );
+
+    for( size_t i = 0; i < numberOfSamples[0]; ++i )
+    {
+        for( size_t j = 0; j < numberOfSamples[1]; ++j )
+        {
+            double r = i / ( numberOfSamples[0] - 1.0 );
+            double s = j / ( numberOfSamples[1] - 1.0 );
+
+            for( size_t d = 0; d < 3; ++d )
+            {
+                CHECK( geometry.position[d]( i, j ) == Approx( positions[d]( i, j ) ) );
+            }
+
+            CHECK( geometry.position[2]( i, j ) == Approx( r * r + s * s ) );
+
+            CHECK( geometry.derivativeR[0]( i, j ) == Approx( 1.0 ) );
+            CHECK( geometry.derivativeR[1]( i, j ) == Approx( 0.0 ).margin( 1e-12 ) );
+            CHECK( geometry.derivativeR[2]( i, j ) == Approx( 2.0 * r ).margin( 1e-12 ) );
+            CHECK( geometry.derivativeS[1]( i, j ) == Approx( 1.0 ) );
+            CHECK( geometry.derivativeS[2]( i, j ) == Approx( 2.0 * s ).margin( 1e-12 ) );
+
+            CHECK( geometry.derivativeRR[2]( i, j ) == Approx( 2.0 ) );
+            CHECK( geometry.derivativeRS[2]( i, j ) == Approx( 0.0 ).margin( 1e-12 ) );
+            CHECK( geometry.derivativeSS[2]( i, j ) == Approx( 2.0 ) );
+            CHECK( geometry.derivativeRR[0]( i, j ) == Approx( 0.0 ).margin( 1e-12 ) );
+
+            double w = 1.0 + 4.0 * r * r + 4.0 * s * s;
+
+            CHECK( geometry.normal[0]( i, j ) == Approx( -2.0 * r / std::sqrt( w ) ).margin( 1e-12 ) );
+            CHECK( geometry.normal[1]( i, j ) == Approx( -2.0 * s / std::sqrt( w ) ).margin( 1e-12 ) );
+            CHECK( geometry.normal[2]( i, j ) == Approx( 1.0 / std::sqrt( w ) ) );
+
+            CHECK( geometry.gaussianCurvature( i, j ) == Approx( 4.0 / ( w * w ) ) );
+            CHECK( geometry.meanCurvature( i, j ) == Approx( ( 2.0 + 8.0 * s * s + 2.0 + 8.0 * r * r ) / ( 2.0 * std::pow( w, 1.5 ) ) ) );
+        }
+    }
+
+    // Collapsed edge at r = 0, where S_s vanishes
+    for( size_t j = 0; j < 3; ++j )
+    {
+        x( 0, j ) = 0.0;
+        y( 0, j ) = 0.5;
+        z( 0, j ) = 0.0;
+    }
+
+    SurfaceGeometry degenerate = evaluateSurfaceGeometry( { bezierKnots, bezierKnots }, { x, y, z }, { 3, 3 } );
+
+    for( size_t j = 0; j < 3; ++j )
+    {
+        CHECK( std::isnan( degenerate.normal[0]( 0, j ) ) );
+        CHECK( std::isnan( degenerate.gaussianCurvature( 0, j ) ) );
+        CHECK( !std::isnan( degenerate.gaussianCurvature( 1, j ) ) );
+    }
+
+    CHECK_THROWS( evaluateSurfaceGeometry( knotVectors, { controlPoints[0], controlPoints[1] }, numberOfSamples ) );
+    CHECK_THROWS( evaluateSurfaceGeometry( knotVectors, { controlPoints[0], controlPoints[1], z }, numberOfSamples ) );
+}
+
+TEST_CASE( "Rational quarter cylinder surface" )
+{
+    std::array<std::vector<double>, 2> knotVectors{ std::vector<double>{ 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 },
+                                                    std::vector<double>{ 0.0, 0.0, 1.0, 1.0 } };
+
+    size_t numberOfSamplesR = 7;
+    size_t numberOfSamplesS = 5;
+
+    double w = std::sqrt( 0.5 );
+
+    linalg::Matrix xGrid( { 1.0, 1.0,
+                            1.0, 1.0,
+                            0.0, 0.0 }, 3 );
+
+    linalg::Matrix yGrid( { 0.0, 0.0,
+                            1.0, 1.0,
+                            1.0, 1.0 }, 3 );
+
+    linalg::Matrix zGrid( { 0.0, 2.0,
+                            0.0, 2.0,
+                            0.0, 2.0 }, 3 );
+
+    linalg::Matrix weights( { 1.0, 1.0,
+                                w,   w,
+                              1.0, 1.0 }, 3 );
+
+    VectorOfMatrices controlGrid{ xGrid, yGrid, zGrid };
+
+    VectorOfMatrices C;
+    std::array<VectorOfMatrices, 2> dC;
+
+    REQUIRE_NOTHROW( C = evaluateRationalSurface( knotVectors, controlGrid, weights,
+                     { numberOfSamplesR, numberOfSamplesS } ) );
+
+    REQUIRE_NOTHROW( dC = evaluateRationalSurfaceDerivatives( knotVectors, controlGrid, weights,
+                     { numberOfSamplesR, numberOfSamplesS } ) );
+
+    REQUIRE( C.size( ) == 3 );
+    REQUIRE( dC[0].size( ) == 3 );
+    REQUIRE( dC[1].size( ) == 3 );
+    REQUIRE( C[0].size1( ) == numberOfSamplesR );
+    REQUIRE( C[0].size2( ) == numberOfSamplesS );
+
+    for( size_t r = 0; r < numberOfSamplesR; ++r )
+    {
+        for( size_t s = 0; s < numberOfSamplesS; ++s )
+        {
+            double S = s / ( numberOfSamplesS - 1.0 );
+
+            CHECK( C[0]( r, s ) * C[0]( r, s ) + C[1]( r, s ) * C[1]( r, s ) == Approx( 1.0 ) );
+            CHECK( C[2]( r, s ) == Approx( 2.0 * S ) );
+
+            // Tangent in r is perpendicular to the radius, the one in s is the cylinder axis
+            CHECK( C[0]( r, s ) * dC[0][0]( r, s ) + C[1]( r, s ) * dC[0][1]( r, s ) == Approx( 0.0 ).margin( 1e-12 ) );
+            CHECK( dC[0][2]( r, s ) == Approx( 0.0 ).margin( 1e-12 ) );
+
+            CHECK( dC[1][0]( r, s ) == Approx( 0.0 ).margin( 1e-12 ) );
+            CHECK( dC[1][1]( r, s ) == Approx( 0.0 ).margin( 1e-12 ) );
+            CHECK( dC[1][2]( r, s ) == Approx( 2.0 ) );
+        }
+    }
+
+    CHECK( dC[0][1]( 0, 0 ) == Approx( std::sqrt( 2.0 ) ) );
+    CHECK( dC[0][0]( numberOfSamplesR - 1, 0 ) == Approx( -std::sqrt( 2.0 ) ) );
+
+    CHECK_THROWS( evaluateRationalSurface( knotVectors, controlGrid, linalg::Matrix( 2, 2, 1.0 ),
+                  { numberOfSamplesR, numberOfSamplesS } ) );
+
+} // Rational quarter cylinder surface
+
 } // namespace splinekernel
 } // namespace cie
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include "catch.hpp"
+#include "tessellation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace cie
+{
+namespace splinekernel
+{
+
+TEST_CASE( "tessellateCurve_straight_test" )
+{
+    // Collinear control points: only the knots are needed as vertices
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.3, 0.5, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 0.5, 2.0, 2.5, 3.0, 4.0 };
+    std::vector<double> y{ 0.0, 1.0, 4.0, 5.0, 6.0, 8.0 };
+
+    CurveEvaluator curve( knotVector, { x, y } );
+
+    Polyline polyline;
+
+    REQUIRE_NOTHROW( polyline = tessellateCurve( curve, 1e-8 ) );
+
+    std::vector<double> expectedParameters{ 0.0, 0.3, 0.5, 1.0 };
+
+    REQUIRE( polyline.parameters.size( ) == expectedParameters.size( ) );
+    REQUIRE( polyline.points.size( ) == 2 );
+    REQUIRE( polyline.points[0].size( ) == expectedParameters.size( ) );
+
+    for( size_t i = 0; i < expectedParameters.size( ); ++i )
+    {
+        CHECK( polyline.parameters[i] == Approx( expectedParameters[i] ) );
+        CHECK( polyline.points[1][i] == Approx( 2.0 * polyline.points[0][i] ) );
+    }
+
+    CHECK( polyline.points[0].front( ) == Approx( 0.0 ) );
+    CHECK( polyline.points[0].back( ) == Approx( 4.0 ) );
+
+    CHECK_THROWS( tessellateCurve( curve, 0.0, 0.0 ) );
+}
+
+TEST_CASE( "tessellateCurve_tolerance_test" )
+{
+    std::vector<double> knotVector{ 0.0, 0.0, 0.0, 0.0, 0.2, 0.3, 0.5, 0.5, 1.0, 1.0, 1.0, 1.0 };
+    std::vector<double> x{ 0.0, 1.0, 2.5, 3.0, 2.0, 1.5, 0.0, -1.0 };
+    std::vector<double> y{ 0.0, 2.0, 1.0, -1.0, 0.5, 3.0, 2.0, 0.0 };
+
+    CurveEvaluator curve( knotVector, { x, y } );
+
+    size_t previousSize = 0;
+
+    for( double tolerance : { 1e-1, 1e-2, 1e-3 } )
+    {
+        Polyline polyline = tessellateCurve( curve, tolerance );
+
+        size_t size = polyline.parameters.size( );
+
+        REQUIRE( size > previousSize );
+
+        // All knots are vertices and the parameters are increasing
+        for( double knot : { 0.0, 0.2, 0.3, 0.5, 1.0 } )
+        {
+            CHECK( std::count( polyline.parameters.begin( ), polyline.parameters.end( ), knot ) == 1 );
+        }
+
+        CHECK( std::is_sorted( polyline.parameters.begin( ), polyline.parameters.end( ) ) );
+
+        // Curve between two vertices stays close to the chord
+        for( size_t i = 0; i + 1 < size; ++i )
+        {
+            double ax = polyline.points[0][i], ay = polyline.points[1][i];
+            double bx = polyline.points[0][i + 1], by = polyline.points[1][i + 1];
+
+            double length = std::sqrt( ( bx - ax ) * ( bx - ax ) + ( by - ay ) * ( by - ay ) );
+
+            for( size_t j = 1; j < 10; ++j )
+            {
+                double t = polyline.parameters[i] + j / 10.0 * ( polyline.parameters[i + 1] - polyline.parameters[i] );
+                double point[2];
+
+                curve.evaluate( t, point );
+
+                double distance = std::abs( ( bx - ax ) * ( point[1] - ay ) - ( by - ay ) * ( point[0] - ax ) ) / length;
+
+                CHECK( distance <= 1.5 * tolerance );
+            }
+        }
+
+        previousSize = size;
+    }
+
+    // Angle criterion alone
+    Polyline coarse = tessellateCurve( curve, 0.0, 0.5 );
+    Polyline fine = tessellateCurve( curve, 0.0, 0.05 );
+
+    CHECK( fine.parameters.size( ) > coarse.parameters.size( ) );
+
+    // Maximum depth limits the subdivision
+    Polyline limited = tessellateCurve( curve, 1e-12, 0.0, 2 );
+
+    CHECK( limited.parameters.size( ) == 4 * 4 + 1 );
+}
+
+namespace tessellationtesthelper
+{
+
+using Vertex = std::array<double, 3>;
+using Triangle = std::array<Vertex, 3>;
+
+// z = x^2 + y^2 on [-1, 1]^2 with an unequal knot span in each direction, so
+// neighbouring cells are subdivided differently and hanging vertices occur
+VectorOfMatrices paraboloid( std::array<std::vector<double>, 2>& knotVectors )
+{
+    knotVectors[0] = knotVectors[1] = { 0.0, 0.0, 0.0, 0.2, 1.0, 1.0, 1.0 };
+
+    // Greville abscissae of the knots reproduce x = 2 t - 1, the blossom of x^2 gives the squares
+    std::vector<double> linear { -1.0, -0.8, 0.2, 1.0 };
+    std::vector<double> square { 1.0, 0.6, -0.6, 1.0 };
+
+    VectorOfMatrices controlPoints( 3, linalg::Matrix( 4, 4 ) );
+
+    for( size_t i = 0; i < 4; ++i )
+    {
+        for( size_t j = 0; j < 4; ++j )
+        {
+            controlPoints[0]( i, j ) = linear[i];
+            controlPoints[1]( i, j ) = linear[j];
+            controlPoints[2]( i, j ) = square[i] + square[j];
+        }
+    }
+
+    return controlPoints;
+}
+
+std::vector<Triangle> collect( const std::array<std::vector<double>, 2>& knotVectors,
+                               const VectorOfMatrices& controlPoints,
+                               double tolerance,
+                               size_t maximumDepth = 8 )
+{
+    std::vector<Triangle> triangles;
+
+    tessellateSurface( knotVectors, controlPoints, tolerance, [&]( const Triangle& triangle )
+    {
+        triangles.push_back( triangle );
+    }, maximumDepth );
+
+    return triangles;
+}
+
+template<typename T>
+T readBinary( const std::string& data, size_t& position )
+{
+    T value;
+
+    std::memcpy( &value, data.data( ) + position, sizeof( T ) );
+
+    position += sizeof( T );
+
+    return value;
+}
+
+} // namespace tessellationtesthelper
+
+TEST_CASE( "tessellateSurface_planar_test" )
+{
+    std::array<std::vector<double>, 2> knotVectors { std::vector<double>{ 0.0, 0.0, 0.5, 1.0, 1.0 },
+                                                     std::vector<double>{ 0.0, 0.0, 0.5, 1.0, 1.0 } };
+
+    VectorOfMatrices controlPoints( 3, linalg::Matrix( 3, 3 ) );
+
+    for( size_t i = 0; i < 3; ++i )
+    {
+        for( size_t j = 0; j < 3; ++j )
+        {
+            controlPoints[0]( i, j ) = i;
+            controlPoints[1]( i, j ) = j;
+            controlPoints[2]( i, j ) = i + 2.0 * j;
+        }
+    }
+
+    auto triangles = tessellationtesthelper::collect( knotVectors, controlPoints, 1e-6 );
+
+    // Two triangles per knot span cell
+    REQUIRE( triangles.size( ) == 8 );
+
+    double area = 0.0;
+
+    for( const auto& triangle : triangles )
+    {
+        double ux = triangle[1][0] - triangle[0][0], uy = triangle[1][1] - triangle[0][1];
+        double vx = triangle[2][0] - triangle[0][0], vy = triangle[2][1] - triangle[0][1];
+
+        // Oriented along S_r x S_s, which points in positive z direction
+        CHECK( ux * vy - uy * vx > 0.0 );
+
+        for( const auto& vertex : triangle )
+        {
+            CHECK( vertex[2] == Approx( vertex[0] + 2.0 * vertex[1] ) );
+        }
+
+        area += 0.5 * ( ux * vy - uy * vx );
+    }
+
+    CHECK( area == Approx( 4.0 ) );
+
+    // Invalid input
+    CHECK_THROWS( tessellationtesthelper::collect( knotVectors, controlPoints, 0.0 ) );
+    CHECK_THROWS( tessellationtesthelper::collect( knotVectors, { controlPoints[0], controlPoints[1] }, 1e-3 ) );
+}
+
+TEST_CASE( "tessellateSurface_watertight_test" )
+{
+    std::array<std::vector<double>, 2> knotVectors;
+
+    auto controlPoints = tessellationtesthelper::paraboloid( knotVectors );
+
+    size_t previousSize = 0;
+
+    for( double tolerance : { 1e-1, 1e-2, 1e-3 } )
+    {
+        auto triangles = tessellationtesthelper::collect( knotVectors, controlPoints, tolerance );
+
+        REQUIRE( triangles.size( ) > previousSize );
+
+        // Every directed edge appears once and, except on the boundary, its reverse once as well
+        std::map<std::array<tessellationtesthelper::Vertex, 2>, size_t> edges;
+
+        for( const auto& triangle : triangles )
+        {
+            for( size_t k = 0; k < 3; ++k )
+            {
+                edges[{ triangle[k], triangle[( k + 1 ) % 3] }]++;
+            }
+
+            // Triangle centroid stays close to the surface
+            double x = 0.0, y = 0.0, z = 0.0;
+
+            for( const auto& vertex : triangle )
+            {
+                x += vertex[0] / 3.0;
+                y += vertex[1] / 3.0;
+                z += vertex[2] / 3.0;
+            }
+
+            CHECK( std::abs( z - x * x - y * y ) <= tolerance );
+        }
+
+        size_t numberOfBoundaryEdges = 0;
+
+        for( const auto& edge : edges )
+        {
+            REQUIRE( edge.second == 1 );
+
+            if( edges.find( { edge.first[1], edge.first[0] } ) == edges.end( ) )
+            {
+                bool onBoundary = false;
+
+                for( size_t axis = 0; axis < 2; ++axis )
+                {
+                    onBoundary = onBoundary || ( std::abs( std::abs( edge.first[0][axis] ) - 1.0 ) < 1e-12 &&
+                                                 std::abs( edge.first[1][axis] - edge.first[0][axis] ) < 1e-12 );
+                }
+
+                CHECK( onBoundary );
+
+                numberOfBoundaryEdges++;
+            }
+        }
+
+        CHECK( numberOfBoundaryEdges >= 8 );
+
+        previousSize = triangles.size( );
+    }
+
+    // Without subdivision there are two triangles per knot span cell
+    CHECK( tessellationtesthelper::collect( knotVectors, controlPoints, 1e-6, 0 ).size( ) == 8 );
+}
+
+TEST_CASE( "writeSurfaceStl_test" )
+{
+    std::array<std::vector<double>, 2> knotVectors;
+
+    auto controlPoints = tessellationtesthelper::paraboloid( knotVectors );
+
+    std::stringstream stream;
+
+    size_t numberOfTriangles = 0;
+
+    REQUIRE_NOTHROW( numberOfTriangles = writeSurfaceStl( knotVectors, controlPoints, 1e-2, stream ) );
+
+    auto triangles = tessellationtesthelper::collect( knotVectors, controlPoints, 1e-2 );
+
+    REQUIRE( numberOfTriangles == triangles.size( ) );
+
+    std::string data = stream.str( );
+
+    REQUIRE( data.size( ) == 84 + 50 * numberOfTriangles );
+
+    size_t position = 80;
+
+    CHECK( tessellationtesthelper::readBinary<std::uint32_t>( data, position ) == numberOfTriangles );
+
+    for( size_t iTriangle = 0; iTriangle < numberOfTriangles; ++iTriangle )
+    {
+        double length = 0.0;
+
+        for( size_t d = 0; d < 3; ++d )
+        {
+            length += std::pow( tessellationtesthelper::readBinary<float>( data, position ), 2 );
+        }
+
+        CHECK( length == Approx( 1.0 ).epsilon( 1e-5 ) );
+
+        for( size_t iVertex = 0; iVertex < 3; ++iVertex )
+        {
+            for( size_t d = 0; d < 3; ++d )
+            {
+                CHECK( tessellationtesthelper::readBinary<float>( data, position ) ==
+                       static_cast<float>( triangles[iTriangle][iVertex][d] ) );
+            }
+        }
+
+        CHECK( tessellationtesthelper::readBinary<std::uint16_t>( data, position ) == 0 );
+    }
+}
+
+TEST_CASE( "writeSurfacePly_test" )
+{
+    std::array<std::vector<double>, 2> knotVectors;
+
+    auto controlPoints = tessellationtesthelper::paraboloid( knotVectors );
+
+    std::stringstream stream;
+
+    size_t numberOfFaces = 0;
+
+    REQUIRE_NOTHROW( numberOfFaces = writeSurfacePly( knotVectors, controlPoints, 1e-2, stream ) );
+
+    auto triangles = tessellationtesthelper::collect( knotVectors, controlPoints, 1e-2 );
+
+    REQUIRE( numberOfFaces == triangles.size( ) );
+
+    std::map<tessellationtesthelper::Vertex, size_t> uniqueVertices;
+
+    for( const auto& triangle : triangles )
+    {
+        for( const auto& vertex : triangle )
+        {
+            uniqueVertices[vertex]++;
+        }
+    }
+
+    std::string data = stream.str( );
+
+    std::istringstream header( data );
+    std::string line, keyword, element;
+
+    size_t numberOfVertices = 0, numberOfHeaderFaces = 0;
+
+    REQUIRE( std::getline( header, line ) );
+    REQUIRE( line == "ply" );
+
+    while( std::getline( header, line ) && line != "end_header" )
+    {
+        std::istringstream words( line );
+
+        words >> keyword >> element;
+
+        if( keyword == "element" )
+        {
+            ( element == "vertex" ? numberOfVertices : numberOfHeaderFaces ) = std::stoul( line.substr( line.rfind( ' ' ) ) );
+        }
+    }
+
+    REQUIRE( line == "end_header" );
+
+    CHECK( numberOfVertices == uniqueVertices.size( ) );
+    CHECK( numberOfHeaderFaces == numberOfFaces );
+
+    size_t position = static_cast<size_t>( header.tellg( ) );
+
+    REQUIRE( data.size( ) == position + 12 * numberOfVertices + 13 * numberOfFaces );
+
+    position += 12 * numberOfVertices;
+
+    for( size_t iFace = 0; iFace < numberOfFaces; ++iFace )
+    {
+        CHECK( tessellationtesthelper::readBinary<std::uint8_t>( data, position ) == 3 );
+
+        for( size_t k = 0; k < 3; ++k )
+        {
+            auto index = tessellationtesthelper::readBinary<std::int32_t>( data, position );
+
+            CHECK( index >= 0 );
+            CHECK( static_cast<size_t>( index ) < numberOfVertices );
+        }
+    }
+}
+
+} // namespace splinekernel
+} // namespace cie